@@ -2,9 +2,20 @@
 
 #include "Application.h"
 
+#include <GLFW/glfw3.h>
+
 namespace LearningVK
 {
 
+	static Event StampEvent(EventType type, GLFWwindow* window)
+	{
+		Event event;
+		event.Type = type;
+		event.Window = window;
+		event.Time = std::chrono::steady_clock::now();
+		return event;
+	}
+
 	Application::Application()
 	{
 		
@@ -17,12 +28,144 @@ namespace LearningVK
 
 	void Application::Run()
     {
+		eventThread = std::this_thread::get_id();
 		OnInit();
 
+		std::thread updateThread([this]() {
+			while (Running)
+				OnUpdate();
+
+			// Wakes the event thread, so it sees the application stopped
+			glfwPostEmptyEvent();
+		});
+
 		while (Running)
-			OnUpdate();
+		{
+			glfwWaitEvents();
+			RunEventThreadWork();
+		}
 
+		updateThread.join();
 		OnDestruct();
 	}
 
-}
\ No newline at end of file
+	void Application::AttachWindow(GLFWwindow* window)
+	{
+		glfwSetWindowUserPointer(window, this);
+
+		glfwSetWindowCloseCallback(window, [](GLFWwindow* window) {
+			static_cast<Application*>(glfwGetWindowUserPointer(window))->PushEvent(StampEvent(EventType_WindowClose, window));
+		});
+
+		glfwSetFramebufferSizeCallback(window, [](GLFWwindow* window, int width, int height) {
+			Event event = StampEvent(EventType_WindowResize, window);
+			event.Width = uint32_t(width);
+			event.Height = uint32_t(height);
+			static_cast<Application*>(glfwGetWindowUserPointer(window))->PushEvent(event);
+		});
+
+		glfwSetWindowFocusCallback(window, [](GLFWwindow* window, int focused) {
+			Event event = StampEvent(EventType_WindowFocus, window);
+			event.Focused = focused == GLFW_TRUE;
+			static_cast<Application*>(glfwGetWindowUserPointer(window))->PushEvent(event);
+		});
+
+		glfwSetKeyCallback(window, [](GLFWwindow* window, int key, int /*scancode*/, int action, int mods) {
+			Event event = StampEvent(EventType_Key, window);
+			event.Key = key;
+			event.Action = action;
+			event.Mods = mods;
+			static_cast<Application*>(glfwGetWindowUserPointer(window))->PushEvent(event);
+		});
+
+		glfwSetMouseButtonCallback(window, [](GLFWwindow* window, int button, int action, int mods) {
+			Event event = StampEvent(EventType_MouseButton, window);
+			event.Key = button;
+			event.Action = action;
+			event.Mods = mods;
+			static_cast<Application*>(glfwGetWindowUserPointer(window))->PushEvent(event);
+		});
+
+		glfwSetCursorPosCallback(window, [](GLFWwindow* window, double x, double y) {
+			Event event = StampEvent(EventType_MouseMove, window);
+			event.X = x;
+			event.Y = y;
+			static_cast<Application*>(glfwGetWindowUserPointer(window))->PushEvent(event);
+		});
+
+		glfwSetScrollCallback(window, [](GLFWwindow* window, double x, double y) {
+			Event event = StampEvent(EventType_MouseScroll, window);
+			event.X = x;
+			event.Y = y;
+			static_cast<Application*>(glfwGetWindowUserPointer(window))->PushEvent(event);
+		});
+	}
+
+	void Application::RunOnEventThread(const std::function<void()>& function)
+	{
+		if (std::this_thread::get_id() == eventThread)
+		{
+			function();
+			return;
+		}
+
+		std::unique_lock<std::mutex> lock(workMutex);
+		uint64_t ticket = ++queuedWork;
+		work.push_back(function);
+		glfwPostEmptyEvent();
+
+		workFinished.wait(lock, [&]() { return finishedWork >= ticket; });
+	}
+
+	void Application::PostToEventThread(const std::function<void()>& function)
+	{
+		if (std::this_thread::get_id() == eventThread)
+		{
+			function();
+			return;
+		}
+
+		std::lock_guard<std::mutex> lock(workMutex);
+		work.push_back(function);
+		glfwPostEmptyEvent();
+	}
+
+	bool Application::PollEvent(Event& event, std::chrono::steady_clock::time_point before)
+	{
+		const Event* front = events.Front();
+		if (!front || front->Time >= before)
+			return false;
+
+		event = *front;
+		events.Pop();
+		return true;
+	}
+
+	// Only called by GLFW's callbacks, which only run on the event thread, so there's a single producer
+	void Application::PushEvent(const Event& event)
+	{
+		if (!events.TryPush(event))
+			droppedEvents++;
+	}
+
+	void Application::RunEventThreadWork()
+	{
+		std::vector<std::function<void()>> pending;
+		uint64_t lastTicket;
+		{
+			std::lock_guard<std::mutex> lock(workMutex);
+			pending.swap(work);
+			lastTicket = queuedWork;
+		}
+
+		for (const std::function<void()>& function : pending)
+			function();
+
+		{
+			std::lock_guard<std::mutex> lock(workMutex);
+			finishedWork = lastTicket;
+		}
+		workFinished.notify_all();
+	}
+
+}
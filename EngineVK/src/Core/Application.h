@@ -1,7 +1,27 @@
 #pragma once
 
+#include "Core/Event.h"
+#include "Core/SPSCQueue.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct GLFWwindow;
+
 namespace LearningVK {
 
+	constexpr uint32_t EventQueueCapacity = 4096;
+
+	// OnInit() and OnDestruct() run on the main thread, OnUpdate() on an update thread of its own. The main thread
+	// becomes the event thread in between: GLFW only delivers events there, so it waits for them and passes them on
+	// through a lock-free queue. However long a frame takes, events are received as they happen and carry the
+	// time they arrived. OnInit() has to initialise GLFW.
 	class Application
 	{
 	public:
@@ -14,8 +34,39 @@ namespace LearningVK {
 		virtual void OnUpdate() = 0;
 		virtual void OnDestruct() = 0;
 	public:
-		bool Running = true;
+		std::atomic<bool> Running{ true };
+	protected:
+		// Sends the window's events to the event queue, the window's user pointer belongs to the application from
+		// then on. Call it on the event thread.
+		void AttachWindow(GLFWwindow* window);
+
+		// Runs the function on the event thread and returns once it has, straight away when that's the calling
+		// thread. For the GLFW functions that may only be called there, like creating windows or setting titles.
+		void RunOnEventThread(const std::function<void()>& function);
+		// Queues the function for the event thread without waiting for it, for work nothing waits on like setting
+		// titles. Queued functions run in order, so a later RunOnEventThread() runs after it.
+		void PostToEventThread(const std::function<void()>& function);
+
+		// Takes the oldest event that arrived before the given time, false when there's none. Only the update
+		// thread may take events.
+		bool PollEvent(Event& event, std::chrono::steady_clock::time_point before = std::chrono::steady_clock::time_point::max());
+
+		// Events that were dropped since the queue was full, the update thread fell too far behind
+		uint64_t GetDroppedEventCount() const { return droppedEvents; }
+	private:
+		void PushEvent(const Event& event);
+		void RunEventThreadWork();
+	private:
+		SPSCQueue<Event, EventQueueCapacity> events;
+		std::atomic<uint64_t> droppedEvents{ 0 };
+
+		std::thread::id eventThread;
+		std::mutex workMutex;
+		std::condition_variable workFinished;
+		std::vector<std::function<void()>> work;
+		uint64_t queuedWork = 0;
+		uint64_t finishedWork = 0;
 	};
 
 	Application* CreateApplication();
-}
\ No newline at end of file
+}
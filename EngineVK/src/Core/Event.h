@@ -0,0 +1,41 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+struct GLFWwindow;
+
+namespace LearningVK {
+
+	enum EventType : uint32_t
+	{
+		EventType_WindowClose = 0,
+		EventType_WindowResize,
+		EventType_WindowFocus,
+		EventType_Key,
+		EventType_MouseButton,
+		EventType_MouseMove,
+		EventType_MouseScroll
+	};
+
+	// A window or input event, stamped with the time the event thread received it
+	struct Event
+	{
+		EventType Type = EventType_WindowClose;
+		GLFWwindow* Window = nullptr;
+		std::chrono::steady_clock::time_point Time;
+
+		// The key or mouse button with GLFW's action and modifier bits
+		int Key = 0;
+		int Action = 0;
+		int Mods = 0;
+		// The new framebuffer size of a resize, zero while minimized
+		uint32_t Width = 0;
+		uint32_t Height = 0;
+		// The cursor position of a mouse move or the offsets of a scroll
+		double X = 0.0;
+		double Y = 0.0;
+		bool Focused = false;
+	};
+
+}
@@ -0,0 +1,156 @@
+#include <vkpch.h>
+
+#include "ImageWriter.h"
+
+#include <cstring>
+
+namespace LearningVK
+{
+
+	static uint32_t CRC32(const uint8_t* data, size_t size, uint32_t crc = 0)
+	{
+		static const std::array<uint32_t, 256> table = []() {
+			std::array<uint32_t, 256> table{};
+			for (uint32_t i = 0; i < 256; i++)
+			{
+				uint32_t value = i;
+				for (int bit = 0; bit < 8; bit++)
+					value = (value & 1) ? 0xEDB88320u ^ (value >> 1) : value >> 1;
+				table[i] = value;
+			}
+			return table;
+		}();
+
+		crc = ~crc;
+		for (size_t i = 0; i < size; i++)
+			crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+		return ~crc;
+	}
+
+	static void AppendU32BE(std::vector<uint8_t>& out, uint32_t value)
+	{
+		out.push_back(uint8_t(value >> 24));
+		out.push_back(uint8_t(value >> 16));
+		out.push_back(uint8_t(value >> 8));
+		out.push_back(uint8_t(value));
+	}
+
+	static void WriteChunk(std::ofstream& file, const char* type, const std::vector<uint8_t>& data)
+	{
+		std::vector<uint8_t> chunk;
+		chunk.reserve(data.size() + 12);
+		AppendU32BE(chunk, uint32_t(data.size()));
+		chunk.insert(chunk.end(), type, type + 4);
+		chunk.insert(chunk.end(), data.begin(), data.end());
+		AppendU32BE(chunk, CRC32(chunk.data() + 4, data.size() + 4));
+
+		file.write((const char*)chunk.data(), chunk.size());
+	}
+
+	bool WritePNG(const std::string& path, uint32_t width, uint32_t height, const uint8_t* rgba)
+	{
+		std::ofstream file(path, std::ios::binary);
+		if (!file.is_open())
+			return false;
+
+		const uint8_t signature[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+		file.write((const char*)signature, sizeof(signature));
+
+		std::vector<uint8_t> header;
+		AppendU32BE(header, width);
+		AppendU32BE(header, height);
+		header.insert(header.end(), { 8, 6, 0, 0, 0 }); // 8 bits per channel, RGBA, no interlacing
+		WriteChunk(file, "IHDR", header);
+
+		// Every scanline is prefixed with filter type 0 (none)
+		size_t rowSize = size_t(width) * 4;
+		std::vector<uint8_t> scanlines((rowSize + 1) * height);
+		for (uint32_t y = 0; y < height; y++)
+		{
+			scanlines[y * (rowSize + 1)] = 0;
+			std::memcpy(&scanlines[y * (rowSize + 1) + 1], rgba + y * rowSize, rowSize);
+		}
+
+		const size_t maxBlockSize = 65535;
+		std::vector<uint8_t> compressed;
+		compressed.reserve(scanlines.size() + scanlines.size() / maxBlockSize * 5 + 16);
+		compressed.push_back(0x78);
+		compressed.push_back(0x01);
+
+		uint32_t adlerA = 1, adlerB = 0;
+		size_t offset = 0;
+		do
+		{
+			size_t blockSize = std::min(maxBlockSize, scanlines.size() - offset);
+			bool lastBlock = offset + blockSize == scanlines.size();
+
+			compressed.push_back(lastBlock ? 1 : 0);
+			compressed.push_back(uint8_t(blockSize));
+			compressed.push_back(uint8_t(blockSize >> 8));
+			compressed.push_back(uint8_t(~blockSize));
+			compressed.push_back(uint8_t(~blockSize >> 8));
+			compressed.insert(compressed.end(), scanlines.begin() + offset, scanlines.begin() + offset + blockSize);
+
+			for (size_t i = offset; i < offset + blockSize; i++)
+			{
+				adlerA = (adlerA + scanlines[i]) % 65521;
+				adlerB = (adlerB + adlerA) % 65521;
+			}
+
+			offset += blockSize;
+		} while (offset < scanlines.size());
+
+		AppendU32BE(compressed, (adlerB << 16) | adlerA);
+		WriteChunk(file, "IDAT", compressed);
+		WriteChunk(file, "IEND", {});
+
+		return file.good();
+	}
+
+	bool PPMStream::Open(const std::string& path, uint32_t width, uint32_t height)
+	{
+		file.open(path, std::ios::binary);
+		if (!file.is_open())
+			return false;
+
+		this->width = width;
+		this->height = height;
+
+		std::string header = "P6\n" + std::to_string(width) + " " + std::to_string(height) + "\n255\n";
+		file.write(header.data(), header.size());
+		pixelsOffset = std::streamoff(header.size());
+		return file.good();
+	}
+
+	bool PPMStream::Close()
+	{
+		bool good = file.good();
+		file.close();
+		return good;
+	}
+
+	bool PPMStream::WriteRegion(uint32_t x, uint32_t y, uint32_t width, uint32_t height, const uint8_t* pixels, bool swapRedBlue)
+	{
+		if (x + width > this->width || y + height > this->height)
+			return false;
+
+		row.resize(size_t(width) * 3);
+		int red = swapRedBlue ? 2 : 0, blue = swapRedBlue ? 0 : 2;
+		for (uint32_t line = 0; line < height; line++)
+		{
+			const uint8_t* source = pixels + size_t(line) * width * 4;
+			for (uint32_t i = 0; i < width; i++)
+			{
+				row[i * 3 + 0] = source[i * 4 + red];
+				row[i * 3 + 1] = source[i * 4 + 1];
+				row[i * 3 + 2] = source[i * 4 + blue];
+			}
+
+			file.seekp(pixelsOffset + (std::streamoff(y + line) * this->width + x) * 3);
+			file.write((const char*)row.data(), row.size());
+		}
+
+		return file.good();
+	}
+
+}
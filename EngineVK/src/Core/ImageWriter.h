@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace LearningVK {
+
+	// Writes 8-bit RGBA pixels as a PNG using stored (uncompressed) deflate blocks, which trades file size
+	// for an encoder cheap enough to keep up with capturing every frame.
+	bool WritePNG(const std::string& path, uint32_t width, uint32_t height, const uint8_t* rgba);
+
+	// Writes a binary PPM one region at a time, in any order. Every pixel has a fixed place in the file, so regions
+	// go straight to their rows and nothing larger than one row is ever buffered, whatever the image size.
+	// The file is only complete once every pixel has been covered by a region.
+	class PPMStream
+	{
+	public:
+		bool Open(const std::string& path, uint32_t width, uint32_t height);
+		bool Close();
+		bool IsOpen() const { return file.is_open(); }
+
+		// Pixels are tightly packed 8-bit RGBA, or BGRA with swapRedBlue. The alpha is dropped.
+		bool WriteRegion(uint32_t x, uint32_t y, uint32_t width, uint32_t height, const uint8_t* pixels, bool swapRedBlue);
+	private:
+		std::ofstream file;
+		uint32_t width = 0;
+		uint32_t height = 0;
+		std::streamoff pixelsOffset = 0;
+		std::vector<uint8_t> row;
+	};
+
+}
@@ -0,0 +1,109 @@
+#include <vkpch.h>
+
+#include "MappedFile.h"
+
+#include <iostream>
+
+#ifndef VK_PLATFORM_WINDOWS
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+namespace LearningVK
+{
+
+	MappedFile::~MappedFile()
+	{
+		Close();
+	}
+
+	bool MappedFile::Open(const std::string& path)
+	{
+		Close();
+
+#ifdef VK_PLATFORM_WINDOWS
+		HANDLE fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (fileHandle == INVALID_HANDLE_VALUE)
+		{
+			std::cout << "Error: Couldn't open " << path << "!" << std::endl;
+			return false;
+		}
+		file = fileHandle;
+
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart == 0)
+		{
+			std::cout << "Error: " << path << " is empty!" << std::endl;
+			Close();
+			return false;
+		}
+
+		HANDLE mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		void* view = mappingHandle ? MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0) : nullptr;
+		mapping = mappingHandle;
+		if (!view)
+		{
+			std::cout << "Error: Couldn't map " << path << "!" << std::endl;
+			Close();
+			return false;
+		}
+
+		data = static_cast<const uint8_t*>(view);
+		size = size_t(fileSize.QuadPart);
+#else
+		descriptor = open(path.c_str(), O_RDONLY);
+		if (descriptor < 0)
+		{
+			std::cout << "Error: Couldn't open " << path << "!" << std::endl;
+			return false;
+		}
+
+		struct stat fileStatus;
+		if (fstat(descriptor, &fileStatus) != 0 || fileStatus.st_size == 0)
+		{
+			std::cout << "Error: " << path << " is empty!" << std::endl;
+			Close();
+			return false;
+		}
+
+		void* view = mmap(nullptr, size_t(fileStatus.st_size), PROT_READ, MAP_PRIVATE, descriptor, 0);
+		if (view == MAP_FAILED)
+		{
+			std::cout << "Error: Couldn't map " << path << "!" << std::endl;
+			Close();
+			return false;
+		}
+
+		data = static_cast<const uint8_t*>(view);
+		size = size_t(fileStatus.st_size);
+#endif
+
+		return true;
+	}
+
+	void MappedFile::Close()
+	{
+#ifdef VK_PLATFORM_WINDOWS
+		if (data)
+			UnmapViewOfFile(data);
+		if (mapping)
+			CloseHandle(mapping);
+		if (file)
+			CloseHandle(file);
+#else
+		if (data)
+			munmap(const_cast<uint8_t*>(data), size);
+		if (descriptor >= 0)
+			close(descriptor);
+#endif
+
+		data = nullptr;
+		size = 0;
+		file = nullptr;
+		mapping = nullptr;
+		descriptor = -1;
+	}
+
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace LearningVK {
+
+	// A whole file mapped read-only into memory. Pages are only read from disk once they're touched, so reading a
+	// small part of a large file costs no more than that part.
+	class MappedFile
+	{
+	public:
+		MappedFile() = default;
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		// Empty files can't be mapped, they fail to open like missing ones
+		bool Open(const std::string& path);
+		void Close();
+
+		bool IsOpen() const { return data != nullptr; }
+		const uint8_t* GetData() const { return data; }
+		size_t GetSize() const { return size; }
+	private:
+		const uint8_t* data = nullptr;
+		size_t size = 0;
+
+		// The file and mapping handles on Windows, the file descriptor elsewhere
+		void* file = nullptr;
+		void* mapping = nullptr;
+		int descriptor = -1;
+	};
+
+}
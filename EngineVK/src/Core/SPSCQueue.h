@@ -0,0 +1,54 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace LearningVK {
+
+	// A bounded queue between exactly one producer thread and one consumer thread. Neither side ever takes a lock or
+	// waits for the other: the producer only writes the tail and the consumer only writes the head, each on a cache
+	// line of its own. Capacity has to be a power of two.
+	template<typename T, uint32_t Capacity>
+	class SPSCQueue
+	{
+		static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "The capacity of a SPSCQueue has to be a power of two");
+	public:
+		// Producer only, returns false when the queue is full
+		bool TryPush(const T& item)
+		{
+			uint32_t currentTail = tail.load(std::memory_order_relaxed);
+			if (currentTail - head.load(std::memory_order_acquire) == Capacity)
+				return false;
+
+			items[currentTail & (Capacity - 1)] = item;
+			tail.store(currentTail + 1, std::memory_order_release);
+			return true;
+		}
+
+		// Consumer only, the oldest item or nullptr when the queue is empty. It stays valid until Pop().
+		const T* Front() const
+		{
+			uint32_t currentHead = head.load(std::memory_order_relaxed);
+			if (currentHead == tail.load(std::memory_order_acquire))
+				return nullptr;
+
+			return &items[currentHead & (Capacity - 1)];
+		}
+
+		// Consumer only, the queue mustn't be empty
+		void Pop()
+		{
+			head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+		}
+
+		// Either side, only a snapshot since the other side keeps going
+		uint32_t GetSize() const { return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire); }
+		static constexpr uint32_t GetCapacity() { return Capacity; }
+	private:
+		alignas(64) std::atomic<uint32_t> head{ 0 };
+		alignas(64) std::atomic<uint32_t> tail{ 0 };
+		alignas(64) std::array<T, Capacity> items{};
+	};
+
+}
@@ -0,0 +1,78 @@
+#include <vkpch.h>
+
+#include "ThreadPool.h"
+
+namespace LearningVK
+{
+
+	ThreadPool::ThreadPool(uint32_t threadCount)
+	{
+		threadCount = std::max(threadCount, 1u);
+		for (uint32_t i = 0; i < threadCount; i++)
+			workers.emplace_back(&ThreadPool::WorkerLoop, this);
+	}
+
+	ThreadPool::~ThreadPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+		}
+
+		jobAvailable.notify_all();
+		for (std::thread& worker : workers)
+			worker.join();
+	}
+
+	void ThreadPool::Submit(std::function<void()>&& job)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			jobs.push_back(std::move(job));
+		}
+
+		jobAvailable.notify_one();
+	}
+
+	void ThreadPool::Wait()
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		jobsFinished.wait(lock, [this]() { return jobs.empty() && activeJobs == 0; });
+	}
+
+	size_t ThreadPool::GetPendingCount()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return jobs.size() + activeJobs;
+	}
+
+	void ThreadPool::WorkerLoop()
+	{
+		while (true)
+		{
+			std::function<void()> job;
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				jobAvailable.wait(lock, [this]() { return stopping || !jobs.empty(); });
+
+				// Queued jobs are still finished when stopping so nothing submitted is lost
+				if (jobs.empty())
+					return;
+
+				job = std::move(jobs.front());
+				jobs.pop_front();
+				activeJobs++;
+			}
+
+			job();
+
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				activeJobs--;
+				if (jobs.empty() && activeJobs == 0)
+					jobsFinished.notify_all();
+			}
+		}
+	}
+
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <functional>
+#include <condition_variable>
+
+namespace LearningVK {
+
+	class ThreadPool
+	{
+	public:
+		explicit ThreadPool(uint32_t threadCount = std::thread::hardware_concurrency());
+		~ThreadPool();
+
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+
+		void Submit(std::function<void()>&& job);
+
+		// Blocks until every submitted job has finished
+		void Wait();
+
+		uint32_t GetThreadCount() const { return uint32_t(workers.size()); }
+		size_t GetPendingCount();
+	private:
+		void WorkerLoop();
+	private:
+		std::vector<std::thread> workers;
+		std::deque<std::function<void()>> jobs;
+		std::mutex mutex;
+		std::condition_variable jobAvailable;
+		std::condition_variable jobsFinished;
+		uint32_t activeJobs = 0;
+		bool stopping = false;
+	};
+
+}
@@ -1,3 +1,31 @@
 #pragma once
 
-#include "Core/Application.h"
\ No newline at end of file
+#include "Core/Application.h"
+#include "Core/Event.h"
+#include "Core/ImageWriter.h"
+#include "Core/MappedFile.h"
+#include "Core/SPSCQueue.h"
+#include "Core/ThreadPool.h"
+
+#include "Renderer/ShaderLibrary.h"
+#include "Renderer/SpecializationConstants.h"
+#include "Renderer/Attachment.h"
+#include "Renderer/BitmapFont.h"
+#include "Renderer/Buffer.h"
+#include "Renderer/CommandCache.h"
+#include "Renderer/ComputePipeline.h"
+#include "Renderer/DeletionQueue.h"
+#include "Renderer/DeviceDispatch.h"
+#include "Renderer/DepthPyramid.h"
+#include "Renderer/Descriptors.h"
+#include "Renderer/FrameCapture.h"
+#include "Renderer/GraphicsPipeline.h"
+#include "Renderer/Memory.h"
+#include "Renderer/MemoryTracker.h"
+#include "Renderer/SpriteBatch.h"
+#include "Renderer/Swapchain.h"
+#include "Renderer/Texture.h"
+#include "Renderer/TextureFile.h"
+#include "Renderer/TextureStreamer.h"
+#include "Renderer/TiledRenderer.h"
+#include "Renderer/Upload.h"
@@ -0,0 +1,95 @@
+#include <vkpch.h>
+
+#include "Attachment.h"
+#include "Memory.h"
+
+#include <iostream>
+
+namespace LearningVK
+{
+
+	bool CreateAttachment(VkDevice device, VkPhysicalDevice physicalDevice, const AttachmentSpecification& specification, Attachment& attachment)
+	{
+		VkImageCreateInfo imageInfo{};
+		imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+		imageInfo.imageType = VK_IMAGE_TYPE_2D;
+		imageInfo.format = specification.Format;
+		imageInfo.extent = { specification.Extent.width, specification.Extent.height, 1 };
+		imageInfo.mipLevels = 1;
+		imageInfo.arrayLayers = 1;
+		imageInfo.samples = specification.Samples;
+		imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+		imageInfo.usage = specification.Usage;
+		imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+		if (specification.Transient)
+			imageInfo.usage |= VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
+
+		if (vkCreateImage(device, &imageInfo, nullptr, &attachment.Image) != VK_SUCCESS)
+		{
+			std::cout << "Error: Couldn't create attachment image!" << std::endl;
+			return false;
+		}
+
+		VkMemoryRequirements memoryRequirements;
+		vkGetImageMemoryRequirements(device, attachment.Image, &memoryRequirements);
+
+		uint32_t memoryType = InvalidMemoryType;
+		if (specification.Transient)
+			memoryType = FindMemoryType(physicalDevice, memoryRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT);
+
+		attachment.LazilyAllocated = memoryType != InvalidMemoryType;
+		if (!attachment.LazilyAllocated)
+			memoryType = FindMemoryType(physicalDevice, memoryRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+		VkMemoryAllocateInfo allocateInfo{};
+		allocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+		allocateInfo.allocationSize = memoryRequirements.size;
+		allocateInfo.memoryTypeIndex = memoryType;
+
+		MemoryCategory category = specification.Transient ? MemoryCategory_Transient : MemoryCategory_Image;
+		if (memoryType == InvalidMemoryType || AllocateMemory(device, allocateInfo, category, memoryRequirements.size, attachment.Memory) != VK_SUCCESS)
+		{
+			std::cout << "Error: Couldn't allocate attachment memory!" << std::endl;
+			DestroyAttachment(device, attachment);
+			return false;
+		}
+
+		attachment.Size = memoryRequirements.size;
+		vkBindImageMemory(device, attachment.Image, attachment.Memory, 0);
+
+		VkImageViewCreateInfo viewInfo{};
+		viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+		viewInfo.image = attachment.Image;
+		viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+		viewInfo.format = specification.Format;
+		viewInfo.subresourceRange.aspectMask = specification.Aspect;
+		viewInfo.subresourceRange.baseMipLevel = 0;
+		viewInfo.subresourceRange.levelCount = 1;
+		viewInfo.subresourceRange.baseArrayLayer = 0;
+		viewInfo.subresourceRange.layerCount = 1;
+
+		if (vkCreateImageView(device, &viewInfo, nullptr, &attachment.View) != VK_SUCCESS)
+		{
+			std::cout << "Error: Couldn't create attachment image view!" << std::endl;
+			DestroyAttachment(device, attachment);
+			return false;
+		}
+
+		return true;
+	}
+
+	void DestroyAttachment(VkDevice device, Attachment& attachment)
+	{
+		if (attachment.View)
+			vkDestroyImageView(device, attachment.View, nullptr);
+		if (attachment.Image)
+			vkDestroyImage(device, attachment.Image, nullptr);
+		if (attachment.Memory)
+			FreeMemory(device, attachment.Memory);
+
+		attachment = {};
+	}
+
+}
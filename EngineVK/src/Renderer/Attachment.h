@@ -0,0 +1,33 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+namespace LearningVK {
+
+	struct AttachmentSpecification
+	{
+		VkExtent2D Extent = { 0, 0 };
+		VkFormat Format = VK_FORMAT_UNDEFINED;
+		VkSampleCountFlagBits Samples = VK_SAMPLE_COUNT_1_BIT;
+		VkImageUsageFlags Usage = 0;
+		VkImageAspectFlags Aspect = VK_IMAGE_ASPECT_COLOR_BIT;
+
+		// Transient attachments never leave the render pass (MSAA color, depth), so they are created with
+		// VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT and lazily allocated memory when the device has it.
+		// On tilers that memory is never committed and the attachment only lives in tile memory.
+		bool Transient = false;
+	};
+
+	struct Attachment
+	{
+		VkImage Image = VK_NULL_HANDLE;
+		VkDeviceMemory Memory = VK_NULL_HANDLE;
+		VkImageView View = VK_NULL_HANDLE;
+		VkDeviceSize Size = 0;
+		bool LazilyAllocated = false;
+	};
+
+	bool CreateAttachment(VkDevice device, VkPhysicalDevice physicalDevice, const AttachmentSpecification& specification, Attachment& attachment);
+	void DestroyAttachment(VkDevice device, Attachment& attachment);
+
+}
@@ -0,0 +1,215 @@
+#include <vkpch.h>
+
+#include "BitmapFont.h"
+
+namespace LearningVK
+{
+
+	static const char FirstGlyph = ' ';
+	static const char LastGlyph = '~';
+	static const uint32_t GlyphCount = LastGlyph - FirstGlyph + 1;
+	// Glyph cells plus the solid one
+	static const uint32_t AtlasColumns = 16;
+	static const uint32_t AtlasRows = (GlyphCount + 1 + AtlasColumns - 1) / AtlasColumns;
+	static const uint32_t SolidCell = GlyphCount;
+
+	// One byte per row from the top, the lowest 5 bits hold the row with the leftmost pixel in bit 4
+	static const uint8_t Glyphs[GlyphCount][BitmapFont::GlyphHeight] =
+	{
+		{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // space
+		{ 0x04, 0x04, 0x04, 0x04, 0x04, 0x00, 0x04 }, // !
+		{ 0x0A, 0x0A, 0x0A, 0x00, 0x00, 0x00, 0x00 }, // "
+		{ 0x0A, 0x0A, 0x1F, 0x0A, 0x1F, 0x0A, 0x0A }, // #
+		{ 0x04, 0x0F, 0x14, 0x0E, 0x05, 0x1E, 0x04 }, // $
+		{ 0x18, 0x19, 0x02, 0x04, 0x08, 0x13, 0x03 }, // %
+		{ 0x0C, 0x12, 0x14, 0x08, 0x15, 0x12, 0x0D }, // &
+		{ 0x04, 0x04, 0x04, 0x00, 0x00, 0x00, 0x00 }, // '
+		{ 0x02, 0x04, 0x08, 0x08, 0x08, 0x04, 0x02 }, // (
+		{ 0x08, 0x04, 0x02, 0x02, 0x02, 0x04, 0x08 }, // )
+		{ 0x00, 0x04, 0x15, 0x0E, 0x15, 0x04, 0x00 }, // *
+		{ 0x00, 0x04, 0x04, 0x1F, 0x04, 0x04, 0x00 }, // +
+		{ 0x00, 0x00, 0x00, 0x00, 0x0C, 0x04, 0x08 }, // ,
+		{ 0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00 }, // -
+		{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C }, // .
+		{ 0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00 }, // /
+		{ 0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E }, // 0
+		{ 0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E }, // 1
+		{ 0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F }, // 2
+		{ 0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E }, // 3
+		{ 0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02 }, // 4
+		{ 0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E }, // 5
+		{ 0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E }, // 6
+		{ 0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08 }, // 7
+		{ 0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E }, // 8
+		{ 0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C }, // 9
+		{ 0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x0C, 0x00 }, // :
+		{ 0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x04, 0x08 }, // ;
+		{ 0x02, 0x04, 0x08, 0x10, 0x08, 0x04, 0x02 }, // <
+		{ 0x00, 0x00, 0x1F, 0x00, 0x1F, 0x00, 0x00 }, // =
+		{ 0x08, 0x04, 0x02, 0x01, 0x02, 0x04, 0x08 }, // >
+		{ 0x0E, 0x11, 0x01, 0x02, 0x04, 0x00, 0x04 }, // ?
+		{ 0x0E, 0x11, 0x01, 0x0D, 0x15, 0x15, 0x0E }, // @
+		{ 0x0E, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11 }, // A
+		{ 0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E }, // B
+		{ 0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E }, // C
+		{ 0x1C, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1C }, // D
+		{ 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F }, // E
+		{ 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10 }, // F
+		{ 0x0E, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0F }, // G
+		{ 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11 }, // H
+		{ 0x0E, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E }, // I
+		{ 0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0C }, // J
+		{ 0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11 }, // K
+		{ 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F }, // L
+		{ 0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11 }, // M
+		{ 0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11 }, // N
+		{ 0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E }, // O
+		{ 0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10 }, // P
+		{ 0x0E, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0D }, // Q
+		{ 0x1E, 0x11, 0x11, 0x1E, 0x14, 0x12, 0x11 }, // R
+		{ 0x0F, 0x10, 0x10, 0x0E, 0x01, 0x01, 0x1E }, // S
+		{ 0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04 }, // T
+		{ 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E }, // U
+		{ 0x11, 0x11, 0x11, 0x11, 0x11, 0x0A, 0x04 }, // V
+		{ 0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0A }, // W
+		{ 0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11 }, // X
+		{ 0x11, 0x11, 0x11, 0x0A, 0x04, 0x04, 0x04 }, // Y
+		{ 0x1F, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1F }, // Z
+		{ 0x0E, 0x08, 0x08, 0x08, 0x08, 0x08, 0x0E }, // [
+		{ 0x00, 0x10, 0x08, 0x04, 0x02, 0x01, 0x00 }, // backslash
+		{ 0x0E, 0x02, 0x02, 0x02, 0x02, 0x02, 0x0E }, // ]
+		{ 0x04, 0x0A, 0x11, 0x00, 0x00, 0x00, 0x00 }, // ^
+		{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F }, // _
+		{ 0x08, 0x04, 0x02, 0x00, 0x00, 0x00, 0x00 }, // `
+		{ 0x00, 0x00, 0x0E, 0x01, 0x0F, 0x11, 0x0F }, // a
+		{ 0x10, 0x10, 0x16, 0x19, 0x11, 0x11, 0x1E }, // b
+		{ 0x00, 0x00, 0x0E, 0x10, 0x10, 0x11, 0x0E }, // c
+		{ 0x01, 0x01, 0x0D, 0x13, 0x11, 0x11, 0x0F }, // d
+		{ 0x00, 0x00, 0x0E, 0x11, 0x1F, 0x10, 0x0E }, // e
+		{ 0x06, 0x09, 0x08, 0x1C, 0x08, 0x08, 0x08 }, // f
+		{ 0x00, 0x0F, 0x11, 0x11, 0x0F, 0x01, 0x0E }, // g
+		{ 0x10, 0x10, 0x16, 0x19, 0x11, 0x11, 0x11 }, // h
+		{ 0x04, 0x00, 0x0C, 0x04, 0x04, 0x04, 0x0E }, // i
+		{ 0x02, 0x00, 0x06, 0x02, 0x02, 0x12, 0x0C }, // j
+		{ 0x10, 0x10, 0x12, 0x14, 0x18, 0x14, 0x12 }, // k
+		{ 0x0C, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E }, // l
+		{ 0x00, 0x00, 0x1A, 0x15, 0x15, 0x11, 0x11 }, // m
+		{ 0x00, 0x00, 0x16, 0x19, 0x11, 0x11, 0x11 }, // n
+		{ 0x00, 0x00, 0x0E, 0x11, 0x11, 0x11, 0x0E }, // o
+		{ 0x00, 0x00, 0x1E, 0x11, 0x1E, 0x10, 0x10 }, // p
+		{ 0x00, 0x00, 0x0D, 0x13, 0x0F, 0x01, 0x01 }, // q
+		{ 0x00, 0x00, 0x16, 0x19, 0x10, 0x10, 0x10 }, // r
+		{ 0x00, 0x00, 0x0E, 0x10, 0x0E, 0x01, 0x1E }, // s
+		{ 0x08, 0x08, 0x1C, 0x08, 0x08, 0x09, 0x06 }, // t
+		{ 0x00, 0x00, 0x11, 0x11, 0x11, 0x13, 0x0D }, // u
+		{ 0x00, 0x00, 0x11, 0x11, 0x11, 0x0A, 0x04 }, // v
+		{ 0x00, 0x00, 0x11, 0x11, 0x15, 0x15, 0x0A }, // w
+		{ 0x00, 0x00, 0x11, 0x0A, 0x04, 0x0A, 0x11 }, // x
+		{ 0x00, 0x00, 0x11, 0x11, 0x0F, 0x01, 0x0E }, // y
+		{ 0x00, 0x00, 0x1F, 0x02, 0x04, 0x08, 0x1F }, // z
+		{ 0x02, 0x04, 0x04, 0x08, 0x04, 0x04, 0x02 }, // {
+		{ 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04 }, // |
+		{ 0x08, 0x04, 0x04, 0x02, 0x04, 0x04, 0x08 }, // }
+		{ 0x00, 0x00, 0x08, 0x15, 0x02, 0x00, 0x00 }, // ~
+	};
+
+	BitmapFont::BitmapFont()
+	{
+		atlasExtent = { AtlasColumns * CellWidth, AtlasRows * CellHeight };
+		atlasPixels.assign(size_t(atlasExtent.width) * atlasExtent.height, 0);
+
+		for (uint32_t glyph = 0; glyph < GlyphCount; glyph++)
+		{
+			uint32_t cellX = (glyph % AtlasColumns) * CellWidth;
+			uint32_t cellY = (glyph / AtlasColumns) * CellHeight;
+
+			for (uint32_t y = 0; y < GlyphHeight; y++)
+			{
+				for (uint32_t x = 0; x < GlyphWidth; x++)
+				{
+					if (Glyphs[glyph][y] & (1u << (GlyphWidth - 1 - x)))
+						atlasPixels[size_t(cellY + y) * atlasExtent.width + cellX + x] = 0xFF;
+				}
+			}
+		}
+
+		uint32_t solidX = (SolidCell % AtlasColumns) * CellWidth;
+		uint32_t solidY = (SolidCell / AtlasColumns) * CellHeight;
+		for (uint32_t y = 0; y < CellHeight; y++)
+		{
+			for (uint32_t x = 0; x < CellWidth; x++)
+				atlasPixels[size_t(solidY + y) * atlasExtent.width + solidX + x] = 0xFF;
+		}
+
+		// The middle of the cell, so filtering never reaches a neighbour
+		solidUV = (glm::vec2(float(solidX), float(solidY)) + 0.5f * glm::vec2(float(CellWidth), float(CellHeight)))
+			/ glm::vec2(float(atlasExtent.width), float(atlasExtent.height));
+	}
+
+	glm::vec2 BitmapFont::MeasureText(std::string_view text, float scale) const
+	{
+		uint32_t columns = 0;
+		uint32_t longestLine = 0;
+		uint32_t lines = text.empty() ? 0 : 1;
+
+		for (char character : text)
+		{
+			if (character == '\n')
+			{
+				columns = 0;
+				lines++;
+				continue;
+			}
+
+			columns++;
+			longestLine = std::max(longestLine, columns);
+		}
+
+		// Without the spacing after the last column and below the last line
+		float width = longestLine > 0 ? float(longestLine * CellWidth - 1) : 0.0f;
+		float height = lines > 0 ? float(lines * CellHeight - 1) : 0.0f;
+		return glm::vec2(width, height) * scale;
+	}
+
+	void BitmapFont::DrawString(SpriteBatch& batch, SpriteBatch::MaterialId material, std::string_view text, glm::vec2 position,
+		float scale, uint32_t color, uint16_t layer) const
+	{
+		glm::vec2 glyphSize = glm::vec2(float(GlyphWidth), float(GlyphHeight)) * scale;
+		glm::vec2 glyphUVSize = glm::vec2(float(GlyphWidth), float(GlyphHeight)) / glm::vec2(float(atlasExtent.width), float(atlasExtent.height));
+
+		glm::vec2 pen = position;
+		for (char character : text)
+		{
+			if (character == '\n')
+			{
+				pen.x = position.x;
+				pen.y += float(CellHeight) * scale;
+				continue;
+			}
+
+			if (character < FirstGlyph || character > LastGlyph)
+				character = '?';
+
+			if (character != ' ')
+			{
+				glm::vec2 uv = GetCellUV(uint32_t(character - FirstGlyph));
+				batch.DrawQuad(material, pen, pen + glyphSize, uv, uv + glyphUVSize, color, layer);
+			}
+
+			pen.x += float(CellWidth) * scale;
+		}
+	}
+
+	void BitmapFont::DrawRectangle(SpriteBatch& batch, SpriteBatch::MaterialId material, glm::vec2 min, glm::vec2 max,
+		uint32_t color, uint16_t layer) const
+	{
+		batch.DrawQuad(material, min, max, solidUV, solidUV, color, layer);
+	}
+
+	glm::vec2 BitmapFont::GetCellUV(uint32_t cell) const
+	{
+		glm::vec2 texel(float((cell % AtlasColumns) * CellWidth), float((cell / AtlasColumns) * CellHeight));
+		return texel / glm::vec2(float(atlasExtent.width), float(atlasExtent.height));
+	}
+
+}
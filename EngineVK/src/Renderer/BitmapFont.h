@@ -0,0 +1,49 @@
+#pragma once
+
+#include "Renderer/SpriteBatch.h"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace LearningVK {
+
+	// Built in 5x7 pixel font covering printable ASCII, meant for debug text that needs no font files. The atlas
+	// is single channel coverage, one glyph per cell, with one cell left solid so rectangles can be drawn with the
+	// same texture and end up in the same draw as the text. Text is meant to be drawn at whole number scales and
+	// should be sampled with nearest filtering.
+	class BitmapFont
+	{
+	public:
+		static const uint32_t GlyphWidth = 5;
+		static const uint32_t GlyphHeight = 7;
+		// Glyphs plus a pixel of spacing to the right and below
+		static const uint32_t CellWidth = GlyphWidth + 1;
+		static const uint32_t CellHeight = GlyphHeight + 1;
+
+		BitmapFont();
+
+		// R8 texels, tightly packed rows
+		const std::vector<uint8_t>& GetAtlasPixels() const { return atlasPixels; }
+		VkExtent2D GetAtlasExtent() const { return atlasExtent; }
+
+		// Size of text in pixels at a scale, lines are separated by '\n'
+		glm::vec2 MeasureText(std::string_view text, float scale = 1.0f) const;
+
+		// Adds a quad per visible character with position at the top left of the text. Characters outside of
+		// printable ASCII are drawn as '?'.
+		void DrawString(SpriteBatch& batch, SpriteBatch::MaterialId material, std::string_view text, glm::vec2 position,
+			float scale, uint32_t color, uint16_t layer = 0) const;
+		void DrawRectangle(SpriteBatch& batch, SpriteBatch::MaterialId material, glm::vec2 min, glm::vec2 max,
+			uint32_t color, uint16_t layer = 0) const;
+	private:
+		glm::vec2 GetCellUV(uint32_t cell) const;
+	private:
+		std::vector<uint8_t> atlasPixels;
+		VkExtent2D atlasExtent = { 0, 0 };
+		glm::vec2 solidUV = glm::vec2(0.0f);
+	};
+
+}
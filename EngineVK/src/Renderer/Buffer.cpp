@@ -0,0 +1,117 @@
+#include <vkpch.h>
+
+#include "Buffer.h"
+#include "DeviceDispatch.h"
+#include "Memory.h"
+
+#include <iostream>
+
+namespace LearningVK
+{
+
+	bool CreateBuffer(VkDevice device, VkPhysicalDevice physicalDevice, VkDeviceSize size, VkBufferUsageFlags usage,
+		VkMemoryPropertyFlags requiredProperties, VkMemoryPropertyFlags preferredProperties, Buffer& buffer,
+		const std::vector<uint32_t>& queueFamilies)
+	{
+		std::vector<uint32_t> uniqueQueueFamilies = queueFamilies;
+		std::sort(uniqueQueueFamilies.begin(), uniqueQueueFamilies.end());
+		uniqueQueueFamilies.erase(std::unique(uniqueQueueFamilies.begin(), uniqueQueueFamilies.end()), uniqueQueueFamilies.end());
+
+		VkBufferCreateInfo bufferInfo{};
+		bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+		bufferInfo.size = size;
+		bufferInfo.usage = usage;
+		bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		if (uniqueQueueFamilies.size() > 1)
+		{
+			bufferInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+			bufferInfo.queueFamilyIndexCount = uint32_t(uniqueQueueFamilies.size());
+			bufferInfo.pQueueFamilyIndices = uniqueQueueFamilies.data();
+		}
+
+		if (vkCreateBuffer(device, &bufferInfo, nullptr, &buffer.Handle) != VK_SUCCESS)
+		{
+			std::cout << "Error: Couldn't create buffer!" << std::endl;
+			return false;
+		}
+
+		VkMemoryRequirements memoryRequirements;
+		vkGetBufferMemoryRequirements(device, buffer.Handle, &memoryRequirements);
+
+		VkMemoryPropertyFlags properties = requiredProperties | preferredProperties;
+		uint32_t memoryType = FindMemoryType(physicalDevice, memoryRequirements.memoryTypeBits, properties);
+		if (memoryType == InvalidMemoryType)
+		{
+			properties = requiredProperties;
+			memoryType = FindMemoryType(physicalDevice, memoryRequirements.memoryTypeBits, properties);
+		}
+
+		VkMemoryAllocateInfo allocateInfo{};
+		allocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+		allocateInfo.allocationSize = memoryRequirements.size;
+		allocateInfo.memoryTypeIndex = memoryType;
+
+		// Host visible buffers that are only ever copied from or into
+		const VkBufferUsageFlags transferUsage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+		bool staging = (properties & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) && (usage & ~transferUsage) == 0;
+		MemoryCategory category = staging ? MemoryCategory_Staging : MemoryCategory_Buffer;
+
+		if (memoryType == InvalidMemoryType || AllocateMemory(device, allocateInfo, category, size, buffer.Memory) != VK_SUCCESS)
+		{
+			std::cout << "Error: Couldn't allocate buffer memory!" << std::endl;
+			DestroyBuffer(device, buffer);
+			return false;
+		}
+
+		vkBindBufferMemory(device, buffer.Handle, buffer.Memory, 0);
+		buffer.Size = size;
+
+		if (properties & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+		{
+			VkPhysicalDeviceMemoryProperties memoryProperties;
+			vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memoryProperties);
+
+			buffer.Coherent = memoryProperties.memoryTypes[memoryType].propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+			vkMapMemory(device, buffer.Memory, 0, VK_WHOLE_SIZE, 0, &buffer.Mapped);
+		}
+
+		return true;
+	}
+
+	void DestroyBuffer(VkDevice device, Buffer& buffer)
+	{
+		if (buffer.Handle)
+			vkDestroyBuffer(device, buffer.Handle, nullptr);
+		if (buffer.Memory)
+			FreeMemory(device, buffer.Memory);
+
+		buffer = {};
+	}
+
+	void FlushBuffer(VkDevice device, const Buffer& buffer)
+	{
+		if (buffer.Coherent || !buffer.Mapped)
+			return;
+
+		VkMappedMemoryRange range{};
+		range.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+		range.memory = buffer.Memory;
+		range.offset = 0;
+		range.size = VK_WHOLE_SIZE;
+		GetDeviceDispatch().FlushMappedMemoryRanges(device, 1, &range);
+	}
+
+	void InvalidateBuffer(VkDevice device, const Buffer& buffer)
+	{
+		if (buffer.Coherent || !buffer.Mapped)
+			return;
+
+		VkMappedMemoryRange range{};
+		range.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+		range.memory = buffer.Memory;
+		range.offset = 0;
+		range.size = VK_WHOLE_SIZE;
+		GetDeviceDispatch().InvalidateMappedMemoryRanges(device, 1, &range);
+	}
+
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <vector>
+
+namespace LearningVK {
+
+	struct Buffer
+	{
+		VkBuffer Handle = VK_NULL_HANDLE;
+		VkDeviceMemory Memory = VK_NULL_HANDLE;
+		VkDeviceSize Size = 0;
+
+		// Host visible buffers stay mapped for their whole lifetime
+		void* Mapped = nullptr;
+		bool Coherent = true;
+	};
+
+	// Uses a memory type with both the required and preferred properties when there is one,
+	// otherwise falls back to one that only has the required properties. Buffers used by more than one
+	// queue family list them all in queueFamilies and are shared concurrently instead of transferring ownership.
+	bool CreateBuffer(VkDevice device, VkPhysicalDevice physicalDevice, VkDeviceSize size, VkBufferUsageFlags usage,
+		VkMemoryPropertyFlags requiredProperties, VkMemoryPropertyFlags preferredProperties, Buffer& buffer,
+		const std::vector<uint32_t>& queueFamilies = {});
+	void DestroyBuffer(VkDevice device, Buffer& buffer);
+
+	// Only needed for non-coherent memory, these are no-ops otherwise
+	void FlushBuffer(VkDevice device, const Buffer& buffer);
+	void InvalidateBuffer(VkDevice device, const Buffer& buffer);
+
+}
@@ -0,0 +1,88 @@
+#include <vkpch.h>
+
+#include "CommandCache.h"
+#include "DeviceDispatch.h"
+
+#include <iostream>
+
+namespace LearningVK
+{
+
+	CommandCache::CommandCache(VkDevice device, uint32_t queueFamily)
+		: device(device)
+	{
+		VkCommandPoolCreateInfo poolInfo{};
+		poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+		poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+		poolInfo.queueFamilyIndex = queueFamily;
+
+		if (vkCreateCommandPool(device, &poolInfo, nullptr, &commandPool) != VK_SUCCESS)
+			std::cout << "Error: Couldn't create the command cache's command pool!" << std::endl;
+	}
+
+	CommandCache::~CommandCache()
+	{
+		// Destroying the pool frees its command buffers
+		if (commandPool)
+			vkDestroyCommandPool(device, commandPool, nullptr);
+	}
+
+	VkCommandBuffer CommandCache::Get(uint64_t key, const RecordFunction& record)
+	{
+		const DeviceDispatch& dispatch = GetDeviceDispatch();
+
+		if (!commandPool)
+			return VK_NULL_HANDLE;
+
+		Entry& entry = entries[key];
+		if (entry.Version == version)
+		{
+			stats.Hits++;
+			return entry.CommandBuffer;
+		}
+
+		if (!entry.CommandBuffer)
+		{
+			VkCommandBufferAllocateInfo allocateInfo{};
+			allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+			allocateInfo.commandPool = commandPool;
+			allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+			allocateInfo.commandBufferCount = 1;
+
+			if (vkAllocateCommandBuffers(device, &allocateInfo, &entry.CommandBuffer) != VK_SUCCESS)
+			{
+				std::cout << "Error: Couldn't allocate a cached command buffer!" << std::endl;
+				entries.erase(key);
+				return VK_NULL_HANDLE;
+			}
+		}
+		else
+		{
+			dispatch.ResetCommandBuffer(entry.CommandBuffer, 0);
+		}
+
+		// Without VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT, so it can be submitted again
+		VkCommandBufferBeginInfo beginInfo{};
+		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+
+		entry.Version = 0;
+		if (dispatch.BeginCommandBuffer(entry.CommandBuffer, &beginInfo) != VK_SUCCESS)
+		{
+			std::cout << "Error: Couldn't begin a cached command buffer!" << std::endl;
+			return VK_NULL_HANDLE;
+		}
+
+		record(entry.CommandBuffer);
+
+		if (dispatch.EndCommandBuffer(entry.CommandBuffer) != VK_SUCCESS)
+		{
+			std::cout << "Error: Couldn't end a cached command buffer!" << std::endl;
+			return VK_NULL_HANDLE;
+		}
+
+		entry.Version = version;
+		stats.Recordings++;
+		return entry.CommandBuffer;
+	}
+
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+
+namespace LearningVK {
+
+	struct CommandCacheStats
+	{
+		// Command buffers handed out as they were, without recording anything
+		uint64_t Hits = 0;
+		uint64_t Recordings = 0;
+	};
+
+	// Records primary command buffers once and hands them out again for as long as what they record stays the same,
+	// so a frame whose commands don't change costs no recording at all. Whatever the commands depend on that can be
+	// recreated, like pipelines, framebuffers or descriptor sets, has to Invalidate() the cache. Command buffers are
+	// only recorded again the next time they're asked for, so ones that aren't used anymore cost nothing.
+	//
+	// A command buffer is re-recorded in place, so the GPU must be done with it by then. Keys have to tell apart
+	// every command buffer that can be in flight at the same time, like the ones of different frame slots.
+	class CommandCache
+	{
+	public:
+		// Records between vkBeginCommandBuffer and vkEndCommandBuffer
+		using RecordFunction = std::function<void(VkCommandBuffer)>;
+
+		CommandCache(VkDevice device, uint32_t queueFamily);
+		// The GPU must be done with every command buffer
+		~CommandCache();
+
+		CommandCache(const CommandCache&) = delete;
+		CommandCache& operator=(const CommandCache&) = delete;
+
+		// Returns the key's command buffer, recorded with record first when it's new or the cache was invalidated
+		// since it was recorded. Returns VK_NULL_HANDLE when it couldn't be recorded.
+		VkCommandBuffer Get(uint64_t key, const RecordFunction& record);
+
+		// Every command buffer is recorded again the next time it's asked for
+		void Invalidate() { version++; }
+
+		size_t GetCommandBufferCount() const { return entries.size(); }
+		const CommandCacheStats& GetStats() const { return stats; }
+	private:
+		struct Entry
+		{
+			VkCommandBuffer CommandBuffer = VK_NULL_HANDLE;
+			// Cache version it was recorded at, 0 if it isn't recorded
+			uint64_t Version = 0;
+		};
+	private:
+		VkDevice device;
+		VkCommandPool commandPool = VK_NULL_HANDLE;
+
+		std::unordered_map<uint64_t, Entry> entries;
+		uint64_t version = 1;
+		CommandCacheStats stats;
+	};
+
+}
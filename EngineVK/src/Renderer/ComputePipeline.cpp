@@ -0,0 +1,89 @@
+#include <vkpch.h>
+
+#include "ComputePipeline.h"
+
+#include <iostream>
+
+namespace LearningVK
+{
+
+	bool CreateComputePipeline(VkDevice device, const ComputePipelineSpecification& specification, ComputePipeline& pipeline)
+	{
+		VkDescriptorSetLayoutCreateInfo setLayoutInfo{};
+		setLayoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+		setLayoutInfo.bindingCount = uint32_t(specification.Bindings.size());
+		setLayoutInfo.pBindings = specification.Bindings.data();
+
+		if (vkCreateDescriptorSetLayout(device, &setLayoutInfo, nullptr, &pipeline.SetLayout) != VK_SUCCESS)
+		{
+			std::cout << "Error: Couldn't create compute descriptor set layout!" << std::endl;
+			return false;
+		}
+
+		VkPushConstantRange pushConstantRange{};
+		pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+		pushConstantRange.offset = 0;
+		pushConstantRange.size = specification.PushConstantSize;
+
+		VkPipelineLayoutCreateInfo layoutInfo{};
+		layoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		layoutInfo.setLayoutCount = 1;
+		layoutInfo.pSetLayouts = &pipeline.SetLayout;
+		layoutInfo.pushConstantRangeCount = specification.PushConstantSize > 0 ? 1 : 0;
+		layoutInfo.pPushConstantRanges = &pushConstantRange;
+
+		if (vkCreatePipelineLayout(device, &layoutInfo, nullptr, &pipeline.Layout) != VK_SUCCESS)
+		{
+			std::cout << "Error: Couldn't create compute pipeline layout!" << std::endl;
+			DestroyComputePipeline(device, pipeline);
+			return false;
+		}
+
+		VkShaderModuleCreateInfo moduleInfo{};
+		moduleInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+		moduleInfo.codeSize = specification.Code->size() * sizeof(uint32_t);
+		moduleInfo.pCode = specification.Code->data();
+
+		VkShaderModule shaderModule;
+		if (vkCreateShaderModule(device, &moduleInfo, nullptr, &shaderModule) != VK_SUCCESS)
+		{
+			std::cout << "Error: Couldn't create compute shader module!" << std::endl;
+			DestroyComputePipeline(device, pipeline);
+			return false;
+		}
+
+		VkComputePipelineCreateInfo pipelineInfo{};
+		pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+		pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+		pipelineInfo.stage.module = shaderModule;
+		pipelineInfo.stage.pName = "main";
+		pipelineInfo.stage.pSpecializationInfo = specification.Specialization;
+		pipelineInfo.layout = pipeline.Layout;
+
+		VkResult result = vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline.Pipeline);
+		vkDestroyShaderModule(device, shaderModule, nullptr);
+
+		if (result != VK_SUCCESS)
+		{
+			std::cout << "Error: Couldn't create compute pipeline!" << std::endl;
+			DestroyComputePipeline(device, pipeline);
+			return false;
+		}
+
+		return true;
+	}
+
+	void DestroyComputePipeline(VkDevice device, ComputePipeline& pipeline)
+	{
+		if (pipeline.Pipeline)
+			vkDestroyPipeline(device, pipeline.Pipeline, nullptr);
+		if (pipeline.Layout)
+			vkDestroyPipelineLayout(device, pipeline.Layout, nullptr);
+		if (pipeline.SetLayout)
+			vkDestroyDescriptorSetLayout(device, pipeline.SetLayout, nullptr);
+
+		pipeline = {};
+	}
+
+}
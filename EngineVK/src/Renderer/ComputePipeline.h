@@ -0,0 +1,31 @@
+#pragma once
+
+#include "Renderer/Descriptors.h"
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace LearningVK {
+
+	struct ComputePipelineSpecification
+	{
+		const std::vector<uint32_t>* Code = nullptr;
+		std::vector<VkDescriptorSetLayoutBinding> Bindings;
+		uint32_t PushConstantSize = 0;
+		const VkSpecializationInfo* Specialization = nullptr;
+	};
+
+	// Compute pipelines use a single descriptor set, laid out by the specification's bindings
+	struct ComputePipeline
+	{
+		VkPipeline Pipeline = VK_NULL_HANDLE;
+		VkPipelineLayout Layout = VK_NULL_HANDLE;
+		VkDescriptorSetLayout SetLayout = VK_NULL_HANDLE;
+	};
+
+	bool CreateComputePipeline(VkDevice device, const ComputePipelineSpecification& specification, ComputePipeline& pipeline);
+	void DestroyComputePipeline(VkDevice device, ComputePipeline& pipeline);
+
+}
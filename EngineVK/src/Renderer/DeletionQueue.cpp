@@ -0,0 +1,34 @@
+#include <vkpch.h>
+
+#include "DeletionQueue.h"
+
+namespace LearningVK
+{
+
+	void DeletionQueue::Push(uint64_t lastUsedFrame, std::function<void()>&& destroy)
+	{
+		// Frames are retired in order, so keeping the queue sorted lets Flush stop at the first pending entry
+		auto it = entries.end();
+		while (it != entries.begin() && std::prev(it)->Frame > lastUsedFrame)
+			--it;
+
+		entries.insert(it, { lastUsedFrame, std::move(destroy) });
+	}
+
+	void DeletionQueue::Flush(uint64_t completedFrameCount)
+	{
+		while (!entries.empty() && entries.front().Frame < completedFrameCount)
+		{
+			entries.front().Destroy();
+			entries.pop_front();
+		}
+	}
+
+	void DeletionQueue::FlushAll()
+	{
+		for (Entry& entry : entries)
+			entry.Destroy();
+		entries.clear();
+	}
+
+}
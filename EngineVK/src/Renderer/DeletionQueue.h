@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+
+namespace LearningVK {
+
+	// Retired resources are queued with the number of the last frame that may still use them and
+	// destroyed in one batch once the GPU has finished that frame, so nothing has to wait for the device to idle.
+	// Frames are numbered from 0 in submission order.
+	class DeletionQueue
+	{
+	public:
+		void Push(uint64_t lastUsedFrame, std::function<void()>&& destroy);
+
+		// Destroys everything last used by a frame before completedFrameCount
+		void Flush(uint64_t completedFrameCount);
+
+		// Destroys everything, only call this once the device is idle
+		void FlushAll();
+
+		size_t GetPendingCount() const { return entries.size(); }
+	private:
+		struct Entry
+		{
+			uint64_t Frame;
+			std::function<void()> Destroy;
+		};
+
+		std::deque<Entry> entries;
+	};
+
+}
@@ -0,0 +1,245 @@
+#include <vkpch.h>
+
+#include "DepthPyramid.h"
+#include "DeviceDispatch.h"
+#include "Memory.h"
+
+#include <iostream>
+
+namespace LearningVK
+{
+
+	struct ReductionPushConstants
+	{
+		uint32_t InputSize[2];
+		uint32_t OutputSize[2];
+	};
+
+	static uint32_t PreviousPowerOfTwo(uint32_t value)
+	{
+		uint32_t result = 1;
+		while (result * 2 <= value)
+			result *= 2;
+		return result;
+	}
+
+	static VkExtent2D GetLevelExtent(VkExtent2D extent, uint32_t level)
+	{
+		return { std::max(extent.width >> level, 1u), std::max(extent.height >> level, 1u) };
+	}
+
+	DepthPyramid::DepthPyramid(VkDevice device, VkPhysicalDevice physicalDevice, const std::vector<uint32_t>& reduceShader)
+		: device(device), physicalDevice(physicalDevice)
+	{
+		ComputePipelineSpecification pipelineSpecification;
+		pipelineSpecification.Code = &reduceShader;
+		pipelineSpecification.Bindings = { CombinedImageSamplerBinding(0), StorageImageBinding(1) };
+		pipelineSpecification.PushConstantSize = sizeof(ReductionPushConstants);
+
+		if (!CreateComputePipeline(device, pipelineSpecification, reducePipeline))
+			std::cout << "Error: Couldn't create the depth reduction pipeline!" << std::endl;
+
+		// Levels are always read at exact texel positions, filtering would blend depths and break the test
+		VkSamplerCreateInfo samplerInfo{};
+		samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+		samplerInfo.magFilter = VK_FILTER_NEAREST;
+		samplerInfo.minFilter = VK_FILTER_NEAREST;
+		samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+		samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		samplerInfo.minLod = 0.0f;
+		samplerInfo.maxLod = 16.0f;
+
+		if (vkCreateSampler(device, &samplerInfo, nullptr, &sampler) != VK_SUCCESS)
+			std::cout << "Error: Couldn't create the depth pyramid sampler!" << std::endl;
+	}
+
+	DepthPyramid::~DepthPyramid()
+	{
+		DestroyResources(device, resources);
+		vkDestroySampler(device, sampler, nullptr);
+		DestroyComputePipeline(device, reducePipeline);
+	}
+
+	void DepthPyramid::Resize(VkExtent2D depthExtent, VkImageView depthView, DeletionQueue& deletionQueue, uint64_t frameNumber)
+	{
+		if (resources.Image)
+		{
+			VkDevice device = this->device;
+			deletionQueue.Push(frameNumber, [device, retired = std::move(resources)]() mutable {
+				DestroyResources(device, retired);
+			});
+			resources = {};
+		}
+
+		this->depthExtent = depthExtent;
+		extent = { PreviousPowerOfTwo(depthExtent.width), PreviousPowerOfTwo(depthExtent.height) };
+		levelCount = 1;
+		while ((std::max(extent.width, extent.height) >> levelCount) > 0)
+			levelCount++;
+		initialized = false;
+
+		VkImageCreateInfo imageInfo{};
+		imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+		imageInfo.imageType = VK_IMAGE_TYPE_2D;
+		imageInfo.format = VK_FORMAT_R32_SFLOAT;
+		imageInfo.extent = { extent.width, extent.height, 1 };
+		imageInfo.mipLevels = levelCount;
+		imageInfo.arrayLayers = 1;
+		imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+		imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+		imageInfo.usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_STORAGE_BIT;
+		imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+		if (vkCreateImage(device, &imageInfo, nullptr, &resources.Image) != VK_SUCCESS)
+		{
+			std::cout << "Error: Couldn't create the depth pyramid!" << std::endl;
+			return;
+		}
+
+		VkMemoryRequirements memoryRequirements;
+		vkGetImageMemoryRequirements(device, resources.Image, &memoryRequirements);
+
+		VkMemoryAllocateInfo allocateInfo{};
+		allocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+		allocateInfo.allocationSize = memoryRequirements.size;
+		allocateInfo.memoryTypeIndex = FindMemoryType(physicalDevice, memoryRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+		if (allocateInfo.memoryTypeIndex == InvalidMemoryType || AllocateMemory(device, allocateInfo, MemoryCategory_Image, memoryRequirements.size, resources.Memory) != VK_SUCCESS)
+		{
+			std::cout << "Error: Couldn't allocate depth pyramid memory!" << std::endl;
+			return;
+		}
+		vkBindImageMemory(device, resources.Image, resources.Memory, 0);
+
+		VkImageViewCreateInfo viewInfo{};
+		viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+		viewInfo.image = resources.Image;
+		viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+		viewInfo.format = VK_FORMAT_R32_SFLOAT;
+		viewInfo.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, levelCount, 0, 1 };
+		vkCreateImageView(device, &viewInfo, nullptr, &resources.View);
+
+		resources.LevelViews.resize(levelCount);
+		for (uint32_t level = 0; level < levelCount; level++)
+		{
+			viewInfo.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, level, 1, 0, 1 };
+			vkCreateImageView(device, &viewInfo, nullptr, &resources.LevelViews[level]);
+		}
+
+		std::array<VkDescriptorPoolSize, 2> poolSizes = { {
+			{ VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, levelCount },
+			{ VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, levelCount }
+		} };
+
+		VkDescriptorPoolCreateInfo poolInfo{};
+		poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+		poolInfo.maxSets = levelCount;
+		poolInfo.poolSizeCount = uint32_t(poolSizes.size());
+		poolInfo.pPoolSizes = poolSizes.data();
+
+		if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &resources.DescriptorPool) != VK_SUCCESS)
+		{
+			std::cout << "Error: Couldn't create the depth pyramid descriptor pool!" << std::endl;
+			return;
+		}
+
+		std::vector<VkDescriptorSetLayout> setLayouts(levelCount, reducePipeline.SetLayout);
+		VkDescriptorSetAllocateInfo setInfo{};
+		setInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+		setInfo.descriptorPool = resources.DescriptorPool;
+		setInfo.descriptorSetCount = levelCount;
+		setInfo.pSetLayouts = setLayouts.data();
+
+		resources.LevelSets.resize(levelCount);
+		vkAllocateDescriptorSets(device, &setInfo, resources.LevelSets.data());
+
+		// Every level reads the one before it, the first one reads the depth buffer
+		for (uint32_t level = 0; level < levelCount; level++)
+		{
+			VkImageView input = level == 0 ? depthView : resources.LevelViews[level - 1];
+			VkImageLayout inputLayout = level == 0 ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_GENERAL;
+
+			DescriptorWriter(resources.LevelSets[level])
+				.WriteImage(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, input, inputLayout, sampler)
+				.WriteImage(1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, resources.LevelViews[level], VK_IMAGE_LAYOUT_GENERAL)
+				.Update(device);
+		}
+	}
+
+	void DepthPyramid::RecordInitialization(VkCommandBuffer commandBuffer)
+	{
+		const DeviceDispatch& dispatch = GetDeviceDispatch();
+
+		if (initialized || !resources.Image)
+			return;
+
+		VkImageMemoryBarrier toGeneral{};
+		toGeneral.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		toGeneral.srcAccessMask = 0;
+		toGeneral.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+		toGeneral.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		toGeneral.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+		toGeneral.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		toGeneral.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		toGeneral.image = resources.Image;
+		toGeneral.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, levelCount, 0, 1 };
+		dispatch.CmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &toGeneral);
+
+		initialized = true;
+	}
+
+	void DepthPyramid::RecordBuild(VkCommandBuffer commandBuffer)
+	{
+		const DeviceDispatch& dispatch = GetDeviceDispatch();
+
+		if (!resources.Image)
+			return;
+
+		dispatch.CmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, reducePipeline.Pipeline);
+
+		for (uint32_t level = 0; level < levelCount; level++)
+		{
+			VkExtent2D inputExtent = level == 0 ? depthExtent : GetLevelExtent(extent, level - 1);
+			VkExtent2D outputExtent = GetLevelExtent(extent, level);
+
+			ReductionPushConstants pushConstants;
+			pushConstants.InputSize[0] = inputExtent.width;
+			pushConstants.InputSize[1] = inputExtent.height;
+			pushConstants.OutputSize[0] = outputExtent.width;
+			pushConstants.OutputSize[1] = outputExtent.height;
+
+			dispatch.CmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, reducePipeline.Layout, 0, 1, &resources.LevelSets[level], 0, nullptr);
+			dispatch.CmdPushConstants(commandBuffer, reducePipeline.Layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pushConstants), &pushConstants);
+			dispatch.CmdDispatch(commandBuffer, (outputExtent.width + 7) / 8, (outputExtent.height + 7) / 8, 1);
+
+			// The next level reads this one
+			VkImageMemoryBarrier levelWritten{};
+			levelWritten.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+			levelWritten.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+			levelWritten.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+			levelWritten.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+			levelWritten.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+			levelWritten.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			levelWritten.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			levelWritten.image = resources.Image;
+			levelWritten.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, level, 1, 0, 1 };
+			dispatch.CmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &levelWritten);
+		}
+	}
+
+	void DepthPyramid::DestroyResources(VkDevice device, Resources& resources)
+	{
+		vkDestroyDescriptorPool(device, resources.DescriptorPool, nullptr);
+		for (VkImageView levelView : resources.LevelViews)
+			vkDestroyImageView(device, levelView, nullptr);
+		vkDestroyImageView(device, resources.View, nullptr);
+		vkDestroyImage(device, resources.Image, nullptr);
+		FreeMemory(device, resources.Memory);
+
+		resources = {};
+	}
+
+}
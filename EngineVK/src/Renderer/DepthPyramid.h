@@ -0,0 +1,67 @@
+#pragma once
+
+#include "Renderer/ComputePipeline.h"
+#include "Renderer/DeletionQueue.h"
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace LearningVK {
+
+	// Hierarchical depth buffer for occlusion culling. Every texel holds the farthest depth of the area it covers,
+	// so an object whose nearest depth is behind it is hidden. Level 0 is the depth buffer rounded down to a power
+	// of two, which keeps every following level an exact 2x2 reduction.
+	class DepthPyramid
+	{
+	public:
+		// reduceShader is depth_reduce.comp
+		DepthPyramid(VkDevice device, VkPhysicalDevice physicalDevice, const std::vector<uint32_t>& reduceShader);
+		// The GPU must be done with the pyramid
+		~DepthPyramid();
+
+		// Sizes the pyramid for a depth buffer, the resources of the old size are retired through the deletion queue.
+		// The depth view must stay valid for as long as the pyramid uses it.
+		void Resize(VkExtent2D depthExtent, VkImageView depthView, DeletionQueue& deletionQueue, uint64_t frameNumber);
+
+		// Moves a newly created pyramid into VK_IMAGE_LAYOUT_GENERAL, record it every frame before anything samples
+		// the pyramid. It does nothing once the pyramid has been initialised.
+		void RecordInitialization(VkCommandBuffer commandBuffer);
+
+		// Reduces the depth buffer into every level. The depth writes must already be visible to compute shaders
+		// and the depth buffer in VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL.
+		void RecordBuild(VkCommandBuffer commandBuffer);
+
+		// View of every level, sampled in VK_IMAGE_LAYOUT_GENERAL with GetSampler()
+		VkImageView GetView() const { return resources.View; }
+		VkSampler GetSampler() const { return sampler; }
+		VkExtent2D GetExtent() const { return extent; }
+		uint32_t GetLevelCount() const { return levelCount; }
+	private:
+		struct Resources
+		{
+			VkImage Image = VK_NULL_HANDLE;
+			VkDeviceMemory Memory = VK_NULL_HANDLE;
+			VkImageView View = VK_NULL_HANDLE;
+			std::vector<VkImageView> LevelViews;
+			VkDescriptorPool DescriptorPool = VK_NULL_HANDLE;
+			std::vector<VkDescriptorSet> LevelSets;
+		};
+
+		static void DestroyResources(VkDevice device, Resources& resources);
+	private:
+		VkDevice device;
+		VkPhysicalDevice physicalDevice;
+
+		ComputePipeline reducePipeline;
+		VkSampler sampler = VK_NULL_HANDLE;
+
+		Resources resources;
+		VkExtent2D depthExtent = { 0, 0 };
+		VkExtent2D extent = { 0, 0 };
+		uint32_t levelCount = 0;
+		bool initialized = false;
+	};
+
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+namespace LearningVK {
+
+	inline VkDescriptorSetLayoutBinding DescriptorBinding(uint32_t binding, VkDescriptorType type, VkShaderStageFlags stages)
+	{
+		VkDescriptorSetLayoutBinding layoutBinding{};
+		layoutBinding.binding = binding;
+		layoutBinding.descriptorType = type;
+		layoutBinding.descriptorCount = 1;
+		layoutBinding.stageFlags = stages;
+		return layoutBinding;
+	}
+
+	inline VkDescriptorSetLayoutBinding StorageBufferBinding(uint32_t binding, VkShaderStageFlags stages = VK_SHADER_STAGE_COMPUTE_BIT)
+	{
+		return DescriptorBinding(binding, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, stages);
+	}
+
+	inline VkDescriptorSetLayoutBinding UniformBufferBinding(uint32_t binding, VkShaderStageFlags stages = VK_SHADER_STAGE_COMPUTE_BIT)
+	{
+		return DescriptorBinding(binding, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, stages);
+	}
+
+	inline VkDescriptorSetLayoutBinding CombinedImageSamplerBinding(uint32_t binding, VkShaderStageFlags stages = VK_SHADER_STAGE_COMPUTE_BIT)
+	{
+		return DescriptorBinding(binding, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, stages);
+	}
+
+	inline VkDescriptorSetLayoutBinding StorageImageBinding(uint32_t binding, VkShaderStageFlags stages = VK_SHADER_STAGE_COMPUTE_BIT)
+	{
+		return DescriptorBinding(binding, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, stages);
+	}
+
+	// Collects the writes for one descriptor set and applies them with a single vkUpdateDescriptorSets
+	class DescriptorWriter
+	{
+	public:
+		explicit DescriptorWriter(VkDescriptorSet set)
+			: set(set) {}
+
+		DescriptorWriter& WriteBuffer(uint32_t binding, VkDescriptorType type, VkBuffer buffer, VkDeviceSize offset = 0, VkDeviceSize range = VK_WHOLE_SIZE)
+		{
+			bufferInfos.push_back({ buffer, offset, range });
+			VkWriteDescriptorSet& write = AddWrite(binding, type);
+			write.pBufferInfo = &bufferInfos.back();
+			return *this;
+		}
+
+		DescriptorWriter& WriteImage(uint32_t binding, VkDescriptorType type, VkImageView view, VkImageLayout layout, VkSampler sampler = VK_NULL_HANDLE)
+		{
+			imageInfos.push_back({ sampler, view, layout });
+			VkWriteDescriptorSet& write = AddWrite(binding, type);
+			write.pImageInfo = &imageInfos.back();
+			return *this;
+		}
+
+		void Update(VkDevice device) const
+		{
+			vkUpdateDescriptorSets(device, uint32_t(writes.size()), writes.data(), 0, nullptr);
+		}
+	private:
+		VkWriteDescriptorSet& AddWrite(uint32_t binding, VkDescriptorType type)
+		{
+			VkWriteDescriptorSet& write = writes.emplace_back();
+			write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			write.dstSet = set;
+			write.dstBinding = binding;
+			write.descriptorCount = 1;
+			write.descriptorType = type;
+			return write;
+		}
+	private:
+		VkDescriptorSet set;
+		// Deques so the infos the writes point at never move
+		std::deque<VkDescriptorBufferInfo> bufferInfos;
+		std::deque<VkDescriptorImageInfo> imageInfos;
+		std::vector<VkWriteDescriptorSet> writes;
+	};
+
+}
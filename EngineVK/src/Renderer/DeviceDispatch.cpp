@@ -0,0 +1,35 @@
+#include <vkpch.h>
+
+#include "DeviceDispatch.h"
+
+#include <iostream>
+
+namespace LearningVK
+{
+
+	// Not a function local static, so fetching it doesn't check a guard on every call
+	static DeviceDispatch deviceDispatch;
+
+	bool LoadDeviceDispatch(VkDevice device, DeviceDispatch& dispatch)
+	{
+		bool complete = true;
+
+		#define LEARNINGVK_LOAD_FUNCTION(name) \
+			dispatch.name = reinterpret_cast<PFN_vk##name>(vkGetDeviceProcAddr(device, "vk" #name)); \
+			if (!dispatch.name) \
+			{ \
+				std::cout << "Error: Couldn't load vk" #name "!" << std::endl; \
+				complete = false; \
+			}
+		LEARNINGVK_DEVICE_FUNCTIONS(LEARNINGVK_LOAD_FUNCTION)
+		#undef LEARNINGVK_LOAD_FUNCTION
+
+		return complete;
+	}
+
+	DeviceDispatch& GetDeviceDispatch()
+	{
+		return deviceDispatch;
+	}
+
+}
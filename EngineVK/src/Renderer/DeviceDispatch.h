@@ -0,0 +1,59 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+namespace LearningVK {
+
+	// Device level functions loaded into the dispatch table, named without their vk prefix
+	#define LEARNINGVK_DEVICE_FUNCTIONS(X) \
+		X(CmdBeginRenderPass) \
+		X(CmdBindDescriptorSets) \
+		X(CmdBindIndexBuffer) \
+		X(CmdBindPipeline) \
+		X(CmdBindVertexBuffers) \
+		X(CmdCopyBuffer) \
+		X(CmdCopyBufferToImage) \
+		X(CmdCopyImage) \
+		X(CmdCopyImageToBuffer) \
+		X(CmdDispatch) \
+		X(CmdDraw) \
+		X(CmdDrawIndexed) \
+		X(CmdDrawIndexedIndirectCount) \
+		X(CmdEndRenderPass) \
+		X(CmdFillBuffer) \
+		X(CmdPipelineBarrier) \
+		X(CmdPushConstants) \
+		X(CmdResetQueryPool) \
+		X(CmdSetScissor) \
+		X(CmdSetViewport) \
+		X(CmdWriteTimestamp) \
+		X(BeginCommandBuffer) \
+		X(EndCommandBuffer) \
+		X(ResetCommandBuffer) \
+		X(QueueSubmit) \
+		X(QueuePresentKHR) \
+		X(AcquireNextImageKHR) \
+		X(WaitForFences) \
+		X(ResetFences) \
+		X(GetFenceStatus) \
+		X(FlushMappedMemoryRanges) \
+		X(InvalidateMappedMemoryRanges)
+
+	// Device level functions fetched with vkGetDeviceProcAddr. The loader's exported functions look up the device's
+	// dispatch table on every call before jumping to the driver, these go to the driver straight away. Worth it for
+	// the calls made many times a frame, like recording commands, creation and destruction can keep the exported ones.
+	struct DeviceDispatch
+	{
+		#define LEARNINGVK_DISPATCH_MEMBER(name) PFN_vk##name name = nullptr;
+		LEARNINGVK_DEVICE_FUNCTIONS(LEARNINGVK_DISPATCH_MEMBER)
+		#undef LEARNINGVK_DISPATCH_MEMBER
+	};
+
+	// Fills the table with the device's functions, the extensions they belong to must be enabled on the device.
+	// Returns false when any of them is missing.
+	bool LoadDeviceDispatch(VkDevice device, DeviceDispatch& dispatch);
+
+	// The table of the application's device, loaded with LoadDeviceDispatch right after creating the device
+	DeviceDispatch& GetDeviceDispatch();
+
+}
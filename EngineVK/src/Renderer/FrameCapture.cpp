@@ -0,0 +1,185 @@
+#include <vkpch.h>
+
+#include "FrameCapture.h"
+#include "DeviceDispatch.h"
+#include "Core/ImageWriter.h"
+
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+
+namespace LearningVK
+{
+
+	FrameCapture::FrameCapture(VkDevice device, VkPhysicalDevice physicalDevice, const FrameCaptureSpecification& specification)
+		: device(device), physicalDevice(physicalDevice), specification(specification)
+	{
+		std::filesystem::create_directories(specification.OutputDirectory);
+		if (specification.Format == CaptureFormat::Raw)
+			rawStream.open(specification.OutputDirectory + "/capture.raw", std::ios::binary);
+
+		for (uint32_t i = 0; i < std::max(specification.RingSize, 1u); i++)
+			slots.push_back(std::make_unique<Slot>());
+
+		encoders = std::make_unique<ThreadPool>(specification.WorkerCount);
+		startTime = std::chrono::steady_clock::now();
+	}
+
+	FrameCapture::~FrameCapture()
+	{
+		encoders.reset();
+
+		for (auto& slot : slots)
+			DestroyBuffer(device, slot->Readback);
+	}
+
+	bool FrameCapture::RecordCopy(VkCommandBuffer commandBuffer, VkImage image, VkFormat format, VkExtent2D extent, uint64_t frameNumber)
+	{
+		const DeviceDispatch& dispatch = GetDeviceDispatch();
+
+		bool swapRedBlue = format == VK_FORMAT_B8G8R8A8_SRGB || format == VK_FORMAT_B8G8R8A8_UNORM;
+		if (!swapRedBlue && format != VK_FORMAT_R8G8B8A8_SRGB && format != VK_FORMAT_R8G8B8A8_UNORM)
+		{
+			framesDropped++;
+			return false;
+		}
+
+		Slot& slot = *slots[nextSlot];
+		if (slot.State != SlotState::Free)
+		{
+			framesDropped++;
+			return false;
+		}
+
+		VkDeviceSize size = VkDeviceSize(extent.width) * extent.height * 4;
+		if (slot.Readback.Size < size)
+		{
+			// Free slots aren't used by the GPU anymore so they can be grown in place
+			DestroyBuffer(device, slot.Readback);
+			if (!CreateBuffer(device, physicalDevice, size, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, VK_MEMORY_PROPERTY_HOST_CACHED_BIT, slot.Readback))
+			{
+				framesDropped++;
+				return false;
+			}
+		}
+
+		VkImageMemoryBarrier toTransfer{};
+		toTransfer.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		toTransfer.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+		toTransfer.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+		toTransfer.oldLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+		toTransfer.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+		toTransfer.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		toTransfer.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		toTransfer.image = image;
+		toTransfer.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+		dispatch.CmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &toTransfer);
+
+		VkBufferImageCopy region{};
+		region.bufferOffset = 0;
+		region.bufferRowLength = 0;
+		region.bufferImageHeight = 0;
+		region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+		region.imageOffset = { 0, 0, 0 };
+		region.imageExtent = { extent.width, extent.height, 1 };
+		dispatch.CmdCopyImageToBuffer(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, slot.Readback.Handle, 1, &region);
+
+		VkImageMemoryBarrier toPresent = toTransfer;
+		toPresent.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+		toPresent.dstAccessMask = 0;
+		toPresent.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+		toPresent.newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+
+		VkBufferMemoryBarrier toHost{};
+		toHost.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+		toHost.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		toHost.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+		toHost.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		toHost.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		toHost.buffer = slot.Readback.Handle;
+		toHost.offset = 0;
+		toHost.size = VK_WHOLE_SIZE;
+		dispatch.CmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT | VK_PIPELINE_STAGE_HOST_BIT, 0, 0, nullptr, 1, &toHost, 1, &toPresent);
+
+		slot.State = SlotState::Copying;
+		slot.Frame = frameNumber;
+		slot.Extent = extent;
+		slot.SwapRedBlue = swapRedBlue;
+		nextSlot = (nextSlot + 1) % uint32_t(slots.size());
+		return true;
+	}
+
+	void FrameCapture::Poll(uint64_t completedFrameCount)
+	{
+		for (auto& slot : slots)
+		{
+			if (slot->State != SlotState::Copying || slot->Frame >= completedFrameCount)
+				continue;
+
+			InvalidateBuffer(device, slot->Readback);
+			slot->State = SlotState::Encoding;
+
+			Slot* encodedSlot = slot.get();
+			encoders->Submit([this, encodedSlot]() { Encode(*encodedSlot); });
+		}
+	}
+
+	void FrameCapture::Wait()
+	{
+		encoders->Wait();
+	}
+
+	FrameCaptureStats FrameCapture::GetStats() const
+	{
+		FrameCaptureStats stats;
+		stats.FramesWritten = framesWritten;
+		stats.FramesDropped = framesDropped;
+		stats.BytesWritten = bytesWritten;
+		stats.Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+		return stats;
+	}
+
+	void FrameCapture::Encode(Slot& slot)
+	{
+		uint32_t width = slot.Extent.width, height = slot.Extent.height;
+		uint64_t frame = slot.Frame;
+		bool swapRedBlue = slot.SwapRedBlue;
+
+		// Copy the pixels out first so the readback buffer can go straight back to the renderer
+		std::vector<uint8_t> pixels(size_t(width) * height * 4);
+		std::memcpy(pixels.data(), slot.Readback.Mapped, pixels.size());
+		slot.State = SlotState::Free;
+
+		for (size_t i = 0; i < pixels.size(); i += 4)
+		{
+			if (swapRedBlue)
+				std::swap(pixels[i], pixels[i + 2]);
+			pixels[i + 3] = 255;
+		}
+
+		if (specification.Format == CaptureFormat::PNG)
+		{
+			std::ostringstream path;
+			path << specification.OutputDirectory << "/frame_" << std::setw(6) << std::setfill('0') << frame << ".png";
+			if (!WritePNG(path.str(), width, height, pixels.data()))
+			{
+				std::cout << "Error: Couldn't write " << path.str() << "!" << std::endl;
+				return;
+			}
+		}
+		else
+		{
+			std::lock_guard<std::mutex> lock(rawStreamMutex);
+			rawStream.write((const char*)&width, sizeof(width));
+			rawStream.write((const char*)&height, sizeof(height));
+			rawStream.write((const char*)&frame, sizeof(frame));
+			rawStream.write((const char*)pixels.data(), pixels.size());
+		}
+
+		framesWritten++;
+		bytesWritten += pixels.size();
+	}
+
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "Core/ThreadPool.h"
+#include "Renderer/Buffer.h"
+
+#include <vulkan/vulkan.h>
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace LearningVK {
+
+	enum class CaptureFormat
+	{
+		// One PNG file per frame
+		PNG,
+		// A single capture.raw stream, every frame is a header of width, height (uint32) and frame number (uint64)
+		// followed by the RGBA8 pixels
+		Raw
+	};
+
+	struct FrameCaptureSpecification
+	{
+		std::string OutputDirectory = "captures";
+		CaptureFormat Format = CaptureFormat::PNG;
+
+		// Number of readback buffers, when they're all busy frames are dropped instead of stalling the renderer
+		uint32_t RingSize = 4;
+		uint32_t WorkerCount = 2;
+	};
+
+	struct FrameCaptureStats
+	{
+		uint64_t FramesWritten = 0;
+		uint64_t FramesDropped = 0;
+		uint64_t BytesWritten = 0;
+		double Seconds = 0.0;
+
+		double GetFramesPerSecond() const { return Seconds > 0.0 ? FramesWritten / Seconds : 0.0; }
+		double GetMegabytesPerSecond() const { return Seconds > 0.0 ? BytesWritten / (1024.0 * 1024.0) / Seconds : 0.0; }
+	};
+
+	// Copies rendered frames into a ring of persistently mapped host-visible buffers and hands them to worker
+	// threads for encoding once the GPU is done with them. Nothing in here ever waits on the GPU.
+	class FrameCapture
+	{
+	public:
+		FrameCapture(VkDevice device, VkPhysicalDevice physicalDevice, const FrameCaptureSpecification& specification);
+		// The GPU must be done with every recorded copy, Poll them out first to keep those frames
+		~FrameCapture();
+
+		// Records a copy of a swapchain image in VK_IMAGE_LAYOUT_PRESENT_SRC_KHR after the render pass, returns
+		// false when the frame was dropped. The image needs VK_IMAGE_USAGE_TRANSFER_SRC_BIT.
+		bool RecordCopy(VkCommandBuffer commandBuffer, VkImage image, VkFormat format, VkExtent2D extent, uint64_t frameNumber);
+
+		// Hands every copy from a frame before completedFrameCount to the encoders
+		void Poll(uint64_t completedFrameCount);
+
+		// Blocks until the encoders have written every frame handed to them
+		void Wait();
+
+		FrameCaptureStats GetStats() const;
+	private:
+		enum class SlotState
+		{
+			Free,
+			Copying,
+			Encoding
+		};
+
+		struct Slot
+		{
+			Buffer Readback;
+			std::atomic<SlotState> State = SlotState::Free;
+			uint64_t Frame = 0;
+			VkExtent2D Extent = { 0, 0 };
+			bool SwapRedBlue = false;
+		};
+
+		void Encode(Slot& slot);
+	private:
+		VkDevice device;
+		VkPhysicalDevice physicalDevice;
+		FrameCaptureSpecification specification;
+
+		std::vector<std::unique_ptr<Slot>> slots;
+		uint32_t nextSlot = 0;
+		std::unique_ptr<ThreadPool> encoders;
+
+		std::mutex rawStreamMutex;
+		std::ofstream rawStream;
+
+		std::atomic<uint64_t> framesWritten = 0;
+		std::atomic<uint64_t> bytesWritten = 0;
+		uint64_t framesDropped = 0;
+		std::chrono::steady_clock::time_point startTime;
+	};
+
+}
@@ -0,0 +1,180 @@
+#include <vkpch.h>
+
+#include "GraphicsPipeline.h"
+
+#include <iostream>
+
+namespace LearningVK
+{
+
+	static VkShaderModule CreateShaderModule(VkDevice device, const std::vector<uint32_t>& code)
+	{
+		VkShaderModuleCreateInfo moduleInfo{};
+		moduleInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+		moduleInfo.codeSize = code.size() * sizeof(uint32_t);
+		moduleInfo.pCode = code.data();
+
+		VkShaderModule shaderModule = VK_NULL_HANDLE;
+		if (vkCreateShaderModule(device, &moduleInfo, nullptr, &shaderModule) != VK_SUCCESS)
+			std::cout << "Error: Couldn't create shader module!" << std::endl;
+		return shaderModule;
+	}
+
+	bool CreateGraphicsPipeline(VkDevice device, const GraphicsPipelineSpecification& specification, GraphicsPipeline& pipeline)
+	{
+		if (!specification.Bindings.empty())
+		{
+			VkDescriptorSetLayoutCreateInfo setLayoutInfo{};
+			setLayoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+			setLayoutInfo.bindingCount = uint32_t(specification.Bindings.size());
+			setLayoutInfo.pBindings = specification.Bindings.data();
+
+			if (vkCreateDescriptorSetLayout(device, &setLayoutInfo, nullptr, &pipeline.SetLayout) != VK_SUCCESS)
+			{
+				std::cout << "Error: Couldn't create graphics descriptor set layout!" << std::endl;
+				return false;
+			}
+		}
+
+		VkPushConstantRange pushConstantRange{};
+		pushConstantRange.stageFlags = specification.PushConstantStages;
+		pushConstantRange.offset = 0;
+		pushConstantRange.size = specification.PushConstantSize;
+
+		VkPipelineLayoutCreateInfo layoutInfo{};
+		layoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		layoutInfo.setLayoutCount = pipeline.SetLayout ? 1 : 0;
+		layoutInfo.pSetLayouts = &pipeline.SetLayout;
+		layoutInfo.pushConstantRangeCount = specification.PushConstantSize > 0 ? 1 : 0;
+		layoutInfo.pPushConstantRanges = &pushConstantRange;
+
+		if (vkCreatePipelineLayout(device, &layoutInfo, nullptr, &pipeline.Layout) != VK_SUCCESS)
+		{
+			std::cout << "Error: Couldn't create graphics pipeline layout!" << std::endl;
+			DestroyGraphicsPipeline(device, pipeline);
+			return false;
+		}
+
+		bool depthOnly = specification.FragmentCode == nullptr;
+
+		std::vector<VkPipelineShaderStageCreateInfo> shaderStages;
+		VkPipelineShaderStageCreateInfo& vertexStage = shaderStages.emplace_back();
+		vertexStage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		vertexStage.stage = VK_SHADER_STAGE_VERTEX_BIT;
+		vertexStage.module = CreateShaderModule(device, *specification.VertexCode);
+		vertexStage.pName = "main";
+
+		if (!depthOnly)
+		{
+			VkPipelineShaderStageCreateInfo& fragmentStage = shaderStages.emplace_back();
+			fragmentStage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+			fragmentStage.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+			fragmentStage.module = CreateShaderModule(device, *specification.FragmentCode);
+			fragmentStage.pName = "main";
+			fragmentStage.pSpecializationInfo = specification.FragmentSpecialization;
+		}
+
+		VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
+		vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+		vertexInputInfo.vertexBindingDescriptionCount = uint32_t(specification.VertexBindings.size());
+		vertexInputInfo.pVertexBindingDescriptions = specification.VertexBindings.data();
+		vertexInputInfo.vertexAttributeDescriptionCount = uint32_t(specification.VertexAttributes.size());
+		vertexInputInfo.pVertexAttributeDescriptions = specification.VertexAttributes.data();
+
+		VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
+		inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+		inputAssembly.topology = specification.Topology;
+
+		VkPipelineViewportStateCreateInfo viewportState{};
+		viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+		viewportState.viewportCount = 1;
+		viewportState.scissorCount = 1;
+
+		VkPipelineRasterizationStateCreateInfo rasterizer{};
+		rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+		rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
+		rasterizer.lineWidth = 1.0f;
+		rasterizer.cullMode = specification.CullMode;
+		rasterizer.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+
+		VkPipelineMultisampleStateCreateInfo multisampling{};
+		multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+		multisampling.rasterizationSamples = specification.Samples;
+
+		VkPipelineDepthStencilStateCreateInfo depthStencil{};
+		depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+		depthStencil.depthTestEnable = specification.DepthTest;
+		depthStencil.depthWriteEnable = specification.DepthWrite;
+		depthStencil.depthCompareOp = specification.DepthCompareOp;
+
+		VkPipelineColorBlendAttachmentState colorBlendAttachment{};
+		colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+		colorBlendAttachment.blendEnable = specification.AlphaBlending;
+		colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+		colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+		colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
+		colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+		colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+		colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
+
+		VkPipelineColorBlendStateCreateInfo colorBlending{};
+		colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+		colorBlending.attachmentCount = depthOnly ? 0 : 1;
+		colorBlending.pAttachments = &colorBlendAttachment;
+
+		std::array<VkDynamicState, 2> dynamicStates = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+		VkPipelineDynamicStateCreateInfo dynamicState{};
+		dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+		dynamicState.dynamicStateCount = uint32_t(dynamicStates.size());
+		dynamicState.pDynamicStates = dynamicStates.data();
+
+		VkGraphicsPipelineCreateInfo pipelineInfo{};
+		pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+		pipelineInfo.stageCount = uint32_t(shaderStages.size());
+		pipelineInfo.pStages = shaderStages.data();
+		pipelineInfo.pVertexInputState = &vertexInputInfo;
+		pipelineInfo.pInputAssemblyState = &inputAssembly;
+		pipelineInfo.pViewportState = &viewportState;
+		pipelineInfo.pRasterizationState = &rasterizer;
+		pipelineInfo.pMultisampleState = &multisampling;
+		pipelineInfo.pDepthStencilState = &depthStencil;
+		pipelineInfo.pColorBlendState = &colorBlending;
+		pipelineInfo.pDynamicState = &dynamicState;
+		pipelineInfo.layout = pipeline.Layout;
+		pipelineInfo.renderPass = specification.RenderPass;
+		pipelineInfo.subpass = 0;
+
+		bool modulesCreated = true;
+		for (const VkPipelineShaderStageCreateInfo& stage : shaderStages)
+			modulesCreated &= stage.module != VK_NULL_HANDLE;
+
+		VkResult result = VK_ERROR_INITIALIZATION_FAILED;
+		if (modulesCreated)
+			result = vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline.Pipeline);
+
+		for (const VkPipelineShaderStageCreateInfo& stage : shaderStages)
+			vkDestroyShaderModule(device, stage.module, nullptr);
+
+		if (result != VK_SUCCESS)
+		{
+			std::cout << "Error: Couldn't create graphics pipeline!" << std::endl;
+			DestroyGraphicsPipeline(device, pipeline);
+			return false;
+		}
+
+		return true;
+	}
+
+	void DestroyGraphicsPipeline(VkDevice device, GraphicsPipeline& pipeline)
+	{
+		if (pipeline.Pipeline)
+			vkDestroyPipeline(device, pipeline.Pipeline, nullptr);
+		if (pipeline.Layout)
+			vkDestroyPipelineLayout(device, pipeline.Layout, nullptr);
+		if (pipeline.SetLayout)
+			vkDestroyDescriptorSetLayout(device, pipeline.SetLayout, nullptr);
+
+		pipeline = {};
+	}
+
+}
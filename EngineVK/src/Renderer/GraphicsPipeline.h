@@ -0,0 +1,50 @@
+#pragma once
+
+#include "Renderer/Descriptors.h"
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace LearningVK {
+
+	// Viewport and scissor are always dynamic
+	struct GraphicsPipelineSpecification
+	{
+		const std::vector<uint32_t>* VertexCode = nullptr;
+		// Without a fragment shader the pipeline is depth only and the subpass must have no color attachments
+		const std::vector<uint32_t>* FragmentCode = nullptr;
+		const VkSpecializationInfo* FragmentSpecialization = nullptr;
+
+		std::vector<VkVertexInputBindingDescription> VertexBindings;
+		std::vector<VkVertexInputAttributeDescription> VertexAttributes;
+		VkPrimitiveTopology Topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+		VkCullModeFlags CullMode = VK_CULL_MODE_NONE;
+
+		bool DepthTest = true;
+		bool DepthWrite = true;
+		VkCompareOp DepthCompareOp = VK_COMPARE_OP_LESS;
+		bool AlphaBlending = false;
+
+		std::vector<VkDescriptorSetLayoutBinding> Bindings;
+		uint32_t PushConstantSize = 0;
+		VkShaderStageFlags PushConstantStages = VK_SHADER_STAGE_VERTEX_BIT;
+
+		VkRenderPass RenderPass = VK_NULL_HANDLE;
+		VkSampleCountFlagBits Samples = VK_SAMPLE_COUNT_1_BIT;
+	};
+
+	// Like compute pipelines, graphics pipelines use a single descriptor set laid out by the specification's
+	// bindings. SetLayout stays null when there are none.
+	struct GraphicsPipeline
+	{
+		VkPipeline Pipeline = VK_NULL_HANDLE;
+		VkPipelineLayout Layout = VK_NULL_HANDLE;
+		VkDescriptorSetLayout SetLayout = VK_NULL_HANDLE;
+	};
+
+	bool CreateGraphicsPipeline(VkDevice device, const GraphicsPipelineSpecification& specification, GraphicsPipeline& pipeline);
+	void DestroyGraphicsPipeline(VkDevice device, GraphicsPipeline& pipeline);
+
+}
@@ -0,0 +1,53 @@
+#include <vkpch.h>
+
+#include "Memory.h"
+#include "MemoryTracker.h"
+
+namespace LearningVK
+{
+
+	uint32_t FindMemoryType(VkPhysicalDevice physicalDevice, uint32_t typeFilter, VkMemoryPropertyFlags properties)
+	{
+		VkPhysicalDeviceMemoryProperties memoryProperties;
+		vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memoryProperties);
+
+		for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; i++)
+		{
+			if ((typeFilter & (1 << i)) && (memoryProperties.memoryTypes[i].propertyFlags & properties) == properties)
+				return i;
+		}
+
+		return InvalidMemoryType;
+	}
+
+	const char* GetMemoryCategoryName(MemoryCategory category)
+	{
+		switch (category)
+		{
+		case MemoryCategory_Buffer: return "Buffer";
+		case MemoryCategory_Image: return "Image";
+		case MemoryCategory_Staging: return "Staging";
+		case MemoryCategory_Transient: return "Transient";
+		default: return "Unknown";
+		}
+	}
+
+	VkResult AllocateMemory(VkDevice device, const VkMemoryAllocateInfo& allocateInfo, MemoryCategory category, VkDeviceSize requestedSize, VkDeviceMemory& memory)
+	{
+		VkResult result = vkAllocateMemory(device, &allocateInfo, nullptr, &memory);
+		if (result == VK_SUCCESS)
+			GetMemoryTracker().RecordAllocation(memory, allocateInfo.allocationSize, requestedSize, allocateInfo.memoryTypeIndex, category);
+
+		return result;
+	}
+
+	void FreeMemory(VkDevice device, VkDeviceMemory memory)
+	{
+		if (!memory)
+			return;
+
+		GetMemoryTracker().RecordFree(memory);
+		vkFreeMemory(device, memory, nullptr);
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+
+namespace LearningVK {
+
+	constexpr uint32_t InvalidMemoryType = UINT32_MAX;
+
+	// Returns the first memory type allowed by typeFilter that has all of the requested properties,
+	// or InvalidMemoryType when there's none.
+	uint32_t FindMemoryType(VkPhysicalDevice physicalDevice, uint32_t typeFilter, VkMemoryPropertyFlags properties);
+
+	// What an allocation holds, for the memory tracker's statistics
+	enum MemoryCategory : uint32_t
+	{
+		MemoryCategory_Buffer = 0,
+		MemoryCategory_Image = 1,
+		// Host visible buffers that only copy to or from the device
+		MemoryCategory_Staging = 2,
+		// Attachments that only live within a render pass
+		MemoryCategory_Transient = 3,
+		MemoryCategory_Count
+	};
+
+	const char* GetMemoryCategoryName(MemoryCategory category);
+
+	// vkAllocateMemory that records the allocation in the memory tracker. requestedSize is how much of it the
+	// resource actually needs, the rest is counted as padding.
+	VkResult AllocateMemory(VkDevice device, const VkMemoryAllocateInfo& allocateInfo, MemoryCategory category, VkDeviceSize requestedSize, VkDeviceMemory& memory);
+	void FreeMemory(VkDevice device, VkDeviceMemory memory);
+
+}
\ No newline at end of file
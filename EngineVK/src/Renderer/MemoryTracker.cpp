@@ -0,0 +1,255 @@
+#include <vkpch.h>
+
+#include "MemoryTracker.h"
+
+#include <iostream>
+
+namespace LearningVK
+{
+
+	// Without VK_EXT_memory_budget the whole heap can't be counted on, other processes and the driver use it too
+	static constexpr double FallbackBudgetFraction = 0.8;
+	// How far below the warning threshold usage has to drop before the callbacks can fire again
+	static constexpr float WarningHysteresis = 0.05f;
+
+	MemoryTracker& GetMemoryTracker()
+	{
+		static MemoryTracker tracker;
+		return tracker;
+	}
+
+	void MemoryTracker::Init(VkPhysicalDevice physicalDevice, bool budgetExtension, float warningThreshold)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		this->physicalDevice = physicalDevice;
+		this->budgetExtension = budgetExtension;
+		this->warningThreshold = warningThreshold;
+
+		vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memoryProperties);
+
+		VkPhysicalDeviceProperties properties;
+		vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+		maxAllocationCount = properties.limits.maxMemoryAllocationCount;
+
+		heaps.assign(memoryProperties.memoryHeapCount, HeapState{});
+	}
+
+	void MemoryTracker::RecordAllocation(VkDeviceMemory memory, VkDeviceSize size, VkDeviceSize requestedSize, uint32_t memoryType, MemoryCategory category)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (heaps.empty())
+			return;
+
+		uint32_t heap = memoryProperties.memoryTypes[memoryType].heapIndex;
+		allocations[memory] = { size, std::min(requestedSize, size), heap, category };
+
+		HeapState& state = heaps[heap];
+		state.Tracked += size;
+		state.CategoryBytes[category] += size;
+		state.Peak = std::max(state.Peak, state.Tracked);
+
+		categoryBytes[category] += size;
+		categoryPeaks[category] = std::max(categoryPeaks[category], categoryBytes[category]);
+	}
+
+	void MemoryTracker::RecordFree(VkDeviceMemory memory)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		auto it = allocations.find(memory);
+		if (it == allocations.end())
+			return;
+
+		const Allocation& allocation = it->second;
+		HeapState& state = heaps[allocation.Heap];
+		state.Tracked -= allocation.Size;
+		state.CategoryBytes[allocation.Category] -= allocation.Size;
+		categoryBytes[allocation.Category] -= allocation.Size;
+
+		allocations.erase(it);
+	}
+
+	void MemoryTracker::Update()
+	{
+		std::vector<uint32_t> crossedHeaps;
+		std::vector<BudgetCallback> budgetCallbacks;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (heaps.empty())
+				return;
+
+			VkPhysicalDeviceMemoryBudgetPropertiesEXT budgetProperties{};
+			budgetProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+
+			if (budgetExtension)
+			{
+				VkPhysicalDeviceMemoryProperties2 properties{};
+				properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+				properties.pNext = &budgetProperties;
+				vkGetPhysicalDeviceMemoryProperties2(physicalDevice, &properties);
+			}
+
+			for (uint32_t i = 0; i < uint32_t(heaps.size()); i++)
+			{
+				HeapState& state = heaps[i];
+				if (budgetExtension)
+				{
+					state.Budget = budgetProperties.heapBudget[i];
+					state.Usage = budgetProperties.heapUsage[i];
+				}
+				else
+				{
+					state.Budget = VkDeviceSize(double(memoryProperties.memoryHeaps[i].size) * FallbackBudgetFraction);
+					state.Usage = state.Tracked;
+				}
+
+				float fraction = state.Budget > 0 ? float(double(state.Usage) / double(state.Budget)) : 0.0f;
+				if (!state.NearBudget && fraction >= warningThreshold)
+				{
+					state.NearBudget = true;
+					crossedHeaps.push_back(i);
+				}
+				else if (state.NearBudget && fraction < warningThreshold - WarningHysteresis)
+				{
+					state.NearBudget = false;
+				}
+			}
+
+			if (crossedHeaps.empty())
+				return;
+
+			for (const auto& [id, callback] : callbacks)
+				budgetCallbacks.push_back(callback);
+		}
+
+		// Outside of the lock, so callbacks can free memory right away
+		MemoryStats stats = GetStats();
+		for (uint32_t heap : crossedHeaps)
+		{
+			for (const BudgetCallback& callback : budgetCallbacks)
+				callback(stats.Heaps[heap]);
+		}
+	}
+
+	uint32_t MemoryTracker::AddBudgetCallback(BudgetCallback&& callback)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		uint32_t id = nextCallbackId++;
+		callbacks.emplace_back(id, std::move(callback));
+		return id;
+	}
+
+	void MemoryTracker::RemoveBudgetCallback(uint32_t id)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		callbacks.erase(std::remove_if(callbacks.begin(), callbacks.end(),
+			[id](const auto& entry) { return entry.first == id; }), callbacks.end());
+	}
+
+	MemoryStats MemoryTracker::GetStats() const
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		MemoryStats stats;
+		stats.CategoryBytes = categoryBytes;
+		stats.CategoryPeaks = categoryPeaks;
+		stats.AllocationCount = uint32_t(allocations.size());
+		stats.MaxAllocationCount = maxAllocationCount;
+		stats.BudgetExtension = budgetExtension;
+
+		stats.Heaps.resize(heaps.size());
+		for (uint32_t i = 0; i < uint32_t(heaps.size()); i++)
+		{
+			MemoryHeapStats& heap = stats.Heaps[i];
+			heap.HeapIndex = i;
+			heap.Size = memoryProperties.memoryHeaps[i].size;
+			heap.DeviceLocal = memoryProperties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT;
+			heap.Budget = heaps[i].Budget;
+			heap.Usage = heaps[i].Usage;
+			heap.Tracked = heaps[i].Tracked;
+			heap.Peak = heaps[i].Peak;
+			heap.CategoryBytes = heaps[i].CategoryBytes;
+		}
+
+		for (const auto& [memory, allocation] : allocations)
+		{
+			MemoryHeapStats& heap = stats.Heaps[allocation.Heap];
+			heap.SmallestAllocation = heap.AllocationCount == 0 ? allocation.Size : std::min(heap.SmallestAllocation, allocation.Size);
+			heap.LargestAllocation = std::max(heap.LargestAllocation, allocation.Size);
+			heap.PaddingBytes += allocation.Size - allocation.RequestedSize;
+			heap.AllocationCount++;
+		}
+
+		return stats;
+	}
+
+	static void WriteCategories(std::ostringstream& json, const std::array<VkDeviceSize, MemoryCategory_Count>& bytes)
+	{
+		json << "{ ";
+		for (uint32_t category = 0; category < MemoryCategory_Count; category++)
+		{
+			json << (category > 0 ? ", " : "") << "\"" << GetMemoryCategoryName(MemoryCategory(category)) << "\": " << bytes[category];
+		}
+		json << " }";
+	}
+
+	std::string MemoryTracker::ToJSON() const
+	{
+		MemoryStats stats = GetStats();
+
+		std::ostringstream json;
+		json << "{\n";
+		json << "\t\"budgetExtension\": " << (stats.BudgetExtension ? "true" : "false") << ",\n";
+		json << "\t\"allocationCount\": " << stats.AllocationCount << ",\n";
+		json << "\t\"maxAllocationCount\": " << stats.MaxAllocationCount << ",\n";
+		json << "\t\"categories\": ";
+		WriteCategories(json, stats.CategoryBytes);
+		json << ",\n";
+		json << "\t\"categoryPeaks\": ";
+		WriteCategories(json, stats.CategoryPeaks);
+		json << ",\n";
+		json << "\t\"heaps\": [\n";
+
+		for (size_t i = 0; i < stats.Heaps.size(); i++)
+		{
+			const MemoryHeapStats& heap = stats.Heaps[i];
+			json << "\t\t{\n";
+			json << "\t\t\t\"index\": " << heap.HeapIndex << ",\n";
+			json << "\t\t\t\"deviceLocal\": " << (heap.DeviceLocal ? "true" : "false") << ",\n";
+			json << "\t\t\t\"size\": " << heap.Size << ",\n";
+			json << "\t\t\t\"budget\": " << heap.Budget << ",\n";
+			json << "\t\t\t\"usage\": " << heap.Usage << ",\n";
+			json << "\t\t\t\"tracked\": " << heap.Tracked << ",\n";
+			json << "\t\t\t\"peak\": " << heap.Peak << ",\n";
+			json << "\t\t\t\"categories\": ";
+			WriteCategories(json, heap.CategoryBytes);
+			json << ",\n";
+			json << "\t\t\t\"allocationCount\": " << heap.AllocationCount << ",\n";
+			json << "\t\t\t\"smallestAllocation\": " << heap.SmallestAllocation << ",\n";
+			json << "\t\t\t\"largestAllocation\": " << heap.LargestAllocation << ",\n";
+			json << "\t\t\t\"paddingBytes\": " << heap.PaddingBytes << "\n";
+			json << "\t\t}" << (i + 1 < stats.Heaps.size() ? "," : "") << "\n";
+		}
+
+		json << "\t]\n";
+		json << "}\n";
+		return json.str();
+	}
+
+	bool MemoryTracker::WriteJSON(const std::string& path) const
+	{
+		std::ofstream file(path, std::ios::trunc);
+		if (!file.is_open())
+		{
+			std::cout << "Error: Couldn't open " << path << " for the memory statistics!" << std::endl;
+			return false;
+		}
+
+		file << ToJSON();
+		return file.good();
+	}
+
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include "Renderer/Memory.h"
+
+#include <vulkan/vulkan.h>
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace LearningVK {
+
+	struct MemoryHeapStats
+	{
+		uint32_t HeapIndex = 0;
+		VkDeviceSize Size = 0;
+		bool DeviceLocal = false;
+
+		// From VK_EXT_memory_budget when it's enabled, otherwise a fixed share of the heap's size
+		VkDeviceSize Budget = 0;
+		// The whole process's usage as the driver sees it with VK_EXT_memory_budget, otherwise only the tracked allocations
+		VkDeviceSize Usage = 0;
+
+		VkDeviceSize Tracked = 0;
+		VkDeviceSize Peak = 0;
+		std::array<VkDeviceSize, MemoryCategory_Count> CategoryBytes{};
+
+		// Every resource has its own allocation, so there are no holes to fragment. What's left to watch is how many
+		// allocations there are, how large they are and how much memory alignment wastes.
+		uint32_t AllocationCount = 0;
+		VkDeviceSize SmallestAllocation = 0;
+		VkDeviceSize LargestAllocation = 0;
+		// Allocated beyond what the resources asked for
+		VkDeviceSize PaddingBytes = 0;
+
+		float GetBudgetFraction() const { return Budget > 0 ? float(double(Usage) / double(Budget)) : 0.0f; }
+	};
+
+	struct MemoryStats
+	{
+		std::vector<MemoryHeapStats> Heaps;
+		std::array<VkDeviceSize, MemoryCategory_Count> CategoryBytes{};
+		std::array<VkDeviceSize, MemoryCategory_Count> CategoryPeaks{};
+		uint32_t AllocationCount = 0;
+		// vkAllocateMemory fails past this many live allocations
+		uint32_t MaxAllocationCount = 0;
+		bool BudgetExtension = false;
+	};
+
+	// Records every device memory allocation made through AllocateMemory and compares the heaps' usage with their
+	// budget. Allocations may be recorded from any thread.
+	class MemoryTracker
+	{
+	public:
+		// Called with the heap's stats when its usage reaches the warning threshold of its budget, so streaming can
+		// back off before the driver starts paging. It fires again once usage has dropped clearly below it.
+		using BudgetCallback = std::function<void(const MemoryHeapStats&)>;
+
+		// Call right after creating the device, before anything is allocated. budgetExtension is whether
+		// VK_EXT_memory_budget was enabled.
+		void Init(VkPhysicalDevice physicalDevice, bool budgetExtension, float warningThreshold = 0.9f);
+
+		void RecordAllocation(VkDeviceMemory memory, VkDeviceSize size, VkDeviceSize requestedSize, uint32_t memoryType, MemoryCategory category);
+		void RecordFree(VkDeviceMemory memory);
+
+		// Queries the budget and fires the callbacks of heaps that crossed the threshold, call it once a frame
+		void Update();
+
+		uint32_t AddBudgetCallback(BudgetCallback&& callback);
+		void RemoveBudgetCallback(uint32_t id);
+
+		MemoryStats GetStats() const;
+
+		std::string ToJSON() const;
+		bool WriteJSON(const std::string& path) const;
+	private:
+		struct Allocation
+		{
+			VkDeviceSize Size;
+			VkDeviceSize RequestedSize;
+			uint32_t Heap;
+			MemoryCategory Category;
+		};
+
+		struct HeapState
+		{
+			VkDeviceSize Tracked = 0;
+			VkDeviceSize Peak = 0;
+			std::array<VkDeviceSize, MemoryCategory_Count> CategoryBytes{};
+			VkDeviceSize Budget = 0;
+			VkDeviceSize Usage = 0;
+			bool NearBudget = false;
+		};
+	private:
+		VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
+		VkPhysicalDeviceMemoryProperties memoryProperties{};
+		uint32_t maxAllocationCount = 0;
+		bool budgetExtension = false;
+		float warningThreshold = 0.9f;
+
+		mutable std::mutex mutex;
+		std::unordered_map<VkDeviceMemory, Allocation> allocations;
+		std::vector<HeapState> heaps;
+		std::array<VkDeviceSize, MemoryCategory_Count> categoryBytes{};
+		std::array<VkDeviceSize, MemoryCategory_Count> categoryPeaks{};
+
+		std::vector<std::pair<uint32_t, BudgetCallback>> callbacks;
+		uint32_t nextCallbackId = 1;
+	};
+
+	// The tracker AllocateMemory and FreeMemory record into
+	MemoryTracker& GetMemoryTracker();
+
+}
@@ -0,0 +1,129 @@
+#include <vkpch.h>
+
+#include "ShaderLibrary.h"
+
+#include <bitset>
+#include <cstring>
+#include <iostream>
+
+namespace LearningVK
+{
+
+	static bool ReadU32(const std::vector<char>& data, size_t& offset, uint32_t& value)
+	{
+		if (offset + sizeof(uint32_t) > data.size())
+			return false;
+
+		std::memcpy(&value, data.data() + offset, sizeof(uint32_t));
+		offset += sizeof(uint32_t);
+		return true;
+	}
+
+	bool ShaderLibrary::Load(const std::string& path)
+	{
+		std::ifstream file(path, std::ios::ate | std::ios::binary);
+		if (!file.is_open())
+		{
+			std::cout << "Error: Couldn't open shader archive " << path << "!" << std::endl;
+			return false;
+		}
+
+		std::vector<char> data(size_t(file.tellg()));
+		file.seekg(0);
+		file.read(data.data(), data.size());
+		file.close();
+
+		if (data.size() < 12 || std::memcmp(data.data(), "LVKS", 4) != 0)
+		{
+			std::cout << "Error: " << path << " isn't a shader archive!" << std::endl;
+			return false;
+		}
+
+		size_t offset = 4;
+		uint32_t version, variantCount;
+		ReadU32(data, offset, version);
+		ReadU32(data, offset, variantCount);
+		if (version != 1)
+		{
+			std::cout << "Error: Unsupported shader archive version " << version << "!" << std::endl;
+			return false;
+		}
+
+		// Parsed into a separate map so a failed reload keeps the shaders that are already loaded
+		std::unordered_map<std::string, std::vector<ShaderVariant>> loadedVariants;
+		for (uint32_t i = 0; i < variantCount; i++)
+		{
+			uint32_t nameLength, features, codeSize;
+			if (!ReadU32(data, offset, nameLength) || offset + nameLength > data.size())
+				break;
+
+			std::string name(data.data() + offset, nameLength);
+			offset += (nameLength + 3) & ~3u;
+
+			if (!ReadU32(data, offset, features) || !ReadU32(data, offset, codeSize) || offset + codeSize > data.size())
+				break;
+
+			// SPIR-V is made of 32 bit words, vkCreateShaderModule requires a multiple of 4 bytes
+			if (codeSize % sizeof(uint32_t) != 0)
+			{
+				std::cout << "Error: Shader " << name << " in " << path << " isn't whole SPIR-V words!" << std::endl;
+				return false;
+			}
+
+			ShaderVariant& variant = loadedVariants[name].emplace_back();
+			variant.Features = features;
+			variant.Code.resize(codeSize / sizeof(uint32_t));
+			std::memcpy(variant.Code.data(), data.data() + offset, codeSize);
+			offset += codeSize;
+		}
+
+		if (offset != data.size())
+		{
+			std::cout << "Error: Shader archive " << path << " is truncated!" << std::endl;
+			return false;
+		}
+
+		variants = std::move(loadedVariants);
+		return true;
+	}
+
+	const ShaderVariant* ShaderLibrary::Find(const std::string& name, uint32_t features) const
+	{
+		auto it = variants.find(name);
+		if (it == variants.end())
+			return nullptr;
+
+		for (const ShaderVariant& variant : it->second)
+		{
+			if (variant.Features == features)
+				return &variant;
+		}
+
+		return nullptr;
+	}
+
+	const ShaderVariant* ShaderLibrary::SelectVariant(const std::string& name, uint32_t requiredFeatures) const
+	{
+		auto it = variants.find(name);
+		if (it == variants.end())
+			return nullptr;
+
+		const ShaderVariant* best = nullptr;
+		size_t bestFeatureCount = SIZE_MAX;
+		for (const ShaderVariant& variant : it->second)
+		{
+			if ((variant.Features & requiredFeatures) != requiredFeatures)
+				continue;
+
+			size_t featureCount = std::bitset<32>(variant.Features).count();
+			if (featureCount < bestFeatureCount)
+			{
+				best = &variant;
+				bestFeatureCount = featureCount;
+			}
+		}
+
+		return best;
+	}
+
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+namespace LearningVK {
+
+	struct ShaderVariant
+	{
+		uint32_t Features = 0;
+		std::vector<uint32_t> Code;
+	};
+
+	// Holds every SPIR-V variant packed by "premake5 shaders", keyed by shader name and feature bitmask.
+	class ShaderLibrary
+	{
+	public:
+		bool Load(const std::string& path);
+
+		const ShaderVariant* Find(const std::string& name, uint32_t features) const;
+
+		// Returns the variant with the fewest features that still has all of the required ones,
+		// so a material never pays for code paths it doesn't use.
+		const ShaderVariant* SelectVariant(const std::string& name, uint32_t requiredFeatures) const;
+	private:
+		std::unordered_map<std::string, std::vector<ShaderVariant>> variants;
+	};
+
+}
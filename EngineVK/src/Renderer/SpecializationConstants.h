@@ -0,0 +1,51 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <type_traits>
+
+namespace LearningVK {
+
+	// Builds a VkSpecializationInfo so values such as light counts or loop bounds are baked into
+	// the pipeline and the driver can constant-fold them. Booleans must be passed as VkBool32.
+	class SpecializationConstants
+	{
+	public:
+		template<typename T>
+		SpecializationConstants& Set(uint32_t constantID, const T& value)
+		{
+			static_assert(std::is_trivially_copyable_v<T> && sizeof(T) <= 8, "Specialization constants must be scalars!");
+
+			VkSpecializationMapEntry entry{};
+			entry.constantID = constantID;
+			entry.offset = uint32_t(data.size());
+			entry.size = sizeof(T);
+			entries.push_back(entry);
+
+			data.resize(data.size() + sizeof(T));
+			std::memcpy(data.data() + entry.offset, &value, sizeof(T));
+			return *this;
+		}
+
+		// The returned pointer stays valid until this object is modified or destroyed
+		const VkSpecializationInfo* GetInfo()
+		{
+			if (entries.empty())
+				return nullptr;
+
+			info.mapEntryCount = uint32_t(entries.size());
+			info.pMapEntries = entries.data();
+			info.dataSize = data.size();
+			info.pData = data.data();
+			return &info;
+		}
+	private:
+		std::vector<VkSpecializationMapEntry> entries;
+		std::vector<uint8_t> data;
+		VkSpecializationInfo info{};
+	};
+
+}
@@ -0,0 +1,255 @@
+#include <vkpch.h>
+
+#include "SpriteBatch.h"
+#include "DeviceDispatch.h"
+#include "Upload.h"
+
+#include <iostream>
+
+namespace LearningVK
+{
+
+	static const uint32_t VerticesPerQuad = 4;
+	static const uint32_t IndicesPerQuad = 6;
+
+	SpriteBatch::SpriteBatch(const SpriteBatchSpecification& specification)
+		: specification(specification)
+	{
+		VkDevice device = specification.Device;
+
+		VkDeviceSize vertexBufferSize = VkDeviceSize(specification.FrameCount) * specification.MaxQuads * VerticesPerQuad * sizeof(SpriteVertex);
+		if (!CreateBuffer(device, specification.PhysicalDevice, vertexBufferSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, vertexBuffer))
+		{
+			std::cout << "Error: Couldn't create the sprite vertex buffer!" << std::endl;
+			return;
+		}
+
+		// Every quad is two triangles of the same four vertices, so the indices never change
+		std::vector<uint32_t> indices(size_t(specification.MaxQuads) * IndicesPerQuad);
+		for (uint32_t quad = 0; quad < specification.MaxQuads; quad++)
+		{
+			uint32_t vertex = quad * VerticesPerQuad;
+			uint32_t* index = &indices[size_t(quad) * IndicesPerQuad];
+			index[0] = vertex;
+			index[1] = vertex + 1;
+			index[2] = vertex + 2;
+			index[3] = vertex + 2;
+			index[4] = vertex + 3;
+			index[5] = vertex;
+		}
+
+		VkDeviceSize indexBufferSize = indices.size() * sizeof(uint32_t);
+		if (!CreateBuffer(device, specification.PhysicalDevice, indexBufferSize, VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0, indexBuffer)
+			|| !UploadBuffer(device, specification.PhysicalDevice, specification.UploadQueue, specification.UploadCommandPool,
+				indexBuffer, indices.data(), indexBufferSize))
+		{
+			std::cout << "Error: Couldn't create the sprite index buffer!" << std::endl;
+		}
+
+		quads.reserve(specification.MaxQuads);
+		sortKeys.reserve(specification.MaxQuads);
+	}
+
+	SpriteBatch::~SpriteBatch()
+	{
+		DestroyBuffer(specification.Device, vertexBuffer);
+		DestroyBuffer(specification.Device, indexBuffer);
+	}
+
+	SpriteBatch::MaterialId SpriteBatch::AddMaterial(const SpriteMaterial& material)
+	{
+		MaterialEntry entry;
+		entry.Material = material;
+		AssignOrdinals(entry);
+
+		materials.push_back(entry);
+		return MaterialId(materials.size() - 1);
+	}
+
+	void SpriteBatch::SetMaterial(MaterialId id, const SpriteMaterial& material)
+	{
+		materials[id].Material = material;
+		AssignOrdinals(materials[id]);
+	}
+
+	void SpriteBatch::AssignOrdinals(MaterialEntry& entry)
+	{
+		// Slots of handles no material uses anymore are reused, so recreating pipelines doesn't run out of them.
+		// Past MaxSortedStates quads are still drawn correctly, they're just sorted less well.
+		auto assign = [&](auto& sorted, auto handle, auto getHandle) {
+			for (uint32_t i = 0; i < uint32_t(sorted.size()); i++)
+			{
+				if (sorted[i] == handle)
+					return i;
+			}
+
+			for (uint32_t i = 0; i < uint32_t(sorted.size()); i++)
+			{
+				bool used = false;
+				for (const MaterialEntry& other : materials)
+					used |= &other != &entry && getHandle(other) == sorted[i];
+
+				if (!used)
+				{
+					sorted[i] = handle;
+					return i;
+				}
+			}
+
+			if (sorted.size() < MaxSortedStates)
+			{
+				sorted.push_back(handle);
+				return uint32_t(sorted.size() - 1);
+			}
+
+			return MaxSortedStates - 1;
+		};
+
+		entry.PipelineOrdinal = assign(sortedPipelines, entry.Material.Pipeline,
+			[](const MaterialEntry& other) { return other.Material.Pipeline; });
+		entry.TextureOrdinal = assign(sortedTextures, entry.Material.DescriptorSet,
+			[](const MaterialEntry& other) { return other.Material.DescriptorSet; });
+	}
+
+	void SpriteBatch::Begin(uint32_t frameSlot, VkExtent2D viewport)
+	{
+		this->frameSlot = frameSlot % specification.FrameCount;
+		this->viewport = viewport;
+
+		quads.clear();
+		sortKeys.clear();
+		runs.clear();
+		stats = {};
+	}
+
+	void SpriteBatch::DrawQuad(MaterialId material, glm::vec2 min, glm::vec2 max, glm::vec2 uvMin, glm::vec2 uvMax, uint32_t color, uint16_t layer)
+	{
+		if (quads.size() >= specification.MaxQuads)
+		{
+			stats.DroppedQuads++;
+			return;
+		}
+
+		const MaterialEntry& entry = materials[material];
+
+		// Ties keep the order the quads were added in
+		uint64_t key = uint64_t(layer) << 48
+			| uint64_t(entry.PipelineOrdinal) << 40
+			| uint64_t(entry.TextureOrdinal) << 32
+			| uint64_t(quads.size());
+
+		sortKeys.push_back(key);
+		quads.push_back({ min, max, uvMin, uvMax, color, material });
+	}
+
+	void SpriteBatch::End()
+	{
+		stats.Quads = uint32_t(quads.size());
+		if (quads.empty() || !vertexBuffer.Mapped)
+			return;
+
+		std::sort(sortKeys.begin(), sortKeys.end());
+
+		VkDeviceSize frameOffset = VkDeviceSize(frameSlot) * specification.MaxQuads * VerticesPerQuad;
+		SpriteVertex* vertices = static_cast<SpriteVertex*>(vertexBuffer.Mapped) + frameOffset;
+
+		glm::vec2 toNDC = glm::vec2(2.0f) / glm::vec2(float(viewport.width), float(viewport.height));
+
+		const SpriteMaterial* previous = nullptr;
+		for (uint32_t i = 0; i < uint32_t(sortKeys.size()); i++)
+		{
+			const Quad& quad = quads[uint32_t(sortKeys[i])];
+
+			glm::vec2 min = quad.Min * toNDC - 1.0f;
+			glm::vec2 max = quad.Max * toNDC - 1.0f;
+
+			SpriteVertex* vertex = &vertices[i * VerticesPerQuad];
+			vertex[0] = { { min.x, min.y }, { quad.UVMin.x, quad.UVMin.y }, quad.Color };
+			vertex[1] = { { max.x, min.y }, { quad.UVMax.x, quad.UVMin.y }, quad.Color };
+			vertex[2] = { { max.x, max.y }, { quad.UVMax.x, quad.UVMax.y }, quad.Color };
+			vertex[3] = { { min.x, max.y }, { quad.UVMin.x, quad.UVMax.y }, quad.Color };
+
+			// Materials with the same pipeline and texture share a draw
+			const SpriteMaterial& material = materials[quad.Material].Material;
+			if (previous && previous->Pipeline == material.Pipeline && previous->DescriptorSet == material.DescriptorSet)
+			{
+				runs.back().QuadCount++;
+				continue;
+			}
+
+			if (!previous || previous->Pipeline != material.Pipeline)
+				stats.PipelineBinds++;
+			if (material.DescriptorSet && (!previous || previous->DescriptorSet != material.DescriptorSet || previous->Layout != material.Layout))
+				stats.DescriptorBinds++;
+
+			runs.push_back({ quad.Material, i, 1 });
+			previous = &material;
+		}
+
+		stats.Draws = uint32_t(runs.size());
+
+		if (!vertexBuffer.Coherent)
+			FlushBuffer(specification.Device, vertexBuffer);
+	}
+
+	void SpriteBatch::Record(VkCommandBuffer commandBuffer) const
+	{
+		const DeviceDispatch& dispatch = GetDeviceDispatch();
+
+		if (runs.empty())
+			return;
+
+		VkViewport viewportState{};
+		viewportState.x = 0.0f;
+		viewportState.y = 0.0f;
+		viewportState.width = float(viewport.width);
+		viewportState.height = float(viewport.height);
+		viewportState.minDepth = 0.0f;
+		viewportState.maxDepth = 1.0f;
+		dispatch.CmdSetViewport(commandBuffer, 0, 1, &viewportState);
+
+		VkRect2D scissor{};
+		scissor.offset = { 0, 0 };
+		scissor.extent = viewport;
+		dispatch.CmdSetScissor(commandBuffer, 0, 1, &scissor);
+
+		VkDeviceSize vertexOffset = VkDeviceSize(frameSlot) * specification.MaxQuads * VerticesPerQuad * sizeof(SpriteVertex);
+		dispatch.CmdBindVertexBuffers(commandBuffer, 0, 1, &vertexBuffer.Handle, &vertexOffset);
+		dispatch.CmdBindIndexBuffer(commandBuffer, indexBuffer.Handle, 0, VK_INDEX_TYPE_UINT32);
+
+		const SpriteMaterial* previous = nullptr;
+		for (const Run& run : runs)
+		{
+			const SpriteMaterial& material = materials[run.Material].Material;
+
+			if (!previous || previous->Pipeline != material.Pipeline)
+				dispatch.CmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, material.Pipeline);
+			if (material.DescriptorSet && (!previous || previous->DescriptorSet != material.DescriptorSet || previous->Layout != material.Layout))
+				dispatch.CmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, material.Layout, 0, 1, &material.DescriptorSet, 0, nullptr);
+
+			dispatch.CmdDrawIndexed(commandBuffer, run.QuadCount * IndicesPerQuad, 1, run.FirstQuad * IndicesPerQuad, 0, 0);
+			previous = &material;
+		}
+	}
+
+	std::vector<VkVertexInputBindingDescription> SpriteBatch::GetVertexBindings()
+	{
+		VkVertexInputBindingDescription binding{};
+		binding.binding = 0;
+		binding.stride = sizeof(SpriteVertex);
+		binding.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+		return { binding };
+	}
+
+	std::vector<VkVertexInputAttributeDescription> SpriteBatch::GetVertexAttributes()
+	{
+		std::vector<VkVertexInputAttributeDescription> attributes(3);
+		attributes[0] = { 0, 0, VK_FORMAT_R32G32_SFLOAT, uint32_t(offsetof(SpriteVertex, Position)) };
+		attributes[1] = { 1, 0, VK_FORMAT_R32G32_SFLOAT, uint32_t(offsetof(SpriteVertex, UV)) };
+		attributes[2] = { 2, 0, VK_FORMAT_R8G8B8A8_UNORM, uint32_t(offsetof(SpriteVertex, Color)) };
+		return attributes;
+	}
+
+}
@@ -0,0 +1,144 @@
+#pragma once
+
+#include "Renderer/Buffer.h"
+
+#include <vulkan/vulkan.h>
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace LearningVK {
+
+	struct SpriteVertex
+	{
+		// Normalized device coordinates
+		glm::vec2 Position;
+		glm::vec2 UV;
+		// RGBA8, red in the lowest byte
+		uint32_t Color;
+	};
+
+	inline uint32_t PackSpriteColor(float r, float g, float b, float a = 1.0f)
+	{
+		auto channel = [](float value) { return uint32_t(glm::clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f); };
+		return channel(r) | (channel(g) << 8) | (channel(b) << 16) | (channel(a) << 24);
+	}
+
+	struct SpriteBatchSpecification
+	{
+		VkDevice Device = VK_NULL_HANDLE;
+		VkPhysicalDevice PhysicalDevice = VK_NULL_HANDLE;
+		// Used once to upload the index buffer
+		VkQueue UploadQueue = VK_NULL_HANDLE;
+		VkCommandPool UploadCommandPool = VK_NULL_HANDLE;
+
+		// Per frame, quads past it are dropped
+		uint32_t MaxQuads = 4096;
+		// Frames that can be in flight at once, each writes its own part of the vertex buffer
+		uint32_t FrameCount = 2;
+	};
+
+	// What a quad is drawn with. The pipeline takes SpriteVertex input through GetVertexBindings() and
+	// GetVertexAttributes(), the descriptor set holds its texture and can be null.
+	struct SpriteMaterial
+	{
+		VkPipeline Pipeline = VK_NULL_HANDLE;
+		VkPipelineLayout Layout = VK_NULL_HANDLE;
+		VkDescriptorSet DescriptorSet = VK_NULL_HANDLE;
+	};
+
+	struct SpriteBatchStats
+	{
+		uint32_t Quads = 0;
+		uint32_t Draws = 0;
+		uint32_t PipelineBinds = 0;
+		uint32_t DescriptorBinds = 0;
+		// Past MaxQuads
+		uint32_t DroppedQuads = 0;
+	};
+
+	// Batches textured 2D quads for overlays and UI. Quads are collected between Begin() and End(), which sorts them
+	// by layer, then pipeline, then texture and writes them into the frame's part of a persistently mapped vertex
+	// ring. Every run of quads with the same material becomes one indexed draw, and Record() only rebinds what
+	// changes between runs. Within a layer quads of different materials don't keep the order they were added in,
+	// only quads of the same material do, so use layers where overlap matters.
+	class SpriteBatch
+	{
+	public:
+		using MaterialId = uint32_t;
+
+		// Differently sorted pipelines and textures are limited to this many each
+		static const uint32_t MaxSortedStates = 256;
+
+		SpriteBatch(const SpriteBatchSpecification& specification);
+		// The GPU must be done with every frame
+		~SpriteBatch();
+
+		SpriteBatch(const SpriteBatch&) = delete;
+		SpriteBatch& operator=(const SpriteBatch&) = delete;
+
+		MaterialId AddMaterial(const SpriteMaterial& material);
+		// For when the material's pipeline or descriptor set is recreated
+		void SetMaterial(MaterialId id, const SpriteMaterial& material);
+
+		// Starts collecting the quads of a frame slot. Positions are in pixels of the viewport, from its top left.
+		void Begin(uint32_t frameSlot, VkExtent2D viewport);
+		void DrawQuad(MaterialId material, glm::vec2 min, glm::vec2 max, glm::vec2 uvMin, glm::vec2 uvMax, uint32_t color, uint16_t layer = 0);
+		// Sorts the quads and writes them into the vertex ring
+		void End();
+
+		// Draws what was written by the last End() inside a render pass, setting the viewport and scissor
+		// to the whole viewport
+		void Record(VkCommandBuffer commandBuffer) const;
+
+		const SpriteBatchStats& GetStats() const { return stats; }
+
+		static std::vector<VkVertexInputBindingDescription> GetVertexBindings();
+		static std::vector<VkVertexInputAttributeDescription> GetVertexAttributes();
+	private:
+		struct Quad
+		{
+			glm::vec2 Min;
+			glm::vec2 Max;
+			glm::vec2 UVMin;
+			glm::vec2 UVMax;
+			uint32_t Color;
+			MaterialId Material;
+		};
+
+		struct MaterialEntry
+		{
+			SpriteMaterial Material;
+			// Position among the distinct pipelines and descriptor sets, which is what quads are sorted by
+			uint32_t PipelineOrdinal;
+			uint32_t TextureOrdinal;
+		};
+
+		struct Run
+		{
+			MaterialId Material;
+			uint32_t FirstQuad;
+			uint32_t QuadCount;
+		};
+
+		void AssignOrdinals(MaterialEntry& entry);
+	private:
+		SpriteBatchSpecification specification;
+
+		Buffer vertexBuffer;
+		Buffer indexBuffer;
+
+		std::vector<MaterialEntry> materials;
+		std::vector<VkPipeline> sortedPipelines;
+		std::vector<VkDescriptorSet> sortedTextures;
+
+		uint32_t frameSlot = 0;
+		VkExtent2D viewport = { 0, 0 };
+		std::vector<Quad> quads;
+		std::vector<uint64_t> sortKeys;
+		std::vector<Run> runs;
+		SpriteBatchStats stats;
+	};
+
+}
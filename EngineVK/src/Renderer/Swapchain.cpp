@@ -0,0 +1,204 @@
+#include <vkpch.h>
+
+#include "Swapchain.h"
+#include "DeviceDispatch.h"
+
+#include <algorithm>
+#include <iostream>
+#include <limits>
+
+namespace LearningVK
+{
+
+	static void DestroyImageViews(VkDevice device, const std::vector<VkImageView>& imageViews)
+	{
+		for (VkImageView imageView : imageViews)
+			vkDestroyImageView(device, imageView, nullptr);
+	}
+
+	Swapchain::Swapchain(const SwapchainSpecification& specification, VkExtent2D extent)
+		: specification(specification)
+	{
+		Create(extent, VK_NULL_HANDLE);
+	}
+
+	Swapchain::~Swapchain()
+	{
+		DestroyImageViews(specification.Device, imageViews);
+		if (swapchain)
+			vkDestroySwapchainKHR(specification.Device, swapchain, nullptr);
+	}
+
+	bool Swapchain::Recreate(VkExtent2D extent, DeletionQueue& deletionQueue, uint64_t frameNumber)
+	{
+		VkDevice device = specification.Device;
+		VkSwapchainKHR oldSwapchain = swapchain;
+		std::vector<VkImageView> oldImageViews = std::move(imageViews);
+
+		bool created = Create(extent, oldSwapchain);
+
+		deletionQueue.Push(frameNumber, [=]() {
+			DestroyImageViews(device, oldImageViews);
+			if (oldSwapchain)
+				vkDestroySwapchainKHR(device, oldSwapchain, nullptr);
+		});
+
+		return created;
+	}
+
+	VkResult Swapchain::AcquireNextImage(VkSemaphore semaphore, uint32_t& imageIndex)
+	{
+		return GetDeviceDispatch().AcquireNextImageKHR(specification.Device, swapchain, UINT64_MAX, semaphore, VK_NULL_HANDLE, &imageIndex);
+	}
+
+	bool Swapchain::Create(VkExtent2D windowExtent, VkSwapchainKHR oldSwapchain)
+	{
+		VkDevice device = specification.Device;
+		VkPhysicalDevice physicalDevice = specification.PhysicalDevice;
+		VkSurfaceKHR surface = specification.Surface;
+
+		swapchain = VK_NULL_HANDLE;
+		supportsCapture = false;
+		images.clear();
+		imageViews.clear();
+
+		VkSurfaceCapabilitiesKHR capabilities;
+		vkGetPhysicalDeviceSurfaceCapabilitiesKHR(physicalDevice, surface, &capabilities);
+
+		uint32_t formatCount = 0;
+		vkGetPhysicalDeviceSurfaceFormatsKHR(physicalDevice, surface, &formatCount, nullptr);
+		std::vector<VkSurfaceFormatKHR> formats(formatCount);
+		vkGetPhysicalDeviceSurfaceFormatsKHR(physicalDevice, surface, &formatCount, formats.data());
+
+		uint32_t presentModeCount = 0;
+		vkGetPhysicalDeviceSurfacePresentModesKHR(physicalDevice, surface, &presentModeCount, nullptr);
+		std::vector<VkPresentModeKHR> presentModes(presentModeCount);
+		vkGetPhysicalDeviceSurfacePresentModesKHR(physicalDevice, surface, &presentModeCount, presentModes.data());
+
+		if (formats.empty())
+		{
+			std::cout << "Error: The surface has no formats to create a swapchain with!" << std::endl;
+			return false;
+		}
+
+		VkSurfaceFormatKHR surfaceFormat = formats[0];
+		for (const VkSurfaceFormatKHR& candidate : formats)
+		{
+			if (candidate.format == specification.PreferredFormat)
+			{
+				surfaceFormat = candidate;
+				break;
+			}
+		}
+
+		VkPresentModeKHR presentMode = VK_PRESENT_MODE_FIFO_KHR;
+		if (std::find(presentModes.begin(), presentModes.end(), specification.PreferredPresentMode) != presentModes.end())
+			presentMode = specification.PreferredPresentMode;
+
+		extent = capabilities.currentExtent;
+		if (capabilities.currentExtent.width == std::numeric_limits<uint32_t>::max())
+		{
+			extent.width = std::clamp(windowExtent.width, capabilities.minImageExtent.width, capabilities.maxImageExtent.width);
+			extent.height = std::clamp(windowExtent.height, capabilities.minImageExtent.height, capabilities.maxImageExtent.height);
+		}
+
+		uint32_t imageCount = capabilities.minImageCount + 1;
+		if (capabilities.maxImageCount > 0 && imageCount > capabilities.maxImageCount)
+			imageCount = capabilities.maxImageCount;
+
+		VkSwapchainCreateInfoKHR createInfo{};
+		createInfo.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
+		createInfo.surface = surface;
+		createInfo.minImageCount = imageCount;
+		createInfo.imageFormat = surfaceFormat.format;
+		createInfo.imageColorSpace = surfaceFormat.colorSpace;
+		createInfo.imageExtent = extent;
+		createInfo.imageArrayLayers = 1;
+		createInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+		if (capabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_SRC_BIT)
+			createInfo.imageUsage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+
+		uint32_t queueFamilyIndices[] = { specification.GraphicsFamily, specification.PresentFamily };
+		if (specification.GraphicsFamily != specification.PresentFamily)
+		{
+			createInfo.imageSharingMode = VK_SHARING_MODE_CONCURRENT;
+			createInfo.queueFamilyIndexCount = 2;
+			createInfo.pQueueFamilyIndices = queueFamilyIndices;
+		}
+		else
+		{
+			createInfo.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		}
+
+		createInfo.preTransform = capabilities.currentTransform;
+		createInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
+		createInfo.presentMode = presentMode;
+		createInfo.clipped = VK_TRUE;
+		createInfo.oldSwapchain = oldSwapchain;
+
+		if (vkCreateSwapchainKHR(device, &createInfo, nullptr, &swapchain) != VK_SUCCESS)
+		{
+			std::cout << "Error: Couldn't create swapchain!" << std::endl;
+			swapchain = VK_NULL_HANDLE;
+			return false;
+		}
+
+		vkGetSwapchainImagesKHR(device, swapchain, &imageCount, nullptr);
+		images.resize(imageCount);
+		vkGetSwapchainImagesKHR(device, swapchain, &imageCount, images.data());
+		format = surfaceFormat.format;
+		supportsCapture = (createInfo.imageUsage & VK_IMAGE_USAGE_TRANSFER_SRC_BIT) != 0;
+
+		imageViews.resize(images.size());
+		for (size_t i = 0; i < images.size(); i++)
+		{
+			VkImageViewCreateInfo viewInfo{};
+			viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+			viewInfo.image = images[i];
+			viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+			viewInfo.format = format;
+			viewInfo.components = { VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY };
+			viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+			viewInfo.subresourceRange.baseMipLevel = 0;
+			viewInfo.subresourceRange.levelCount = 1;
+			viewInfo.subresourceRange.baseArrayLayer = 0;
+			viewInfo.subresourceRange.layerCount = 1;
+
+			if (vkCreateImageView(device, &viewInfo, nullptr, &imageViews[i]) != VK_SUCCESS)
+			{
+				std::cout << "Error: Couldn't create image view number " << i << "!" << std::endl;
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	VkResult PresentSwapchains(VkQueue queue, const std::vector<VkSemaphore>& waitSemaphores, std::vector<SwapchainPresent>& presents)
+	{
+		std::vector<VkSwapchainKHR> swapchains(presents.size());
+		std::vector<uint32_t> imageIndices(presents.size());
+		std::vector<VkResult> results(presents.size(), VK_SUCCESS);
+		for (size_t i = 0; i < presents.size(); i++)
+		{
+			swapchains[i] = presents[i].Target->GetHandle();
+			imageIndices[i] = presents[i].ImageIndex;
+		}
+
+		VkPresentInfoKHR presentInfo{};
+		presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+		presentInfo.waitSemaphoreCount = uint32_t(waitSemaphores.size());
+		presentInfo.pWaitSemaphores = waitSemaphores.data();
+		presentInfo.swapchainCount = uint32_t(swapchains.size());
+		presentInfo.pSwapchains = swapchains.data();
+		presentInfo.pImageIndices = imageIndices.data();
+		presentInfo.pResults = results.data();
+
+		VkResult result = GetDeviceDispatch().QueuePresentKHR(queue, &presentInfo);
+		for (size_t i = 0; i < presents.size(); i++)
+			presents[i].Result = results[i];
+
+		return result;
+	}
+
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "Renderer/DeletionQueue.h"
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace LearningVK {
+
+	struct SwapchainSpecification
+	{
+		VkDevice Device = VK_NULL_HANDLE;
+		VkPhysicalDevice PhysicalDevice = VK_NULL_HANDLE;
+		VkSurfaceKHR Surface = VK_NULL_HANDLE;
+		// The images are shared concurrently when these differ
+		uint32_t GraphicsFamily = 0;
+		uint32_t PresentFamily = 0;
+
+		// Used when the surface supports it, otherwise its first format
+		VkFormat PreferredFormat = VK_FORMAT_B8G8R8A8_SRGB;
+		// Used when the surface supports it, otherwise FIFO which is always supported
+		VkPresentModeKHR PreferredPresentMode = VK_PRESENT_MODE_MAILBOX_KHR;
+	};
+
+	// A surface's swapchain with a view of every image. Swapchains of several surfaces can share a device and be
+	// presented together with PresentSwapchains().
+	class Swapchain
+	{
+	public:
+		// extent is the window's framebuffer size, only used when the surface doesn't decide its own
+		Swapchain(const SwapchainSpecification& specification, VkExtent2D extent);
+		// The GPU must be done with every image
+		~Swapchain();
+
+		Swapchain(const Swapchain&) = delete;
+		Swapchain& operator=(const Swapchain&) = delete;
+
+		// Builds a new swapchain from the current one so presentation carries on while it's replaced, the old
+		// swapchain and views are retired through the deletion queue. Returns false when it couldn't be created.
+		bool Recreate(VkExtent2D extent, DeletionQueue& deletionQueue, uint64_t frameNumber);
+
+		// Returns what vkAcquireNextImageKHR returned, semaphore is signalled once the image can be rendered to
+		VkResult AcquireNextImage(VkSemaphore semaphore, uint32_t& imageIndex);
+
+		bool IsValid() const { return swapchain != VK_NULL_HANDLE; }
+		VkSwapchainKHR GetHandle() const { return swapchain; }
+		VkFormat GetFormat() const { return format; }
+		VkExtent2D GetExtent() const { return extent; }
+		const std::vector<VkImage>& GetImages() const { return images; }
+		const std::vector<VkImageView>& GetImageViews() const { return imageViews; }
+		uint32_t GetImageCount() const { return uint32_t(images.size()); }
+		// Whether the images can be copied from, which FrameCapture needs and not every surface supports
+		bool SupportsCapture() const { return supportsCapture; }
+	private:
+		bool Create(VkExtent2D extent, VkSwapchainKHR oldSwapchain);
+	private:
+		SwapchainSpecification specification;
+
+		VkSwapchainKHR swapchain = VK_NULL_HANDLE;
+		VkFormat format = VK_FORMAT_UNDEFINED;
+		VkExtent2D extent = { 0, 0 };
+		bool supportsCapture = false;
+		std::vector<VkImage> images;
+		std::vector<VkImageView> imageViews;
+	};
+
+	struct SwapchainPresent
+	{
+		const Swapchain* Target = nullptr;
+		uint32_t ImageIndex = 0;
+		// Filled by PresentSwapchains, VK_ERROR_OUT_OF_DATE_KHR or VK_SUBOPTIMAL_KHR mean it should be recreated
+		VkResult Result = VK_SUCCESS;
+	};
+
+	// Queues every image for presentation with a single vkQueuePresentKHR once the semaphores are signalled, so
+	// windows rendered by the same frame are presented together. Every present gets its own result, the
+	// returned one is that of the whole call.
+	VkResult PresentSwapchains(VkQueue queue, const std::vector<VkSemaphore>& waitSemaphores, std::vector<SwapchainPresent>& presents);
+
+}
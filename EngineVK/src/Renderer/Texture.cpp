@@ -0,0 +1,87 @@
+#include <vkpch.h>
+
+#include "Texture.h"
+#include "Memory.h"
+
+#include <iostream>
+
+namespace LearningVK
+{
+
+	bool CreateTexture(VkDevice device, VkPhysicalDevice physicalDevice, const TextureSpecification& specification, Texture& texture)
+	{
+		VkImageCreateInfo imageInfo{};
+		imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+		imageInfo.imageType = VK_IMAGE_TYPE_2D;
+		imageInfo.format = specification.Format;
+		imageInfo.extent = { specification.Extent.width, specification.Extent.height, 1 };
+		imageInfo.mipLevels = specification.MipLevels;
+		imageInfo.arrayLayers = 1;
+		imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+		imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+		imageInfo.usage = specification.Usage;
+		imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+		if (vkCreateImage(device, &imageInfo, nullptr, &texture.Image) != VK_SUCCESS)
+		{
+			std::cout << "Error: Couldn't create texture image!" << std::endl;
+			return false;
+		}
+
+		VkMemoryRequirements memoryRequirements;
+		vkGetImageMemoryRequirements(device, texture.Image, &memoryRequirements);
+
+		VkMemoryAllocateInfo allocateInfo{};
+		allocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+		allocateInfo.allocationSize = memoryRequirements.size;
+		allocateInfo.memoryTypeIndex = FindMemoryType(physicalDevice, memoryRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+		if (allocateInfo.memoryTypeIndex == InvalidMemoryType
+			|| AllocateMemory(device, allocateInfo, MemoryCategory_Image, memoryRequirements.size, texture.Memory) != VK_SUCCESS)
+		{
+			std::cout << "Error: Couldn't allocate texture memory!" << std::endl;
+			DestroyTexture(device, texture);
+			return false;
+		}
+
+		vkBindImageMemory(device, texture.Image, texture.Memory, 0);
+
+		VkImageViewCreateInfo viewInfo{};
+		viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+		viewInfo.image = texture.Image;
+		viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+		viewInfo.format = specification.Format;
+		viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		viewInfo.subresourceRange.baseMipLevel = 0;
+		viewInfo.subresourceRange.levelCount = specification.MipLevels;
+		viewInfo.subresourceRange.baseArrayLayer = 0;
+		viewInfo.subresourceRange.layerCount = 1;
+
+		if (vkCreateImageView(device, &viewInfo, nullptr, &texture.View) != VK_SUCCESS)
+		{
+			std::cout << "Error: Couldn't create texture image view!" << std::endl;
+			DestroyTexture(device, texture);
+			return false;
+		}
+
+		texture.Extent = specification.Extent;
+		texture.Format = specification.Format;
+		texture.MipLevels = specification.MipLevels;
+		texture.Size = memoryRequirements.size;
+		return true;
+	}
+
+	void DestroyTexture(VkDevice device, Texture& texture)
+	{
+		if (texture.View)
+			vkDestroyImageView(device, texture.View, nullptr);
+		if (texture.Image)
+			vkDestroyImage(device, texture.Image, nullptr);
+		if (texture.Memory)
+			FreeMemory(device, texture.Memory);
+
+		texture = {};
+	}
+
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+
+namespace LearningVK {
+
+	struct TextureSpecification
+	{
+		VkExtent2D Extent = { 0, 0 };
+		VkFormat Format = VK_FORMAT_UNDEFINED;
+		uint32_t MipLevels = 1;
+		VkImageUsageFlags Usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+	};
+
+	// A sampled 2D image in device local memory. It's created in VK_IMAGE_LAYOUT_UNDEFINED, uploading a mip level
+	// moves that level to VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL.
+	struct Texture
+	{
+		VkImage Image = VK_NULL_HANDLE;
+		VkDeviceMemory Memory = VK_NULL_HANDLE;
+		VkImageView View = VK_NULL_HANDLE;
+		VkExtent2D Extent = { 0, 0 };
+		VkFormat Format = VK_FORMAT_UNDEFINED;
+		uint32_t MipLevels = 0;
+		VkDeviceSize Size = 0;
+	};
+
+	bool CreateTexture(VkDevice device, VkPhysicalDevice physicalDevice, const TextureSpecification& specification, Texture& texture);
+	void DestroyTexture(VkDevice device, Texture& texture);
+
+}
@@ -0,0 +1,389 @@
+#include <vkpch.h>
+
+#include "TextureFile.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace LearningVK
+{
+
+	static constexpr uint32_t TextureFileMagic = 0x544B564C; // "LVKT"
+	static constexpr uint32_t TextureFileVersion = 1;
+
+	struct TextureFileHeader
+	{
+		uint32_t Magic;
+		uint32_t Version;
+		uint32_t Format;
+		uint32_t Width;
+		uint32_t Height;
+		uint32_t MipLevels;
+		uint32_t Compression;
+		uint32_t Reserved;
+	};
+
+	// Followed by the mip table, one entry per level starting with the largest
+	struct TextureFileMipEntry
+	{
+		uint64_t Offset;
+		uint64_t StoredSize;
+		uint64_t Size;
+	};
+
+	// Every sequence is a token, its literals, then a match copying earlier output. The token's high nibble is the
+	// literal count and its low nibble the match length past the minimum, 15 means more length bytes follow. The
+	// last sequence only has literals.
+	static constexpr size_t MinMatch = 4;
+	static constexpr size_t MaxOffset = 65535;
+	static constexpr uint32_t HashBits = 16;
+
+	static void WriteLength(std::vector<uint8_t>& output, size_t length)
+	{
+		while (length >= 255)
+		{
+			output.push_back(255);
+			length -= 255;
+		}
+		output.push_back(uint8_t(length));
+	}
+
+	static std::vector<uint8_t> CompressLZ(const uint8_t* data, size_t size)
+	{
+		std::vector<uint8_t> output;
+		output.reserve(size / 2 + 16);
+
+		// Last position of every hashed 4 byte sequence, matches are only searched for there
+		std::vector<int64_t> table(size_t(1) << HashBits, -1);
+		size_t literalStart = 0;
+		size_t position = 0;
+
+		auto emit = [&](size_t matchLength, size_t offset) {
+			size_t literalLength = position - literalStart;
+			uint8_t token = uint8_t(std::min<size_t>(literalLength, 15) << 4);
+			if (matchLength > 0)
+				token |= uint8_t(std::min<size_t>(matchLength - MinMatch, 15));
+
+			output.push_back(token);
+			if (literalLength >= 15)
+				WriteLength(output, literalLength - 15);
+			output.insert(output.end(), data + literalStart, data + position);
+
+			if (matchLength > 0)
+			{
+				output.push_back(uint8_t(offset & 0xFF));
+				output.push_back(uint8_t(offset >> 8));
+				if (matchLength - MinMatch >= 15)
+					WriteLength(output, matchLength - MinMatch - 15);
+			}
+		};
+
+		while (position + MinMatch <= size)
+		{
+			uint32_t sequence;
+			std::memcpy(&sequence, data + position, sizeof(sequence));
+			uint32_t hash = (sequence * 2654435761u) >> (32 - HashBits);
+
+			int64_t candidate = table[hash];
+			table[hash] = int64_t(position);
+
+			if (candidate < 0 || position - size_t(candidate) > MaxOffset || std::memcmp(data + candidate, data + position, MinMatch) != 0)
+			{
+				position++;
+				continue;
+			}
+
+			size_t length = MinMatch;
+			while (position + length < size && data[size_t(candidate) + length] == data[position + length])
+				length++;
+
+			emit(length, position - size_t(candidate));
+			position += length;
+			literalStart = position;
+		}
+
+		position = size;
+		emit(0, 0);
+		return output;
+	}
+
+	static bool DecompressLZ(const uint8_t* input, size_t inputSize, uint8_t* output, size_t outputSize)
+	{
+		size_t in = 0;
+		size_t out = 0;
+
+		auto readLength = [&](size_t& length) {
+			uint8_t byte;
+			do
+			{
+				if (in >= inputSize)
+					return false;
+				byte = input[in++];
+				length += byte;
+			} while (byte == 255);
+			return true;
+		};
+
+		while (out < outputSize)
+		{
+			if (in >= inputSize)
+				return false;
+			uint8_t token = input[in++];
+
+			size_t literalLength = token >> 4;
+			if (literalLength == 15 && !readLength(literalLength))
+				return false;
+			if (literalLength > inputSize - in || literalLength > outputSize - out)
+				return false;
+
+			std::memcpy(output + out, input + in, literalLength);
+			in += literalLength;
+			out += literalLength;
+			if (out == outputSize)
+				break;
+
+			if (inputSize - in < 2)
+				return false;
+			size_t offset = size_t(input[in]) | (size_t(input[in + 1]) << 8);
+			in += 2;
+
+			size_t matchLength = token & 0x0F;
+			if (matchLength == 15 && !readLength(matchLength))
+				return false;
+			matchLength += MinMatch;
+
+			if (offset == 0 || offset > out || matchLength > outputSize - out)
+				return false;
+
+			// Byte by byte, a match may overlap the output it's writing
+			for (size_t i = 0; i < matchLength; i++)
+				output[out + i] = output[out + i - offset];
+			out += matchLength;
+		}
+
+		return true;
+	}
+
+	VkDeviceSize GetTextureMipSize(VkFormat format, VkExtent2D extent, uint32_t mipLevel)
+	{
+		VkDeviceSize width = std::max(extent.width >> mipLevel, 1u);
+		VkDeviceSize height = std::max(extent.height >> mipLevel, 1u);
+
+		switch (format)
+		{
+		case VK_FORMAT_R8_UNORM:
+			return width * height;
+		case VK_FORMAT_R8G8B8A8_UNORM:
+		case VK_FORMAT_R8G8B8A8_SRGB:
+		case VK_FORMAT_B8G8R8A8_UNORM:
+		case VK_FORMAT_B8G8R8A8_SRGB:
+			return width * height * 4;
+		case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+		case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+		case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+		case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+		case VK_FORMAT_BC4_UNORM_BLOCK:
+			return ((width + 3) / 4) * ((height + 3) / 4) * 8;
+		case VK_FORMAT_BC3_UNORM_BLOCK:
+		case VK_FORMAT_BC3_SRGB_BLOCK:
+		case VK_FORMAT_BC5_UNORM_BLOCK:
+		case VK_FORMAT_BC7_UNORM_BLOCK:
+		case VK_FORMAT_BC7_SRGB_BLOCK:
+			return ((width + 3) / 4) * ((height + 3) / 4) * 16;
+		default:
+			return 0;
+		}
+	}
+
+	bool ReadTextureFileInfo(const uint8_t* data, size_t size, TextureFileInfo& info)
+	{
+		TextureFileHeader header;
+		if (size < sizeof(header))
+		{
+			std::cout << "Error: The texture file is too small for its header!" << std::endl;
+			return false;
+		}
+		std::memcpy(&header, data, sizeof(header));
+
+		if (header.Magic != TextureFileMagic || header.Version != TextureFileVersion)
+		{
+			std::cout << "Error: Not a texture file, or one of another version!" << std::endl;
+			return false;
+		}
+
+		VkFormat format = VkFormat(header.Format);
+		VkExtent2D extent = { header.Width, header.Height };
+		uint32_t maxMipLevels = 1;
+		while ((std::max(extent.width, extent.height) >> maxMipLevels) > 0)
+			maxMipLevels++;
+
+		if (GetTextureMipSize(format, extent, 0) == 0 || extent.width == 0 || extent.height == 0
+			|| header.MipLevels == 0 || header.MipLevels > maxMipLevels || header.Compression > TextureCompression_LZ)
+		{
+			std::cout << "Error: The texture file's header is invalid!" << std::endl;
+			return false;
+		}
+
+		size_t tableEnd = sizeof(header) + size_t(header.MipLevels) * sizeof(TextureFileMipEntry);
+		if (size < tableEnd)
+		{
+			std::cout << "Error: The texture file is too small for its mip table!" << std::endl;
+			return false;
+		}
+
+		info.Format = format;
+		info.Extent = extent;
+		info.MipLevels = header.MipLevels;
+		info.Compression = TextureCompression(header.Compression);
+		info.Mips.resize(header.MipLevels);
+
+		for (uint32_t i = 0; i < header.MipLevels; i++)
+		{
+			TextureFileMipEntry entry;
+			std::memcpy(&entry, data + sizeof(header) + i * sizeof(entry), sizeof(entry));
+
+			bool valid = entry.Offset >= tableEnd && entry.Offset <= size && entry.StoredSize <= size - entry.Offset
+				&& entry.Size == GetTextureMipSize(format, extent, i)
+				&& (info.Compression != TextureCompression_None || entry.StoredSize == entry.Size);
+			if (!valid)
+			{
+				std::cout << "Error: Mip level " << i << " of the texture file is invalid!" << std::endl;
+				return false;
+			}
+
+			info.Mips[i] = { entry.Offset, entry.StoredSize, entry.Size };
+		}
+
+		return true;
+	}
+
+	bool DecodeTextureMip(const uint8_t* data, const TextureFileInfo& info, uint32_t mipLevel, std::vector<uint8_t>& texels)
+	{
+		const TextureFileMip& mip = info.Mips[mipLevel];
+		texels.resize(size_t(mip.Size));
+
+		if (info.Compression == TextureCompression_None)
+		{
+			std::memcpy(texels.data(), data + mip.Offset, size_t(mip.Size));
+			return true;
+		}
+
+		return DecompressLZ(data + mip.Offset, size_t(mip.StoredSize), texels.data(), texels.size());
+	}
+
+	bool WriteTextureFile(const std::string& path, VkFormat format, VkExtent2D extent, const std::vector<std::vector<uint8_t>>& levels,
+		TextureCompression compression)
+	{
+		for (uint32_t i = 0; i < uint32_t(levels.size()); i++)
+		{
+			VkDeviceSize expected = GetTextureMipSize(format, extent, i);
+			if (expected == 0 || levels[i].size() != expected)
+			{
+				std::cout << "Error: Mip level " << i << " doesn't match the texture's format and extent!" << std::endl;
+				return false;
+			}
+		}
+
+		std::ofstream file(path, std::ios::binary);
+		if (!file.is_open())
+		{
+			std::cout << "Error: Couldn't open " << path << " for writing!" << std::endl;
+			return false;
+		}
+
+		TextureFileHeader header{};
+		header.Magic = TextureFileMagic;
+		header.Version = TextureFileVersion;
+		header.Format = uint32_t(format);
+		header.Width = extent.width;
+		header.Height = extent.height;
+		header.MipLevels = uint32_t(levels.size());
+		header.Compression = compression;
+
+		std::vector<TextureFileMipEntry> table(levels.size());
+		std::vector<std::vector<uint8_t>> stored(levels.size());
+		uint64_t offset = sizeof(header) + table.size() * sizeof(TextureFileMipEntry);
+
+		// The smallest mips are stored first
+		for (size_t i = levels.size(); i-- > 0;)
+		{
+			stored[i] = compression == TextureCompression_LZ ? CompressLZ(levels[i].data(), levels[i].size()) : levels[i];
+			table[i] = { offset, stored[i].size(), levels[i].size() };
+			offset += stored[i].size();
+		}
+
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(reinterpret_cast<const char*>(table.data()), std::streamsize(table.size() * sizeof(TextureFileMipEntry)));
+		for (size_t i = levels.size(); i-- > 0;)
+			file.write(reinterpret_cast<const char*>(stored[i].data()), std::streamsize(stored[i].size()));
+
+		if (!file.good())
+		{
+			std::cout << "Error: Couldn't write " << path << "!" << std::endl;
+			return false;
+		}
+
+		return true;
+	}
+
+	void DecodeBC1(const uint8_t* blocks, uint32_t width, uint32_t height, uint8_t* rgba)
+	{
+		uint32_t blocksX = (width + 3) / 4;
+		uint32_t blocksY = (height + 3) / 4;
+
+		auto expand565 = [](uint16_t color, uint8_t* rgb) {
+			rgb[0] = uint8_t(((color >> 11) & 0x1F) * 255 / 31);
+			rgb[1] = uint8_t(((color >> 5) & 0x3F) * 255 / 63);
+			rgb[2] = uint8_t((color & 0x1F) * 255 / 31);
+			rgb[3] = 255;
+		};
+
+		for (uint32_t blockY = 0; blockY < blocksY; blockY++)
+		{
+			for (uint32_t blockX = 0; blockX < blocksX; blockX++)
+			{
+				const uint8_t* block = blocks + (size_t(blockY) * blocksX + blockX) * 8;
+				uint16_t color0 = uint16_t(block[0] | (block[1] << 8));
+				uint16_t color1 = uint16_t(block[2] | (block[3] << 8));
+				uint32_t indices = uint32_t(block[4]) | (uint32_t(block[5]) << 8) | (uint32_t(block[6]) << 16) | (uint32_t(block[7]) << 24);
+
+				uint8_t palette[4][4];
+				expand565(color0, palette[0]);
+				expand565(color1, palette[1]);
+				for (uint32_t channel = 0; channel < 3; channel++)
+				{
+					// The second half of the palette is only interpolated when the endpoints are in order, otherwise
+					// it's their average and transparent black
+					if (color0 > color1)
+					{
+						palette[2][channel] = uint8_t((2 * palette[0][channel] + palette[1][channel]) / 3);
+						palette[3][channel] = uint8_t((palette[0][channel] + 2 * palette[1][channel]) / 3);
+					}
+					else
+					{
+						palette[2][channel] = uint8_t((palette[0][channel] + palette[1][channel]) / 2);
+						palette[3][channel] = 0;
+					}
+				}
+				palette[2][3] = 255;
+				palette[3][3] = color0 > color1 ? 255 : 0;
+
+				for (uint32_t y = 0; y < 4; y++)
+				{
+					for (uint32_t x = 0; x < 4; x++)
+					{
+						uint32_t pixelX = blockX * 4 + x;
+						uint32_t pixelY = blockY * 4 + y;
+						if (pixelX >= width || pixelY >= height)
+							continue;
+
+						uint32_t index = (indices >> (2 * (y * 4 + x))) & 3;
+						std::memcpy(rgba + (size_t(pixelY) * width + pixelX) * 4, palette[index], 4);
+					}
+				}
+			}
+		}
+	}
+
+}
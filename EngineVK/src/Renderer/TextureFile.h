@@ -0,0 +1,58 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace LearningVK {
+
+	enum TextureCompression : uint32_t
+	{
+		TextureCompression_None = 0,
+		// Byte oriented LZ77, cheap enough to decode while streaming. It's applied on top of the texel format, so
+		// block compressed mips are smaller on disk as well.
+		TextureCompression_LZ = 1
+	};
+
+	struct TextureFileMip
+	{
+		// From the start of the file
+		uint64_t Offset = 0;
+		uint64_t StoredSize = 0;
+		// Of the decoded texels, tightly packed
+		uint64_t Size = 0;
+	};
+
+	// The header and mip table of a texture file. The file stores a 2D texture's whole mip chain with the smallest
+	// mips first, so the mips a texture is shown with first are read from one contiguous range at its start.
+	struct TextureFileInfo
+	{
+		VkFormat Format = VK_FORMAT_UNDEFINED;
+		VkExtent2D Extent = { 0, 0 };
+		uint32_t MipLevels = 0;
+		TextureCompression Compression = TextureCompression_None;
+		std::vector<TextureFileMip> Mips;
+	};
+
+	// Bytes of a tightly packed mip level, or 0 for formats texture files don't support. Uncompressed 8-bit formats
+	// and BC1 to BC7 are supported.
+	VkDeviceSize GetTextureMipSize(VkFormat format, VkExtent2D extent, uint32_t mipLevel);
+
+	// Reads and checks the header and mip table at the start of a file's contents
+	bool ReadTextureFileInfo(const uint8_t* data, size_t size, TextureFileInfo& info);
+
+	// Decodes one mip level of a file's contents into tightly packed texels. Only reads the file, so several mips
+	// may be decoded at once from different threads.
+	bool DecodeTextureMip(const uint8_t* data, const TextureFileInfo& info, uint32_t mipLevel, std::vector<uint8_t>& texels);
+
+	// levels holds the tightly packed texels of every mip level, starting with the largest
+	bool WriteTextureFile(const std::string& path, VkFormat format, VkExtent2D extent, const std::vector<std::vector<uint8_t>>& levels,
+		TextureCompression compression = TextureCompression_LZ);
+
+	// Expands BC1 blocks to 8-bit RGBA, for devices that can't sample them
+	void DecodeBC1(const uint8_t* blocks, uint32_t width, uint32_t height, uint8_t* rgba);
+
+}
@@ -0,0 +1,488 @@
+#include <vkpch.h>
+
+#include "TextureStreamer.h"
+#include "DeviceDispatch.h"
+#include "MemoryTracker.h"
+#include "Upload.h"
+
+#include <cmath>
+#include <iostream>
+#include <queue>
+
+namespace LearningVK
+{
+
+	// How far below the fraction of its budget that lowered the streaming budget a heap has to get before it's raised again
+	static constexpr float BudgetRecovery = 0.1f;
+
+	static bool IsBC1(VkFormat format)
+	{
+		return format == VK_FORMAT_BC1_RGB_UNORM_BLOCK || format == VK_FORMAT_BC1_RGB_SRGB_BLOCK
+			|| format == VK_FORMAT_BC1_RGBA_UNORM_BLOCK || format == VK_FORMAT_BC1_RGBA_SRGB_BLOCK;
+	}
+
+	// Copies levelCount mips between two textures whose mips are in VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, the
+	// destination's are discarded. Both are left in that layout.
+	static void CopyMipLevels(VkCommandBuffer commandBuffer, const Texture& source, uint32_t sourceMip, const Texture& destination, uint32_t destinationMip, uint32_t levelCount)
+	{
+		const DeviceDispatch& dispatch = GetDeviceDispatch();
+
+		std::array<VkImageMemoryBarrier, 2> barriers{};
+		for (VkImageMemoryBarrier& barrier : barriers)
+		{
+			barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+			barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		}
+
+		barriers[0].image = source.Image;
+		barriers[0].subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, sourceMip, levelCount, 0, 1 };
+		barriers[0].srcAccessMask = 0;
+		barriers[0].dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+		barriers[0].oldLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		barriers[0].newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+
+		barriers[1].image = destination.Image;
+		barriers[1].subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, destinationMip, levelCount, 0, 1 };
+		barriers[1].srcAccessMask = 0;
+		barriers[1].dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barriers[1].oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		barriers[1].newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+
+		dispatch.CmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+			0, 0, nullptr, 0, nullptr, uint32_t(barriers.size()), barriers.data());
+
+		std::vector<VkImageCopy> regions(levelCount);
+		for (uint32_t i = 0; i < levelCount; i++)
+		{
+			regions[i].srcSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, sourceMip + i, 0, 1 };
+			regions[i].srcOffset = { 0, 0, 0 };
+			regions[i].dstSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, destinationMip + i, 0, 1 };
+			regions[i].dstOffset = { 0, 0, 0 };
+			regions[i].extent = { std::max(source.Extent.width >> (sourceMip + i), 1u), std::max(source.Extent.height >> (sourceMip + i), 1u), 1 };
+		}
+
+		dispatch.CmdCopyImage(commandBuffer, source.Image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, destination.Image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+			uint32_t(regions.size()), regions.data());
+
+		// Frames submitted before the replacement is swapped in may still sample the source
+		barriers[0].srcAccessMask = 0;
+		barriers[0].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+		barriers[0].oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+		barriers[0].newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+		barriers[1].srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barriers[1].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+		barriers[1].oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		barriers[1].newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+		dispatch.CmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+			0, 0, nullptr, 0, nullptr, uint32_t(barriers.size()), barriers.data());
+	}
+
+	TextureStreamer::TextureStreamer(const TextureStreamerSpecification& specification)
+		: specification(specification), decodeThreads(specification.DecodeThreads)
+	{
+		// Runs in MemoryTracker::Update(), which has to be called on the thread that calls Update()
+		budgetCallback = GetMemoryTracker().AddBudgetCallback([this](const MemoryHeapStats& heap) {
+			if (!heap.DeviceLocal)
+				return;
+
+			// A quarter of what's resident is given up, from the textures that need their mips the least
+			pressuredHeap = heap.HeapIndex;
+			pressuredFraction = heap.GetBudgetFraction();
+			pressuredBudget = residentBytes - residentBytes / 4;
+		});
+	}
+
+	TextureStreamer::~TextureStreamer()
+	{
+		decodeThreads.Wait();
+		GetMemoryTracker().RemoveBudgetCallback(budgetCallback);
+
+		for (StreamedTexture& texture : textures)
+			DestroyTexture(specification.Device, texture.Resident);
+	}
+
+	StreamedTextureId TextureStreamer::Load(const std::string& path)
+	{
+		StreamedTexture texture;
+		texture.File = std::make_unique<MappedFile>();
+		if (!texture.File->Open(path) || !ReadTextureFileInfo(texture.File->GetData(), texture.File->GetSize(), texture.Info))
+		{
+			std::cout << "Error: Couldn't load the streamed texture " << path << "!" << std::endl;
+			return InvalidStreamedTexture;
+		}
+
+		VkFormatProperties formatProperties;
+		vkGetPhysicalDeviceFormatProperties(specification.PhysicalDevice, texture.Info.Format, &formatProperties);
+
+		texture.Format = texture.Info.Format;
+		if (!(formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT))
+		{
+			if (!IsBC1(texture.Info.Format))
+			{
+				std::cout << "Error: The device can't sample the format of " << path << "!" << std::endl;
+				return InvalidStreamedTexture;
+			}
+
+			bool srgb = texture.Info.Format == VK_FORMAT_BC1_RGB_SRGB_BLOCK || texture.Info.Format == VK_FORMAT_BC1_RGBA_SRGB_BLOCK;
+			texture.Format = srgb ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
+			texture.Transcode = true;
+		}
+
+		texture.LevelBytes.resize(texture.Info.MipLevels);
+		for (uint32_t mip = 0; mip < texture.Info.MipLevels; mip++)
+			texture.LevelBytes[mip] = GetTextureMipSize(texture.Format, texture.Info.Extent, mip);
+
+		// The tail starts at the first mip no larger than TailSize, or at the smallest mip when the file has none
+		texture.TailMip = texture.Info.MipLevels - 1;
+		for (uint32_t mip = 0; mip < texture.Info.MipLevels; mip++)
+		{
+			if (std::max(texture.Info.Extent.width, texture.Info.Extent.height) >> mip <= specification.TailSize)
+			{
+				texture.TailMip = mip;
+				break;
+			}
+		}
+
+		texture.ResidentMip = texture.Info.MipLevels;
+		texture.WantedMip = texture.TailMip;
+
+		textures.push_back(std::move(texture));
+		StreamedTextureId id = StreamedTextureId(textures.size() - 1);
+
+		// Tails are queued straight away whatever the number of pending decodes, every texture needs one
+		QueueDecode(id, textures[id].TailMip, textures[id].Info.MipLevels);
+		return id;
+	}
+
+	void TextureStreamer::ReportUsage(StreamedTextureId id, float screenSize)
+	{
+		StreamedTexture& texture = textures[id];
+		if (texture.LastUsedUpdate != updateCount)
+		{
+			texture.ScreenSize = 0.0f;
+			texture.LastUsedUpdate = updateCount;
+		}
+
+		texture.ScreenSize = std::max(texture.ScreenSize, screenSize);
+	}
+
+	bool TextureStreamer::Update(DeletionQueue& deletionQueue, uint64_t frameNumber)
+	{
+		updateCount++;
+		UpdateBudgetPressure();
+		ChooseWantedMips();
+
+		bool replaced = false;
+		VkDeviceSize uploadedBytes = 0;
+
+		// Dropping mips goes first, so their memory is free for the mips that are uploaded next
+		for (StreamedTexture& texture : textures)
+		{
+			if (uploadedBytes >= specification.MaxUploadBytesPerUpdate)
+				break;
+			if (!texture.Resident.Image || texture.WantedMip <= texture.ResidentMip)
+				continue;
+
+			if (Replace(texture, texture.WantedMip, nullptr, deletionQueue, frameNumber))
+			{
+				uploadedBytes += texture.Resident.Size;
+				stats.Lowers++;
+				replaced = true;
+			}
+		}
+
+		std::vector<DecodedMips> finished;
+		{
+			std::lock_guard<std::mutex> lock(decodedMutex);
+			finished.swap(decoded);
+		}
+
+		// Tails first, a texture without one can't be shown at all
+		std::stable_partition(finished.begin(), finished.end(), [&](const DecodedMips& mips) { return !IsReady(mips.Texture); });
+
+		std::vector<DecodedMips> leftOver;
+		for (DecodedMips& mips : finished)
+		{
+			if (uploadedBytes >= specification.MaxUploadBytesPerUpdate)
+			{
+				leftOver.push_back(std::move(mips));
+				continue;
+			}
+
+			StreamedTexture& texture = textures[mips.Texture];
+			texture.DecodePending = false;
+			pendingDecodes--;
+
+			if (!mips.Success)
+			{
+				std::cout << "Error: Couldn't decode mip level " << mips.FirstMip << " of a streamed texture!" << std::endl;
+				texture.Failed = true;
+				continue;
+			}
+
+			for (const std::vector<uint8_t>& level : mips.Levels)
+				stats.DecodedBytes += level.size();
+
+			// The usage may have changed while the mips were decoded, a tail is always wanted
+			bool tail = !IsReady(mips.Texture);
+			if (!tail)
+			{
+				bool adjoining = mips.FirstMip + uint32_t(mips.Levels.size()) == texture.ResidentMip;
+				bool fits = residentBytes - texture.Resident.Size + GetBytesFrom(texture, mips.FirstMip) <= GetBudget();
+				if (!adjoining || mips.FirstMip < texture.WantedMip || !fits)
+					continue;
+			}
+
+			if (Replace(texture, mips.FirstMip, &mips, deletionQueue, frameNumber))
+			{
+				uploadedBytes += texture.Resident.Size;
+				if (!tail)
+					stats.Raises++;
+				replaced = true;
+			}
+			else if (tail)
+			{
+				texture.Failed = true;
+			}
+		}
+
+		if (!leftOver.empty())
+		{
+			std::lock_guard<std::mutex> lock(decodedMutex);
+			decoded.insert(decoded.end(), std::make_move_iterator(leftOver.begin()), std::make_move_iterator(leftOver.end()));
+		}
+
+		QueueDecodes();
+
+		stats.TextureCount = uint32_t(textures.size());
+		stats.ReadyCount = 0;
+		stats.FullBytes = 0;
+		for (StreamedTextureId id = 0; id < StreamedTextureId(textures.size()); id++)
+		{
+			stats.ReadyCount += IsReady(id) ? 1 : 0;
+			stats.FullBytes += GetBytesFrom(textures[id], 0);
+		}
+		stats.PendingDecodes = pendingDecodes;
+		stats.ResidentBytes = residentBytes;
+		stats.Budget = GetBudget();
+
+		return replaced;
+	}
+
+	void TextureStreamer::ChooseWantedMips()
+	{
+		VkDeviceSize wantedBytes = 0;
+		for (StreamedTexture& texture : textures)
+		{
+			if (texture.Failed)
+				continue;
+
+			texture.WantedMip = texture.TailMip;
+			bool used = texture.ScreenSize > 0.0f && updateCount - texture.LastUsedUpdate <= specification.UnusedUpdates;
+			if (used)
+			{
+				// Every level halves the texels along the longer side, the wanted level has at least as many as pixels cover it
+				float texels = float(std::max(texture.Info.Extent.width, texture.Info.Extent.height));
+				float levels = std::floor(std::log2(std::max(texels / texture.ScreenSize, 1.0f)));
+				texture.WantedMip = std::min(uint32_t(levels), texture.TailMip);
+			}
+
+			wantedBytes += GetBytesFrom(texture, texture.WantedMip);
+		}
+
+		VkDeviceSize budget = GetBudget();
+		if (wantedBytes <= budget)
+			return;
+
+		// Over the budget textures lose a level at a time, the one with the fewest pixels per texel first since it
+		// loses the least detail. Tails are never dropped, so the budget may still be exceeded by them.
+		auto pixelsPerTexel = [&](StreamedTextureId id) {
+			const StreamedTexture& texture = textures[id];
+			uint32_t texels = std::max(std::max(texture.Info.Extent.width, texture.Info.Extent.height) >> texture.WantedMip, 1u);
+			return texture.ScreenSize / float(texels);
+		};
+
+		using Candidate = std::pair<float, StreamedTextureId>;
+		std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> candidates;
+		for (StreamedTextureId id = 0; id < StreamedTextureId(textures.size()); id++)
+		{
+			if (!textures[id].Failed && textures[id].WantedMip < textures[id].TailMip)
+				candidates.push({ pixelsPerTexel(id), id });
+		}
+
+		while (wantedBytes > budget && !candidates.empty())
+		{
+			StreamedTextureId id = candidates.top().second;
+			candidates.pop();
+
+			StreamedTexture& texture = textures[id];
+			wantedBytes -= texture.LevelBytes[texture.WantedMip];
+			texture.WantedMip++;
+
+			if (texture.WantedMip < texture.TailMip)
+				candidates.push({ pixelsPerTexel(id), id });
+		}
+	}
+
+	void TextureStreamer::QueueDecodes()
+	{
+		// Enough to keep every thread busy, the rest waits so the decodes follow the usage as it changes
+		uint32_t maxPendingDecodes = decodeThreads.GetThreadCount() * 2;
+
+		std::vector<StreamedTextureId> candidates;
+		for (StreamedTextureId id = 0; id < StreamedTextureId(textures.size()); id++)
+		{
+			const StreamedTexture& texture = textures[id];
+			if (!texture.Failed && !texture.DecodePending && IsReady(id) && texture.WantedMip < texture.ResidentMip)
+				candidates.push_back(id);
+		}
+
+		// The textures missing the most levels first, then the largest on screen
+		std::sort(candidates.begin(), candidates.end(), [&](StreamedTextureId a, StreamedTextureId b) {
+			uint32_t missingA = textures[a].ResidentMip - textures[a].WantedMip;
+			uint32_t missingB = textures[b].ResidentMip - textures[b].WantedMip;
+			if (missingA != missingB)
+				return missingA > missingB;
+			return textures[a].ScreenSize > textures[b].ScreenSize;
+		});
+
+		VkDeviceSize projectedBytes = residentBytes;
+		VkDeviceSize budget = GetBudget();
+		for (StreamedTextureId id : candidates)
+		{
+			if (pendingDecodes >= maxPendingDecodes)
+				break;
+
+			// One level at a time from the largest resident one up, so the texture sharpens step by step
+			const StreamedTexture& texture = textures[id];
+			uint32_t mip = texture.ResidentMip - 1;
+			if (projectedBytes + texture.LevelBytes[mip] > budget)
+				continue;
+
+			projectedBytes += texture.LevelBytes[mip];
+			QueueDecode(id, mip, mip + 1);
+		}
+	}
+
+	void TextureStreamer::QueueDecode(StreamedTextureId id, uint32_t firstMip, uint32_t lastMip)
+	{
+		StreamedTexture& texture = textures[id];
+		texture.DecodePending = true;
+		pendingDecodes++;
+
+		// The job only reads the mapped file and a copy of its info, textures may grow while it runs
+		const uint8_t* data = texture.File->GetData();
+		decodeThreads.Submit([this, id, data, info = texture.Info, transcode = texture.Transcode, firstMip, lastMip]() {
+			DecodedMips mips;
+			mips.Texture = id;
+			mips.FirstMip = firstMip;
+
+			for (uint32_t mip = firstMip; mip < lastMip && mips.Success; mip++)
+			{
+				std::vector<uint8_t> texels;
+				mips.Success = DecodeTextureMip(data, info, mip, texels);
+
+				if (mips.Success && transcode)
+				{
+					uint32_t width = std::max(info.Extent.width >> mip, 1u);
+					uint32_t height = std::max(info.Extent.height >> mip, 1u);
+					std::vector<uint8_t> rgba(size_t(width) * height * 4);
+					DecodeBC1(texels.data(), width, height, rgba.data());
+					texels.swap(rgba);
+				}
+
+				mips.Levels.push_back(std::move(texels));
+			}
+
+			std::lock_guard<std::mutex> lock(decodedMutex);
+			decoded.push_back(std::move(mips));
+		});
+	}
+
+	bool TextureStreamer::Replace(StreamedTexture& texture, uint32_t firstMip, const DecodedMips* decodedMips, DeletionQueue& deletionQueue, uint64_t frameNumber)
+	{
+		VkDevice device = specification.Device;
+		uint32_t mipLevels = texture.Info.MipLevels;
+
+		TextureSpecification textureSpecification;
+		textureSpecification.Extent = { std::max(texture.Info.Extent.width >> firstMip, 1u), std::max(texture.Info.Extent.height >> firstMip, 1u) };
+		textureSpecification.Format = texture.Format;
+		textureSpecification.MipLevels = mipLevels - firstMip;
+		// Its mips are copied to the next texture that replaces it
+		textureSpecification.Usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+
+		Texture replacement;
+		if (!CreateTexture(device, specification.PhysicalDevice, textureSpecification, replacement))
+			return false;
+
+		if (texture.Resident.Image)
+		{
+			uint32_t copiedMip = std::max(firstMip, texture.ResidentMip);
+			SubmitImmediate(device, specification.UploadQueue, specification.UploadCommandPool, [&](VkCommandBuffer commandBuffer) {
+				CopyMipLevels(commandBuffer, texture.Resident, copiedMip - texture.ResidentMip, replacement, copiedMip - firstMip, mipLevels - copiedMip);
+			});
+		}
+
+		if (decodedMips)
+		{
+			for (uint32_t i = 0; i < uint32_t(decodedMips->Levels.size()); i++)
+			{
+				const std::vector<uint8_t>& level = decodedMips->Levels[i];
+				if (!UploadTexture(device, specification.PhysicalDevice, specification.UploadQueue, specification.UploadCommandPool,
+					replacement, decodedMips->FirstMip + i - firstMip, level.data(), level.size()))
+				{
+					std::cout << "Error: Couldn't upload a mip level of a streamed texture!" << std::endl;
+					DestroyTexture(device, replacement);
+					return false;
+				}
+
+				stats.UploadedBytes += level.size();
+			}
+		}
+
+		if (texture.Resident.Image)
+		{
+			residentBytes -= texture.Resident.Size;
+			deletionQueue.Push(frameNumber, [device, retired = texture.Resident]() mutable {
+				DestroyTexture(device, retired);
+			});
+		}
+
+		texture.Resident = replacement;
+		texture.ResidentMip = firstMip;
+		residentBytes += replacement.Size;
+		return true;
+	}
+
+	VkDeviceSize TextureStreamer::GetBytesFrom(const StreamedTexture& texture, uint32_t firstMip) const
+	{
+		VkDeviceSize bytes = 0;
+		for (uint32_t mip = firstMip; mip < uint32_t(texture.LevelBytes.size()); mip++)
+			bytes += texture.LevelBytes[mip];
+		return bytes;
+	}
+
+	VkDeviceSize TextureStreamer::GetBudget() const
+	{
+		if (pressuredHeap != UINT32_MAX)
+			return std::min(specification.MemoryBudget, pressuredBudget);
+		return specification.MemoryBudget;
+	}
+
+	void TextureStreamer::UpdateBudgetPressure()
+	{
+		if (pressuredHeap == UINT32_MAX)
+			return;
+
+		MemoryStats memoryStats = GetMemoryTracker().GetStats();
+		for (const MemoryHeapStats& heap : memoryStats.Heaps)
+		{
+			if (heap.HeapIndex == pressuredHeap && heap.GetBudgetFraction() < pressuredFraction - BudgetRecovery)
+				pressuredHeap = UINT32_MAX;
+		}
+	}
+
+}
@@ -0,0 +1,164 @@
+#pragma once
+
+#include "Core/MappedFile.h"
+#include "Core/ThreadPool.h"
+#include "Renderer/DeletionQueue.h"
+#include "Renderer/Texture.h"
+#include "Renderer/TextureFile.h"
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace LearningVK {
+
+	struct TextureStreamerSpecification
+	{
+		VkDevice Device = VK_NULL_HANDLE;
+		VkPhysicalDevice PhysicalDevice = VK_NULL_HANDLE;
+		VkQueue UploadQueue = VK_NULL_HANDLE;
+		VkCommandPool UploadCommandPool = VK_NULL_HANDLE;
+
+		uint32_t DecodeThreads = 2;
+		// Device memory the streamed textures may take up together. It's lowered for a while when a device local
+		// heap gets close to its budget.
+		VkDeviceSize MemoryBudget = 256ull * 1024 * 1024;
+		// Uploads wait for the queue, so an Update() uploads and copies no more than this. Mips that are left over
+		// are uploaded by the next Update().
+		VkDeviceSize MaxUploadBytesPerUpdate = 8ull * 1024 * 1024;
+		// Mips up to this size are loaded as soon as a texture is, and never dropped
+		uint32_t TailSize = 64;
+		// Updates a texture may go without a ReportUsage() before it's lowered to its tail
+		uint32_t UnusedUpdates = 120;
+	};
+
+	using StreamedTextureId = uint32_t;
+	constexpr StreamedTextureId InvalidStreamedTexture = UINT32_MAX;
+
+	struct TextureStreamerStats
+	{
+		uint32_t TextureCount = 0;
+		uint32_t ReadyCount = 0;
+		uint32_t PendingDecodes = 0;
+		VkDeviceSize ResidentBytes = 0;
+		// What the resident mips would take up with every texture fully resident
+		VkDeviceSize FullBytes = 0;
+		VkDeviceSize Budget = 0;
+		// Totals since the streamer was created
+		uint64_t DecodedBytes = 0;
+		uint64_t UploadedBytes = 0;
+		uint32_t Raises = 0;
+		uint32_t Lowers = 0;
+	};
+
+	// Streams textures from texture files. Loading a texture maps its file and decodes its smallest mips on worker
+	// threads, so it can be shown after the first few kilobytes. From there every texture is given the mips its
+	// size on screen calls for, as long as they fit the memory budget: missing mips are decoded one at a time from
+	// the largest resident one up, mips nobody looks at anymore are dropped. Devices that can't sample BC1 get it
+	// transcoded to RGBA.
+	//
+	// Only the resident mips are allocated, so a texture is replaced by a new one whenever its resident mips
+	// change. The mips it keeps are copied on the GPU, the old texture is retired through the deletion queue.
+	class TextureStreamer
+	{
+	public:
+		explicit TextureStreamer(const TextureStreamerSpecification& specification);
+		// The GPU must be done with every texture
+		~TextureStreamer();
+
+		TextureStreamer(const TextureStreamer&) = delete;
+		TextureStreamer& operator=(const TextureStreamer&) = delete;
+
+		// Returns InvalidStreamedTexture when the file can't be read or its format can't be sampled
+		StreamedTextureId Load(const std::string& path);
+
+		// screenSize is the most pixels the texture covers on screen along its longer side this frame, for the
+		// mip level that's sampled at about one texel per pixel. Report every texture that's drawn once a frame.
+		void ReportUsage(StreamedTextureId id, float screenSize);
+
+		// Uploads decoded mips, drops mips that aren't needed and decodes the next ones, call it once a frame.
+		// frameNumber is the last frame that may still use the textures being replaced. Returns true when any
+		// texture was replaced, descriptors of the old texture's view have to be updated before the next frame.
+		bool Update(DeletionQueue& deletionQueue, uint64_t frameNumber);
+
+		// Ready once its tail is resident, before that the texture has no image
+		bool IsReady(StreamedTextureId id) const { return textures[id].Resident.Image != VK_NULL_HANDLE; }
+		// Mip level 0 of the texture is this mip level of the file
+		uint32_t GetResidentMip(StreamedTextureId id) const { return textures[id].ResidentMip; }
+		uint32_t GetWantedMip(StreamedTextureId id) const { return textures[id].WantedMip; }
+		uint32_t GetMipLevels(StreamedTextureId id) const { return textures[id].Info.MipLevels; }
+		const Texture& GetTexture(StreamedTextureId id) const { return textures[id].Resident; }
+
+		const TextureStreamerStats& GetStats() const { return stats; }
+	private:
+		struct StreamedTexture
+		{
+			std::unique_ptr<MappedFile> File;
+			TextureFileInfo Info;
+			// What the texture is created with, RGBA when BC1 has to be transcoded
+			VkFormat Format = VK_FORMAT_UNDEFINED;
+			bool Transcode = false;
+			// Bytes of every mip level in Format
+			std::vector<VkDeviceSize> LevelBytes;
+
+			Texture Resident;
+			// Equal to the mip count while nothing is resident
+			uint32_t ResidentMip = 0;
+			uint32_t WantedMip = 0;
+			uint32_t TailMip = 0;
+
+			float ScreenSize = 0.0f;
+			uint64_t LastUsedUpdate = 0;
+			bool DecodePending = false;
+			bool Failed = false;
+		};
+
+		// Decoded texels of consecutive mip levels, starting at FirstMip
+		struct DecodedMips
+		{
+			StreamedTextureId Texture = InvalidStreamedTexture;
+			uint32_t FirstMip = 0;
+			std::vector<std::vector<uint8_t>> Levels;
+			bool Success = true;
+		};
+
+		void ChooseWantedMips();
+		void QueueDecodes();
+		void QueueDecode(StreamedTextureId id, uint32_t firstMip, uint32_t lastMip);
+
+		// Replaces the texture with one that starts at firstMip, copying the mips both have and uploading the
+		// decoded ones. Returns false when the texture couldn't be created, the old one is kept then.
+		bool Replace(StreamedTexture& texture, uint32_t firstMip, const DecodedMips* decoded, DeletionQueue& deletionQueue, uint64_t frameNumber);
+
+		VkDeviceSize GetBytesFrom(const StreamedTexture& texture, uint32_t firstMip) const;
+		VkDeviceSize GetBudget() const;
+		void UpdateBudgetPressure();
+	private:
+		TextureStreamerSpecification specification;
+
+		std::vector<StreamedTexture> textures;
+		uint64_t updateCount = 0;
+		uint32_t pendingDecodes = 0;
+		VkDeviceSize residentBytes = 0;
+
+		std::mutex decodedMutex;
+		std::vector<DecodedMips> decoded;
+
+		// Set by the memory tracker's budget callback, the budget stays lowered until the heap's usage is clearly
+		// below where it was when the callback fired
+		uint32_t budgetCallback = 0;
+		uint32_t pressuredHeap = UINT32_MAX;
+		float pressuredFraction = 0.0f;
+		VkDeviceSize pressuredBudget = 0;
+
+		TextureStreamerStats stats;
+
+		// Last, so it's destroyed first and no decode outlives what it writes to
+		ThreadPool decodeThreads;
+	};
+
+}
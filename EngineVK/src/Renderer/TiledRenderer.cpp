@@ -0,0 +1,422 @@
+#include <vkpch.h>
+
+#include "TiledRenderer.h"
+#include "DeviceDispatch.h"
+
+#include <chrono>
+#include <iostream>
+
+namespace LearningVK
+{
+
+	TiledRenderer::TiledRenderer(VkDevice device, VkPhysicalDevice physicalDevice, VkQueue queue, uint32_t queueFamily, const TiledRenderSpecification& specification)
+		: device(device), physicalDevice(physicalDevice), queue(queue), specification(specification)
+	{
+		VkPhysicalDeviceProperties properties;
+		vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+		const VkPhysicalDeviceLimits& limits = properties.limits;
+
+		uint32_t maxWidth = std::min({ specification.TileSize, limits.maxFramebufferWidth, limits.maxImageDimension2D });
+		uint32_t maxHeight = std::min({ specification.TileSize, limits.maxFramebufferHeight, limits.maxImageDimension2D });
+		tileExtent = { std::min(maxWidth, specification.Extent.width), std::min(maxHeight, specification.Extent.height) };
+		tilesX = (specification.Extent.width + tileExtent.width - 1) / tileExtent.width;
+		tilesY = (specification.Extent.height + tileExtent.height - 1) / tileExtent.height;
+
+		VkFormat format = specification.ColorFormat;
+		swapRedBlue = format == VK_FORMAT_B8G8R8A8_SRGB || format == VK_FORMAT_B8G8R8A8_UNORM;
+		if (!swapRedBlue && format != VK_FORMAT_R8G8B8A8_SRGB && format != VK_FORMAT_R8G8B8A8_UNORM)
+		{
+			std::cout << "Error: Tiled rendering needs an 8-bit RGBA or BGRA color format!" << std::endl;
+			return;
+		}
+
+		if (!CreateRenderPass())
+			return;
+
+		VkCommandPoolCreateInfo poolInfo{};
+		poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+		poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+		poolInfo.queueFamilyIndex = queueFamily;
+
+		if (vkCreateCommandPool(device, &poolInfo, nullptr, &commandPool) != VK_SUCCESS)
+		{
+			std::cout << "Error: Couldn't create the tile command pool!" << std::endl;
+			return;
+		}
+
+		for (uint32_t i = 0; i < std::max(specification.PoolSize, 1u); i++)
+		{
+			slots.push_back(std::make_unique<Slot>());
+			if (!CreateSlot(*slots.back()))
+				return;
+
+			Slot& slot = *slots.back();
+			stats.PoolMemory += slot.Color.Size + slot.Depth.Size + slot.Resolved.Size + slot.Readback.Size;
+		}
+
+		// A single writer keeps the seeks and writes of different tiles from interleaving
+		writer = std::make_unique<ThreadPool>(1);
+
+		stats.TileCount = tilesX * tilesY;
+		stats.TileExtent = tileExtent;
+	}
+
+	TiledRenderer::~TiledRenderer()
+	{
+		writer.reset();
+
+		for (auto& slot : slots)
+			DestroySlot(*slot);
+
+		vkDestroyCommandPool(device, commandPool, nullptr);
+		vkDestroyRenderPass(device, renderPass, nullptr);
+	}
+
+	bool TiledRenderer::Render(const RecordFunction& recordPrepare, const RecordFunction& recordDraw)
+	{
+		if (!writer)
+			return false;
+
+		if (!output.Open(specification.OutputPath, specification.Extent.width, specification.Extent.height))
+		{
+			std::cout << "Error: Couldn't open " << specification.OutputPath << "!" << std::endl;
+			return false;
+		}
+
+		auto start = std::chrono::steady_clock::now();
+		writeFailed = false;
+
+		for (uint32_t index = 0; index < stats.TileCount; index++)
+		{
+			Tile tile = GetTile(index);
+			Slot& slot = *slots[tile.Slot];
+
+			// The slot's last tile has to be off the GPU and out of the readback buffer before it's reused
+			CollectTile(slot, true);
+			WaitForWrite(slot);
+
+			RecordTile(slot, tile, recordPrepare, recordDraw);
+
+			// Anything else that finished meanwhile goes to the writer now rather than when its slot comes around
+			for (auto& other : slots)
+			{
+				if (other.get() != &slot)
+					CollectTile(*other, false);
+			}
+		}
+
+		for (auto& slot : slots)
+			CollectTile(*slot, true);
+		writer->Wait();
+
+		bool written = output.Close() && !writeFailed;
+		stats.Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		return written;
+	}
+
+	bool TiledRenderer::CreateRenderPass()
+	{
+		bool multisampled = specification.Samples != VK_SAMPLE_COUNT_1_BIT;
+
+		// Same attachments as a regular MSAA pass, the single sampled color is left ready to be copied out
+		VkAttachmentDescription colorAttachment{};
+		colorAttachment.format = specification.ColorFormat;
+		colorAttachment.samples = specification.Samples;
+		colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+		colorAttachment.storeOp = multisampled ? VK_ATTACHMENT_STORE_OP_DONT_CARE : VK_ATTACHMENT_STORE_OP_STORE;
+		colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+		colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+		colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		colorAttachment.finalLayout = multisampled ? VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL : VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+
+		VkAttachmentDescription depthAttachment{};
+		depthAttachment.format = specification.DepthFormat;
+		depthAttachment.samples = specification.Samples;
+		depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+		depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+		depthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+		depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+		depthAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		depthAttachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+		VkAttachmentDescription resolveAttachment = colorAttachment;
+		resolveAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+		resolveAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+		resolveAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+		resolveAttachment.finalLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+
+		VkAttachmentReference colorAttachmentRef{ 0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL };
+		VkAttachmentReference depthAttachmentRef{ 1, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL };
+		VkAttachmentReference resolveAttachmentRef{ 2, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL };
+
+		VkSubpassDescription subpassDescription{};
+		subpassDescription.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+		subpassDescription.colorAttachmentCount = 1;
+		subpassDescription.pColorAttachments = &colorAttachmentRef;
+		subpassDescription.pDepthStencilAttachment = &depthAttachmentRef;
+		if (multisampled)
+			subpassDescription.pResolveAttachments = &resolveAttachmentRef;
+
+		// The previous tile's copy reads the same image, and this tile's copy waits for the color
+		std::array<VkSubpassDependency, 2> dependencies{};
+		dependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
+		dependencies[0].dstSubpass = 0;
+		dependencies[0].srcStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+		dependencies[0].srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+		dependencies[0].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+		dependencies[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+		dependencies[1].srcSubpass = 0;
+		dependencies[1].dstSubpass = VK_SUBPASS_EXTERNAL;
+		dependencies[1].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+		dependencies[1].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+		dependencies[1].dstStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+		dependencies[1].dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+		std::vector<VkAttachmentDescription> attachments = { colorAttachment, depthAttachment };
+		if (multisampled)
+			attachments.push_back(resolveAttachment);
+
+		VkRenderPassCreateInfo renderPassInfo{};
+		renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+		renderPassInfo.attachmentCount = uint32_t(attachments.size());
+		renderPassInfo.pAttachments = attachments.data();
+		renderPassInfo.subpassCount = 1;
+		renderPassInfo.pSubpasses = &subpassDescription;
+		renderPassInfo.dependencyCount = uint32_t(dependencies.size());
+		renderPassInfo.pDependencies = dependencies.data();
+
+		if (vkCreateRenderPass(device, &renderPassInfo, nullptr, &renderPass) != VK_SUCCESS)
+		{
+			std::cout << "Error: Couldn't create the tile render pass!" << std::endl;
+			return false;
+		}
+
+		return true;
+	}
+
+	bool TiledRenderer::CreateSlot(Slot& slot)
+	{
+		bool multisampled = specification.Samples != VK_SAMPLE_COUNT_1_BIT;
+
+		AttachmentSpecification depthSpecification;
+		depthSpecification.Extent = tileExtent;
+		depthSpecification.Format = specification.DepthFormat;
+		depthSpecification.Samples = specification.Samples;
+		depthSpecification.Usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+		depthSpecification.Aspect = VK_IMAGE_ASPECT_DEPTH_BIT;
+		depthSpecification.Transient = true;
+
+		AttachmentSpecification resolvedSpecification;
+		resolvedSpecification.Extent = tileExtent;
+		resolvedSpecification.Format = specification.ColorFormat;
+		resolvedSpecification.Usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+
+		if (!CreateAttachment(device, physicalDevice, depthSpecification, slot.Depth) ||
+			!CreateAttachment(device, physicalDevice, resolvedSpecification, slot.Resolved))
+			return false;
+
+		if (multisampled)
+		{
+			AttachmentSpecification colorSpecification = resolvedSpecification;
+			colorSpecification.Samples = specification.Samples;
+			colorSpecification.Usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+			colorSpecification.Transient = true;
+
+			if (!CreateAttachment(device, physicalDevice, colorSpecification, slot.Color))
+				return false;
+		}
+
+		std::vector<VkImageView> views = { multisampled ? slot.Color.View : slot.Resolved.View, slot.Depth.View };
+		if (multisampled)
+			views.push_back(slot.Resolved.View);
+
+		VkFramebufferCreateInfo frameBufferInfo{};
+		frameBufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+		frameBufferInfo.renderPass = renderPass;
+		frameBufferInfo.attachmentCount = uint32_t(views.size());
+		frameBufferInfo.pAttachments = views.data();
+		frameBufferInfo.width = tileExtent.width;
+		frameBufferInfo.height = tileExtent.height;
+		frameBufferInfo.layers = 1;
+
+		if (vkCreateFramebuffer(device, &frameBufferInfo, nullptr, &slot.Framebuffer) != VK_SUCCESS)
+		{
+			std::cout << "Error: Couldn't create the tile framebuffer!" << std::endl;
+			return false;
+		}
+
+		VkDeviceSize readbackSize = VkDeviceSize(tileExtent.width) * tileExtent.height * 4;
+		if (!CreateBuffer(device, physicalDevice, readbackSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, VK_MEMORY_PROPERTY_HOST_CACHED_BIT, slot.Readback))
+			return false;
+
+		VkCommandBufferAllocateInfo allocateInfo{};
+		allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		allocateInfo.commandPool = commandPool;
+		allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+		allocateInfo.commandBufferCount = 1;
+
+		VkFenceCreateInfo fenceInfo{};
+		fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+		if (vkAllocateCommandBuffers(device, &allocateInfo, &slot.CommandBuffer) != VK_SUCCESS ||
+			vkCreateFence(device, &fenceInfo, nullptr, &slot.Fence) != VK_SUCCESS)
+		{
+			std::cout << "Error: Couldn't create the tile command buffer!" << std::endl;
+			return false;
+		}
+
+		return true;
+	}
+
+	void TiledRenderer::DestroySlot(Slot& slot)
+	{
+		vkDestroyFence(device, slot.Fence, nullptr);
+		vkDestroyFramebuffer(device, slot.Framebuffer, nullptr);
+		DestroyBuffer(device, slot.Readback);
+		DestroyAttachment(device, slot.Color);
+		DestroyAttachment(device, slot.Depth);
+		DestroyAttachment(device, slot.Resolved);
+	}
+
+	Tile TiledRenderer::GetTile(uint32_t index) const
+	{
+		Tile tile;
+		tile.Index = index;
+		tile.Slot = index % uint32_t(slots.size());
+
+		uint32_t x = (index % tilesX) * tileExtent.width;
+		uint32_t y = (index / tilesX) * tileExtent.height;
+		tile.Offset = { int32_t(x), int32_t(y) };
+		tile.Extent = { std::min(tileExtent.width, specification.Extent.width - x), std::min(tileExtent.height, specification.Extent.height - y) };
+
+		// Maps the tile's range of the image's clip space onto -1 to 1. Both axes run from the top left,
+		// like framebuffer coordinates, once the projection has flipped y for Vulkan.
+		glm::vec2 imageSize(float(specification.Extent.width), float(specification.Extent.height));
+		glm::vec2 tileSize(float(tile.Extent.width), float(tile.Extent.height));
+		glm::vec2 tileCenter = (glm::vec2(float(x), float(y)) + 0.5f * tileSize) / imageSize * 2.0f - 1.0f;
+		glm::vec2 scale = imageSize / tileSize;
+
+		tile.ProjectionOffset = glm::mat4(1.0f);
+		tile.ProjectionOffset[0][0] = scale.x;
+		tile.ProjectionOffset[1][1] = scale.y;
+		tile.ProjectionOffset[3][0] = -scale.x * tileCenter.x;
+		tile.ProjectionOffset[3][1] = -scale.y * tileCenter.y;
+		return tile;
+	}
+
+	void TiledRenderer::RecordTile(Slot& slot, const Tile& tile, const RecordFunction& recordPrepare, const RecordFunction& recordDraw)
+	{
+		const DeviceDispatch& dispatch = GetDeviceDispatch();
+
+		VkCommandBuffer commandBuffer = slot.CommandBuffer;
+		dispatch.ResetCommandBuffer(commandBuffer, 0);
+
+		VkCommandBufferBeginInfo beginInfo{};
+		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+		dispatch.BeginCommandBuffer(commandBuffer, &beginInfo);
+
+		if (recordPrepare)
+			recordPrepare(commandBuffer, tile);
+
+		std::array<VkClearValue, 2> clearValues{};
+		clearValues[0].color = { { 0.0f, 0.0f, 0.0f, 1.0f } };
+		clearValues[1].depthStencil = { 1.0f, 0 };
+
+		VkRenderPassBeginInfo renderPassBeginInfo{};
+		renderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+		renderPassBeginInfo.renderPass = renderPass;
+		renderPassBeginInfo.framebuffer = slot.Framebuffer;
+		renderPassBeginInfo.renderArea.offset = { 0, 0 };
+		renderPassBeginInfo.renderArea.extent = tile.Extent;
+		renderPassBeginInfo.clearValueCount = uint32_t(clearValues.size());
+		renderPassBeginInfo.pClearValues = clearValues.data();
+
+		dispatch.CmdBeginRenderPass(commandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+
+		VkViewport viewport{};
+		viewport.width = float(tile.Extent.width);
+		viewport.height = float(tile.Extent.height);
+		viewport.maxDepth = 1.0f;
+		dispatch.CmdSetViewport(commandBuffer, 0, 1, &viewport);
+
+		VkRect2D scissor{};
+		scissor.extent = tile.Extent;
+		dispatch.CmdSetScissor(commandBuffer, 0, 1, &scissor);
+
+		recordDraw(commandBuffer, tile);
+
+		dispatch.CmdEndRenderPass(commandBuffer);
+
+		VkBufferImageCopy region{};
+		region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+		region.imageExtent = { tile.Extent.width, tile.Extent.height, 1 };
+		dispatch.CmdCopyImageToBuffer(commandBuffer, slot.Resolved.Image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, slot.Readback.Handle, 1, &region);
+
+		VkMemoryBarrier toHost{};
+		toHost.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		toHost.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		toHost.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+		dispatch.CmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 1, &toHost, 0, nullptr, 0, nullptr);
+
+		dispatch.EndCommandBuffer(commandBuffer);
+
+		VkSubmitInfo submitInfo{};
+		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submitInfo.commandBufferCount = 1;
+		submitInfo.pCommandBuffers = &commandBuffer;
+
+		dispatch.ResetFences(device, 1, &slot.Fence);
+		if (dispatch.QueueSubmit(queue, 1, &submitInfo, slot.Fence) != VK_SUCCESS)
+		{
+			std::cout << "Error: Couldn't submit tile " << tile.Index << "!" << std::endl;
+			std::lock_guard<std::mutex> lock(writeMutex);
+			writeFailed = true;
+			return;
+		}
+
+		slot.PendingTile = tile;
+		slot.Submitted = true;
+	}
+
+	void TiledRenderer::CollectTile(Slot& slot, bool wait)
+	{
+		const DeviceDispatch& dispatch = GetDeviceDispatch();
+
+		if (!slot.Submitted)
+			return;
+
+		if (wait)
+			dispatch.WaitForFences(device, 1, &slot.Fence, VK_TRUE, UINT64_MAX);
+		else if (dispatch.GetFenceStatus(device, slot.Fence) != VK_SUCCESS)
+			return;
+
+		InvalidateBuffer(device, slot.Readback);
+		slot.Submitted = false;
+		{
+			std::lock_guard<std::mutex> lock(writeMutex);
+			slot.Writing = true;
+		}
+
+		Slot* writtenSlot = &slot;
+		writer->Submit([this, writtenSlot]() {
+			const Tile& tile = writtenSlot->PendingTile;
+			bool written = output.WriteRegion(uint32_t(tile.Offset.x), uint32_t(tile.Offset.y), tile.Extent.width, tile.Extent.height,
+				(const uint8_t*)writtenSlot->Readback.Mapped, swapRedBlue);
+
+			std::lock_guard<std::mutex> lock(writeMutex);
+			writeFailed |= !written;
+			stats.BytesWritten += uint64_t(tile.Extent.width) * tile.Extent.height * 3;
+			writtenSlot->Writing = false;
+			tileWritten.notify_all();
+		});
+	}
+
+	void TiledRenderer::WaitForWrite(Slot& slot)
+	{
+		std::unique_lock<std::mutex> lock(writeMutex);
+		tileWritten.wait(lock, [&slot]() { return !slot.Writing; });
+	}
+
+}
@@ -0,0 +1,139 @@
+#pragma once
+
+#include "Core/ImageWriter.h"
+#include "Core/ThreadPool.h"
+#include "Renderer/Attachment.h"
+#include "Renderer/Buffer.h"
+
+#include <vulkan/vulkan.h>
+#include <glm/glm.hpp>
+
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace LearningVK {
+
+	struct TiledRenderSpecification
+	{
+		// Size of the whole image, only limited by the disk
+		VkExtent2D Extent = { 0, 0 };
+		// Largest tile, clamped to the device's framebuffer and image limits
+		uint32_t TileSize = 4096;
+
+		// The render pass is compatible with any render pass using the same formats and samples: a color and a depth
+		// attachment, with a resolve attachment when multisampled
+		VkFormat ColorFormat = VK_FORMAT_UNDEFINED;
+		VkFormat DepthFormat = VK_FORMAT_UNDEFINED;
+		VkSampleCountFlagBits Samples = VK_SAMPLE_COUNT_1_BIT;
+
+		// Tiles in flight. While one tile renders, the ones before it are read back and written out.
+		uint32_t PoolSize = 2;
+
+		// Written as a binary PPM, 8-bit RGB formats are read as RGBA and BGR formats as BGRA
+		std::string OutputPath = "render.ppm";
+	};
+
+	struct Tile
+	{
+		uint32_t Index = 0;
+		// Pool slot the tile renders through, below the specification's PoolSize. The slot's previous tile has
+		// finished on the GPU by the time its next one is recorded, so per slot resources can be reused safely.
+		uint32_t Slot = 0;
+
+		VkOffset2D Offset = { 0, 0 };
+		VkExtent2D Extent = { 0, 0 };
+
+		// Scales and offsets clip space so the tile's part of the image fills the viewport,
+		// the tile's projection is ProjectionOffset * projection
+		glm::mat4 ProjectionOffset = glm::mat4(1.0f);
+	};
+
+	struct TiledRenderStats
+	{
+		uint32_t TileCount = 0;
+		VkExtent2D TileExtent = { 0, 0 };
+		// Attachments and readback buffers of the pool, the same for any image size
+		VkDeviceSize PoolMemory = 0;
+		uint64_t BytesWritten = 0;
+		double Seconds = 0.0;
+	};
+
+	// Renders images larger than any framebuffer, or than memory, by splitting them into tiles. Every tile is
+	// rendered through a small fixed pool of attachments, read back and streamed to the output file on a writer
+	// thread while the next tiles render, so memory use doesn't grow with the image.
+	class TiledRenderer
+	{
+	public:
+		// Records outside of the render pass, like culling, or inside of it with the viewport and scissor set
+		using RecordFunction = std::function<void(VkCommandBuffer, const Tile&)>;
+
+		TiledRenderer(VkDevice device, VkPhysicalDevice physicalDevice, VkQueue queue, uint32_t queueFamily, const TiledRenderSpecification& specification);
+		~TiledRenderer();
+
+		TiledRenderer(const TiledRenderer&) = delete;
+		TiledRenderer& operator=(const TiledRenderer&) = delete;
+
+		// Renders every tile and blocks until the whole image is written. recordPrepare may be empty.
+		bool Render(const RecordFunction& recordPrepare, const RecordFunction& recordDraw);
+
+		VkRenderPass GetRenderPass() const { return renderPass; }
+		const TiledRenderStats& GetStats() const { return stats; }
+	private:
+		struct Slot
+		{
+			Attachment Color;
+			Attachment Depth;
+			// The single sampled color that's read back, the resolve target when multisampled
+			Attachment Resolved;
+			VkFramebuffer Framebuffer = VK_NULL_HANDLE;
+			Buffer Readback;
+
+			VkCommandBuffer CommandBuffer = VK_NULL_HANDLE;
+			VkFence Fence = VK_NULL_HANDLE;
+
+			Tile PendingTile;
+			// Submitted, but not handed to the writer yet
+			bool Submitted = false;
+			// Guarded by writeMutex
+			bool Writing = false;
+		};
+
+		bool CreateRenderPass();
+		bool CreateSlot(Slot& slot);
+		void DestroySlot(Slot& slot);
+
+		Tile GetTile(uint32_t index) const;
+		void RecordTile(Slot& slot, const Tile& tile, const RecordFunction& recordPrepare, const RecordFunction& recordDraw);
+
+		// Hands a submitted tile to the writer, waits for the GPU when wait is set
+		void CollectTile(Slot& slot, bool wait);
+		void WaitForWrite(Slot& slot);
+	private:
+		VkDevice device;
+		VkPhysicalDevice physicalDevice;
+		VkQueue queue;
+		TiledRenderSpecification specification;
+
+		VkExtent2D tileExtent = { 0, 0 };
+		uint32_t tilesX = 0;
+		uint32_t tilesY = 0;
+		bool swapRedBlue = false;
+
+		VkRenderPass renderPass = VK_NULL_HANDLE;
+		VkCommandPool commandPool = VK_NULL_HANDLE;
+		std::vector<std::unique_ptr<Slot>> slots;
+
+		PPMStream output;
+		bool writeFailed = false;
+		std::unique_ptr<ThreadPool> writer;
+		std::mutex writeMutex;
+		std::condition_variable tileWritten;
+
+		TiledRenderStats stats;
+	};
+
+}
@@ -0,0 +1,126 @@
+#include <vkpch.h>
+
+#include "Upload.h"
+#include "DeviceDispatch.h"
+
+#include <cstring>
+#include <iostream>
+
+namespace LearningVK
+{
+
+	void SubmitImmediate(VkDevice device, VkQueue queue, VkCommandPool commandPool, const std::function<void(VkCommandBuffer)>& record)
+	{
+		const DeviceDispatch& dispatch = GetDeviceDispatch();
+
+		VkCommandBufferAllocateInfo allocateInfo{};
+		allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		allocateInfo.commandPool = commandPool;
+		allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+		allocateInfo.commandBufferCount = 1;
+
+		VkCommandBuffer commandBuffer;
+		vkAllocateCommandBuffers(device, &allocateInfo, &commandBuffer);
+
+		VkCommandBufferBeginInfo beginInfo{};
+		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+		dispatch.BeginCommandBuffer(commandBuffer, &beginInfo);
+		record(commandBuffer);
+		dispatch.EndCommandBuffer(commandBuffer);
+
+		VkFenceCreateInfo fenceInfo{};
+		fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+		VkFence fence;
+		vkCreateFence(device, &fenceInfo, nullptr, &fence);
+
+		VkSubmitInfo submitInfo{};
+		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submitInfo.commandBufferCount = 1;
+		submitInfo.pCommandBuffers = &commandBuffer;
+
+		if (dispatch.QueueSubmit(queue, 1, &submitInfo, fence) != VK_SUCCESS)
+			std::cout << "Error: Couldn't submit immediate commands!" << std::endl;
+		else
+			dispatch.WaitForFences(device, 1, &fence, VK_TRUE, UINT64_MAX);
+
+		vkDestroyFence(device, fence, nullptr);
+		vkFreeCommandBuffers(device, commandPool, 1, &commandBuffer);
+	}
+
+	bool UploadBuffer(VkDevice device, VkPhysicalDevice physicalDevice, VkQueue queue, VkCommandPool commandPool,
+		const Buffer& destination, const void* data, VkDeviceSize size, VkDeviceSize offset)
+	{
+		const DeviceDispatch& dispatch = GetDeviceDispatch();
+
+		Buffer staging;
+		if (!CreateBuffer(device, physicalDevice, size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 0, staging))
+			return false;
+
+		std::memcpy(staging.Mapped, data, size_t(size));
+
+		SubmitImmediate(device, queue, commandPool, [&](VkCommandBuffer commandBuffer) {
+			VkBufferCopy region{};
+			region.srcOffset = 0;
+			region.dstOffset = offset;
+			region.size = size;
+			dispatch.CmdCopyBuffer(commandBuffer, staging.Handle, destination.Handle, 1, &region);
+		});
+
+		DestroyBuffer(device, staging);
+		return true;
+	}
+
+	bool UploadTexture(VkDevice device, VkPhysicalDevice physicalDevice, VkQueue queue, VkCommandPool commandPool,
+		const Texture& texture, uint32_t mipLevel, const void* data, VkDeviceSize size)
+	{
+		const DeviceDispatch& dispatch = GetDeviceDispatch();
+
+		Buffer staging;
+		if (!CreateBuffer(device, physicalDevice, size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 0, staging))
+			return false;
+
+		std::memcpy(staging.Mapped, data, size_t(size));
+
+		SubmitImmediate(device, queue, commandPool, [&](VkCommandBuffer commandBuffer) {
+			VkImageMemoryBarrier barrier{};
+			barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+			barrier.srcAccessMask = 0;
+			barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+			barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+			barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.image = texture.Image;
+			barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, mipLevel, 1, 0, 1 };
+
+			dispatch.CmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+				0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+			VkBufferImageCopy region{};
+			region.bufferOffset = 0;
+			region.bufferRowLength = 0;
+			region.bufferImageHeight = 0;
+			region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, mipLevel, 0, 1 };
+			region.imageOffset = { 0, 0, 0 };
+			region.imageExtent = { std::max(texture.Extent.width >> mipLevel, 1u), std::max(texture.Extent.height >> mipLevel, 1u), 1 };
+			dispatch.CmdCopyBufferToImage(commandBuffer, staging.Handle, texture.Image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+			barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+			barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+			barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+			dispatch.CmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+				0, 0, nullptr, 0, nullptr, 1, &barrier);
+		});
+
+		DestroyBuffer(device, staging);
+		return true;
+	}
+
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "Renderer/Buffer.h"
+#include "Renderer/Texture.h"
+
+#include <vulkan/vulkan.h>
+
+#include <functional>
+
+namespace LearningVK {
+
+	// Records one-off commands, submits them and waits for them to finish. This blocks, so it's
+	// only meant for loading and initialisation.
+	void SubmitImmediate(VkDevice device, VkQueue queue, VkCommandPool commandPool, const std::function<void(VkCommandBuffer)>& record);
+
+	// Copies data into a device local buffer through a temporary staging buffer
+	bool UploadBuffer(VkDevice device, VkPhysicalDevice physicalDevice, VkQueue queue, VkCommandPool commandPool,
+		const Buffer& destination, const void* data, VkDeviceSize size, VkDeviceSize offset = 0);
+
+	// Copies tightly packed texels into one mip level of a texture through a temporary staging buffer. Whatever the
+	// level held before is discarded, afterwards it's in VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL for fragment shaders.
+	bool UploadTexture(VkDevice device, VkPhysicalDevice physicalDevice, VkQueue queue, VkCommandPool commandPool,
+		const Texture& texture, uint32_t mipLevel, const void* data, VkDeviceSize size);
+
+}
@@ -17,4 +17,9 @@
 
 #include <memory>
 #include <algorithm>
-#include <functional>
\ No newline at end of file
+#include <functional>
+
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
\ No newline at end of file
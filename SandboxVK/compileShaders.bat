@@ -1,3 +1,2 @@
-C:/VulkanSDK/1.3.261.1/Bin/glslc.exe res/shader.vert -o res/vert.spv
-C:/VulkanSDK/1.3.261.1/Bin/glslc.exe res/shader.frag -o res/frag.spv
+call ..\Vendor\premake\premake5.exe --file=../premake5.lua shaders
 pause
\ No newline at end of file
@@ -0,0 +1,78 @@
+// Shared by the clustered lighting shaders, the layouts and constants must match ClusteredLighting.h.
+// Define LIGHTING_DATA_BINDING before including it.
+
+// The view frustum is split into a grid of clusters: tiles across the screen and exponential slices in depth,
+// so slices close to the camera stay thin
+const uint CLUSTER_GRID_X = 16u;
+const uint CLUSTER_GRID_Y = 9u;
+const uint CLUSTER_GRID_Z = 24u;
+const uint CLUSTER_COUNT = CLUSTER_GRID_X * CLUSTER_GRID_Y * CLUSTER_GRID_Z;
+// Lights past this many are dropped from a cluster
+const uint MAX_LIGHTS_PER_CLUSTER = 128u;
+
+struct PointLight {
+    // World space position and radius of influence
+    vec4 positionRadius;
+    // Color and intensity
+    vec4 colorIntensity;
+};
+
+// Range of the cluster's lights in the light index list
+struct LightCluster {
+    uint offset;
+    uint count;
+};
+
+layout(std140, set = 0, binding = LIGHTING_DATA_BINDING) uniform LightingData {
+    mat4 view;
+    mat4 inverseProjection;
+    vec2 screenSize;
+    float nearPlane;
+    float farPlane;
+    uint lightCount;
+} lighting;
+
+// View space distance of a depth buffer value, for a 0 to 1 depth range
+float LinearizeDepth(float depth) {
+    return lighting.nearPlane * lighting.farPlane / (lighting.farPlane - depth * (lighting.farPlane - lighting.nearPlane));
+}
+
+uint GetClusterIndex(vec2 fragCoord, float viewDepth) {
+    uvec2 tile = min(uvec2(fragCoord / lighting.screenSize * vec2(CLUSTER_GRID_X, CLUSTER_GRID_Y)), uvec2(CLUSTER_GRID_X - 1u, CLUSTER_GRID_Y - 1u));
+    float slice = log(viewDepth / lighting.nearPlane) / log(lighting.farPlane / lighting.nearPlane) * float(CLUSTER_GRID_Z);
+    uint z = uint(clamp(slice, 0.0, float(CLUSTER_GRID_Z - 1u)));
+    return tile.x + tile.y * CLUSTER_GRID_X + z * CLUSTER_GRID_X * CLUSTER_GRID_Y;
+}
+
+// View space bounding box of a cluster
+void GetClusterBounds(uint clusterIndex, out vec3 minBound, out vec3 maxBound) {
+    uint x = clusterIndex % CLUSTER_GRID_X;
+    uint y = (clusterIndex / CLUSTER_GRID_X) % CLUSTER_GRID_Y;
+    uint z = clusterIndex / (CLUSTER_GRID_X * CLUSTER_GRID_Y);
+
+    // The tile's corners on the near plane
+    vec2 gridSize = vec2(CLUSTER_GRID_X, CLUSTER_GRID_Y);
+    vec4 nearMin = lighting.inverseProjection * vec4(vec2(x, y) / gridSize * 2.0 - 1.0, 0.0, 1.0);
+    vec4 nearMax = lighting.inverseProjection * vec4(vec2(x + 1u, y + 1u) / gridSize * 2.0 - 1.0, 0.0, 1.0);
+    vec3 cornerMin = nearMin.xyz / nearMin.w;
+    vec3 cornerMax = nearMax.xyz / nearMax.w;
+
+    float depthRatio = lighting.farPlane / lighting.nearPlane;
+    float sliceNear = lighting.nearPlane * pow(depthRatio, float(z) / float(CLUSTER_GRID_Z));
+    float sliceFar = lighting.nearPlane * pow(depthRatio, float(z + 1u) / float(CLUSTER_GRID_Z));
+
+    // Slides the corners along their view rays onto both slice planes, view space looks down -z
+    vec3 minNear = cornerMin * (sliceNear / -cornerMin.z);
+    vec3 minFar = cornerMin * (sliceFar / -cornerMin.z);
+    vec3 maxNear = cornerMax * (sliceNear / -cornerMax.z);
+    vec3 maxFar = cornerMax * (sliceFar / -cornerMax.z);
+
+    minBound = min(min(minNear, minFar), min(maxNear, maxFar));
+    maxBound = max(max(minNear, minFar), max(maxNear, maxFar));
+}
+
+bool SphereIntersectsBox(vec4 sphere, vec3 minBound, vec3 maxBound) {
+    vec3 closest = clamp(sphere.xyz, minBound, maxBound);
+    vec3 offset = closest - sphere.xyz;
+    return dot(offset, offset) <= sphere.w * sphere.w;
+}
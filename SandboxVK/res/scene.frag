@@ -0,0 +1,53 @@
+#version 450
+#extension GL_GOOGLE_include_directive : require
+
+#define LIGHTING_DATA_BINDING 2
+#include "lighting.glsl"
+
+layout(location = 0) in vec3 fragNormal;
+layout(location = 1) in vec3 fragColor;
+layout(location = 2) in vec3 fragWorldPosition;
+
+layout(location = 0) out vec4 outColor;
+
+layout(std430, set = 0, binding = 3) readonly buffer Lights {
+    PointLight lights[];
+};
+
+layout(std430, set = 0, binding = 4) readonly buffer Clusters {
+    LightCluster clusters[];
+};
+
+layout(std430, set = 0, binding = 5) readonly buffer LightIndices {
+    uint lightIndices[];
+};
+
+const vec3 LIGHT_DIRECTION = normalize(vec3(0.4, 1.0, 0.3));
+const float SUN_INTENSITY = 0.3;
+const float AMBIENT = 0.1;
+
+void main() {
+    vec3 normal = normalize(fragNormal);
+    vec3 light = vec3(AMBIENT + SUN_INTENSITY * max(dot(normal, LIGHT_DIRECTION), 0.0));
+
+    // Only the lights assigned to this fragment's cluster can reach it
+    LightCluster cluster = clusters[GetClusterIndex(gl_FragCoord.xy, LinearizeDepth(gl_FragCoord.z))];
+    for (uint i = 0u; i < cluster.count; i++) {
+        PointLight pointLight = lights[lightIndices[cluster.offset + i]];
+
+        vec3 toLight = pointLight.positionRadius.xyz - fragWorldPosition;
+        float distance = length(toLight);
+        float radius = pointLight.positionRadius.w;
+        if (distance >= radius)
+            continue;
+
+        // Inverse square falloff windowed to reach zero at the radius
+        float window = clamp(1.0 - pow(distance / radius, 4.0), 0.0, 1.0);
+        float attenuation = window * window / (distance * distance + 1.0);
+
+        float diffuse = max(dot(normal, toLight / distance), 0.0);
+        light += pointLight.colorIntensity.rgb * pointLight.colorIntensity.a * diffuse * attenuation;
+    }
+
+    outColor = vec4(fragColor * light, 1.0);
+}
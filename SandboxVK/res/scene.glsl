@@ -0,0 +1,51 @@
+// Shared by the scene and culling shaders, the layouts must match Scene.h and SceneRenderer.h
+
+struct ObjectData {
+    mat4 model;
+    // World space center and radius
+    vec4 boundingSphere;
+    vec4 color;
+    uint meshIndex;
+    uint padding0;
+    uint padding1;
+    uint padding2;
+};
+
+const uint MAX_MESH_LODS = 6u;
+
+struct MeshLod {
+    uint firstIndex;
+    uint indexCount;
+    // Bound on how far the LOD's surface is from the full detail mesh, in mesh units
+    float error;
+    uint padding;
+};
+
+// LOD 0 is the full detail mesh, every LOD indexes the same vertices
+struct MeshData {
+    int vertexOffset;
+    uint lodCount;
+    uint padding0;
+    uint padding1;
+    MeshLod lods[MAX_MESH_LODS];
+};
+
+layout(std140, set = 0, binding = 0) uniform FrameData {
+    mat4 viewProjection;
+    mat4 previousViewProjection;
+    vec4 frustumPlanes[6];
+    vec4 cameraPosition;
+    vec2 pyramidSize;
+    uint objectCount;
+    uint occlusionCulling;
+    // Set when the pyramid was built last frame at the current size
+    uint pyramidValid;
+    // Pixels covered by one world unit at a distance of one, 0 always picks LOD 0
+    float lodScale;
+    // Largest error in pixels a LOD can have on screen
+    float lodThreshold;
+} frame;
+
+layout(std430, set = 0, binding = 1) readonly buffer Objects {
+    ObjectData objects[];
+};
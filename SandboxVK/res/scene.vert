@@ -0,0 +1,25 @@
+#version 450
+#extension GL_GOOGLE_include_directive : require
+
+#include "scene.glsl"
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec3 inNormal;
+layout(location = 2) in vec2 inUV;
+
+layout(location = 0) out vec3 fragNormal;
+layout(location = 1) out vec3 fragColor;
+layout(location = 2) out vec3 fragWorldPosition;
+
+void main() {
+    // The culling pass stores the object index in firstInstance
+    ObjectData object = objects[gl_InstanceIndex];
+
+    vec4 worldPosition = object.model * vec4(inPosition, 1.0);
+    gl_Position = frame.viewProjection * worldPosition;
+
+    // Objects are only scaled along their own axes, so the model matrix keeps the normals' directions
+    fragNormal = mat3(object.model) * inNormal;
+    fragColor = object.color.rgb;
+    fragWorldPosition = worldPosition.xyz;
+}
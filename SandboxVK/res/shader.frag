@@ -1,10 +1,16 @@
 #version 450
 
+// Baked in through VkSpecializationInfo, so the multiply folds away when it's 1.0
+layout(constant_id = 0) const float BRIGHTNESS = 1.0;
+
 layout(location = 0) in vec3 fragColor;
 
 layout(location = 0) out vec4 outColor;
 
 void main() {
-    outColor = vec4(fragColor, 1.0);
-    outColor = vec4(1.0, 1.0, 1.0, 1.0);
+#ifdef FEATURE_VERTEX_COLOR
+    outColor = vec4(fragColor * BRIGHTNESS, 1.0);
+#else
+    outColor = vec4(vec3(BRIGHTNESS), 1.0);
+#endif
 }
\ No newline at end of file
@@ -0,0 +1,13 @@
+#version 450
+
+// Single channel coverage, the color comes from the vertices
+layout(binding = 0) uniform sampler2D coverage;
+
+layout(location = 0) in vec2 fragUV;
+layout(location = 1) in vec4 fragColor;
+
+layout(location = 0) out vec4 outColor;
+
+void main() {
+    outColor = vec4(fragColor.rgb, fragColor.a * texture(coverage, fragUV).r);
+}
@@ -0,0 +1,348 @@
+#include "ClusteredLighting.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <random>
+
+// Same as GetClusterBounds in lighting.glsl
+static void GetClusterBounds(const LightingData& data, uint32_t clusterIndex, glm::vec3& minBound, glm::vec3& maxBound)
+{
+    uint32_t x = clusterIndex % ClusterGridX;
+    uint32_t y = (clusterIndex / ClusterGridX) % ClusterGridY;
+    uint32_t z = clusterIndex / (ClusterGridX * ClusterGridY);
+
+    glm::vec2 gridSize = glm::vec2(float(ClusterGridX), float(ClusterGridY));
+    glm::vec4 nearMin = data.InverseProjection * glm::vec4(glm::vec2(float(x), float(y)) / gridSize * 2.0f - 1.0f, 0.0f, 1.0f);
+    glm::vec4 nearMax = data.InverseProjection * glm::vec4(glm::vec2(float(x + 1), float(y + 1)) / gridSize * 2.0f - 1.0f, 0.0f, 1.0f);
+    glm::vec3 cornerMin = glm::vec3(nearMin.x, nearMin.y, nearMin.z) / nearMin.w;
+    glm::vec3 cornerMax = glm::vec3(nearMax.x, nearMax.y, nearMax.z) / nearMax.w;
+
+    float depthRatio = data.FarPlane / data.NearPlane;
+    float sliceNear = data.NearPlane * std::pow(depthRatio, float(z) / float(ClusterGridZ));
+    float sliceFar = data.NearPlane * std::pow(depthRatio, float(z + 1) / float(ClusterGridZ));
+
+    glm::vec3 minNear = cornerMin * (sliceNear / -cornerMin.z);
+    glm::vec3 minFar = cornerMin * (sliceFar / -cornerMin.z);
+    glm::vec3 maxNear = cornerMax * (sliceNear / -cornerMax.z);
+    glm::vec3 maxFar = cornerMax * (sliceFar / -cornerMax.z);
+
+    minBound = glm::min(glm::min(minNear, minFar), glm::min(maxNear, maxFar));
+    maxBound = glm::max(glm::max(minNear, minFar), glm::max(maxNear, maxFar));
+}
+
+static bool SphereIntersectsBox(const glm::vec4& sphere, const glm::vec3& minBound, const glm::vec3& maxBound)
+{
+    glm::vec3 center(sphere.x, sphere.y, sphere.z);
+    glm::vec3 offset = glm::clamp(center, minBound, maxBound) - center;
+    return glm::dot(offset, offset) <= sphere.w * sphere.w;
+}
+
+LightAssignment AssignLightsReference(const LightingData& data, const std::vector<PointLight>& lights)
+{
+    uint32_t lightCount = std::min(data.LightCount, uint32_t(lights.size()));
+
+    std::vector<glm::vec4> viewLights(lightCount);
+    for (uint32_t i = 0; i < lightCount; i++)
+    {
+        const glm::vec4& light = lights[i].PositionRadius;
+        glm::vec4 position = data.View * glm::vec4(light.x, light.y, light.z, 1.0f);
+        viewLights[i] = glm::vec4(position.x, position.y, position.z, light.w);
+    }
+
+    LightAssignment assignment;
+    assignment.Clusters.resize(ClusterCount);
+    for (uint32_t clusterIndex = 0; clusterIndex < ClusterCount; clusterIndex++)
+    {
+        glm::vec3 minBound, maxBound;
+        GetClusterBounds(data, clusterIndex, minBound, maxBound);
+
+        LightCluster& cluster = assignment.Clusters[clusterIndex];
+        cluster.Offset = uint32_t(assignment.LightIndices.size());
+        cluster.Count = 0;
+
+        for (uint32_t i = 0; i < lightCount && cluster.Count < MaxLightsPerCluster; i++)
+        {
+            if (SphereIntersectsBox(viewLights[i], minBound, maxBound))
+            {
+                assignment.LightIndices.push_back(i);
+                cluster.Count++;
+            }
+        }
+    }
+
+    return assignment;
+}
+
+void ClusteredLighting::Init(const ClusteredLightingSpecification& specification)
+{
+    this->specification = specification;
+    lightCount = std::min(specification.LightCount, specification.MaxLights);
+
+    CreateLights();
+    CreateBuffers();
+    CreatePipeline();
+    CreateDescriptorSets();
+}
+
+void ClusteredLighting::Shutdown()
+{
+    VkDevice device = specification.Device;
+
+    vkDestroyDescriptorPool(device, descriptorPool, nullptr);
+    LearningVK::DestroyComputePipeline(device, assignPipeline);
+
+    for (FrameResources& frame : frames)
+    {
+        LearningVK::DestroyBuffer(device, frame.LightingData);
+        LearningVK::DestroyBuffer(device, frame.Lights);
+        LearningVK::DestroyBuffer(device, frame.Clusters);
+        LearningVK::DestroyBuffer(device, frame.LightIndices);
+        LearningVK::DestroyBuffer(device, frame.IndexCount);
+    }
+}
+
+void ClusteredLighting::RecreatePipeline(LearningVK::DeletionQueue& deletionQueue, uint64_t frameNumber)
+{
+    VkDevice device = specification.Device;
+    LearningVK::ComputePipeline oldPipeline = assignPipeline;
+    VkDescriptorPool oldPool = descriptorPool;
+    deletionQueue.Push(frameNumber, [=]() mutable {
+        vkDestroyDescriptorPool(device, oldPool, nullptr);
+        LearningVK::DestroyComputePipeline(device, oldPipeline);
+    });
+
+    // The sets were allocated from the old set layout
+    CreatePipeline();
+    CreateDescriptorSets();
+}
+
+void ClusteredLighting::SetLightCount(uint32_t count)
+{
+    lightCount = std::min(count, specification.MaxLights);
+}
+
+void ClusteredLighting::Update(uint32_t frameSlot, float time, const glm::mat4& view, const glm::mat4& projection, float nearPlane, float farPlane, VkExtent2D extent)
+{
+    for (uint32_t i = 0; i < lightCount; i++)
+    {
+        const LightMotion& motion = motions[i];
+        float angle = time * motion.Speed + motion.Phase;
+        glm::vec3 position = motion.Center + motion.OrbitRadius * glm::vec3(std::cos(angle), 0.0f, std::sin(angle));
+        lights[i].PositionRadius = glm::vec4(position, lights[i].PositionRadius.w);
+    }
+
+    lightingData.View = view;
+    lightingData.InverseProjection = glm::inverse(projection);
+    lightingData.ScreenSize = glm::vec2(float(extent.width), float(extent.height));
+    lightingData.NearPlane = nearPlane;
+    lightingData.FarPlane = farPlane;
+    lightingData.LightCount = lightCount;
+
+    FrameResources& frame = frames[frameSlot];
+    std::memcpy(frame.LightingData.Mapped, &lightingData, sizeof(lightingData));
+    std::memcpy(frame.Lights.Mapped, lights.data(), sizeof(PointLight) * lightCount);
+    LearningVK::FlushBuffer(specification.Device, frame.LightingData);
+    LearningVK::FlushBuffer(specification.Device, frame.Lights);
+}
+
+void ClusteredLighting::RecordAssignment(VkCommandBuffer commandBuffer, uint32_t frameSlot)
+{
+    const LearningVK::DeviceDispatch& dispatch = LearningVK::GetDeviceDispatch();
+
+    const FrameResources& frame = frames[frameSlot];
+
+    dispatch.CmdFillBuffer(commandBuffer, frame.IndexCount.Handle, 0, VK_WHOLE_SIZE, 0);
+
+    VkMemoryBarrier countCleared{};
+    countCleared.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    countCleared.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    countCleared.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    dispatch.CmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &countCleared, 0, nullptr, 0, nullptr);
+
+    dispatch.CmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, assignPipeline.Pipeline);
+    dispatch.CmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, assignPipeline.Layout, 0, 1, &frame.DescriptorSet, 0, nullptr);
+    dispatch.CmdDispatch(commandBuffer, (ClusterCount + 63) / 64, 1, 1);
+
+    VkMemoryBarrier assigned{};
+    assigned.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    assigned.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    assigned.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    dispatch.CmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 1, &assigned, 0, nullptr, 0, nullptr);
+}
+
+LightAssignment ClusteredLighting::ReadAssignment(uint32_t frameSlot)
+{
+    const LearningVK::DeviceDispatch& dispatch = LearningVK::GetDeviceDispatch();
+
+    VkDevice device = specification.Device;
+    const FrameResources& frame = frames[frameSlot];
+
+    LearningVK::Buffer staging;
+    VkDeviceSize clustersSize = frame.Clusters.Size;
+    VkDeviceSize indicesSize = frame.LightIndices.Size;
+    if (!LearningVK::CreateBuffer(device, specification.PhysicalDevice, sizeof(uint32_t) + clustersSize + indicesSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, VK_MEMORY_PROPERTY_HOST_CACHED_BIT, staging))
+        return {};
+
+    LearningVK::SubmitImmediate(device, specification.Queue, specification.CommandPool, [&](VkCommandBuffer commandBuffer) {
+        // Waits for the fragment shaders too, a frame may still be reading the buffers
+        VkMemoryBarrier written{};
+        written.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        written.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        written.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        dispatch.CmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+            0, 1, &written, 0, nullptr, 0, nullptr);
+
+        VkBufferCopy countRegion{ 0, 0, sizeof(uint32_t) };
+        VkBufferCopy clustersRegion{ 0, sizeof(uint32_t), clustersSize };
+        VkBufferCopy indicesRegion{ 0, sizeof(uint32_t) + clustersSize, indicesSize };
+        dispatch.CmdCopyBuffer(commandBuffer, frame.IndexCount.Handle, staging.Handle, 1, &countRegion);
+        dispatch.CmdCopyBuffer(commandBuffer, frame.Clusters.Handle, staging.Handle, 1, &clustersRegion);
+        dispatch.CmdCopyBuffer(commandBuffer, frame.LightIndices.Handle, staging.Handle, 1, &indicesRegion);
+
+        VkMemoryBarrier copied{};
+        copied.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        copied.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        copied.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+        dispatch.CmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 1, &copied, 0, nullptr, 0, nullptr);
+    });
+    LearningVK::InvalidateBuffer(device, staging);
+
+    const uint8_t* data = (const uint8_t*)staging.Mapped;
+    uint32_t indexCount;
+    std::memcpy(&indexCount, data, sizeof(uint32_t));
+
+    LightAssignment assignment;
+    assignment.Clusters.resize(ClusterCount);
+    assignment.LightIndices.resize(std::min<VkDeviceSize>(indexCount, indicesSize / sizeof(uint32_t)));
+    std::memcpy(assignment.Clusters.data(), data + sizeof(uint32_t), clustersSize);
+    std::memcpy(assignment.LightIndices.data(), data + sizeof(uint32_t) + clustersSize, assignment.LightIndices.size() * sizeof(uint32_t));
+
+    LearningVK::DestroyBuffer(device, staging);
+    return assignment;
+}
+
+void ClusteredLighting::CreateLights()
+{
+    std::mt19937 random(7);
+    std::uniform_real_distribution<float> x(specification.BoundsMin.x, specification.BoundsMax.x);
+    std::uniform_real_distribution<float> y(specification.BoundsMin.y, specification.BoundsMax.y);
+    std::uniform_real_distribution<float> z(specification.BoundsMin.z, specification.BoundsMax.z);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+    motions.resize(specification.MaxLights);
+    lights.resize(specification.MaxLights);
+    for (uint32_t i = 0; i < specification.MaxLights; i++)
+    {
+        LightMotion& motion = motions[i];
+        motion.Center = glm::vec3(x(random), y(random), z(random));
+        motion.OrbitRadius = 0.5f + 2.0f * unit(random);
+        motion.Speed = (unit(random) < 0.5f ? -1.0f : 1.0f) * (0.2f + unit(random));
+        motion.Phase = 2.0f * 3.14159265f * unit(random);
+
+        glm::vec3 color(0.3f + 0.7f * unit(random), 0.3f + 0.7f * unit(random), 0.3f + 0.7f * unit(random));
+        lights[i].PositionRadius = glm::vec4(motion.Center, 2.0f + 1.5f * unit(random));
+        lights[i].ColorIntensity = glm::vec4(color, 2.0f);
+    }
+}
+
+void ClusteredLighting::CreateBuffers()
+{
+    VkDevice device = specification.Device;
+    VkPhysicalDevice physicalDevice = specification.PhysicalDevice;
+
+    frames.resize(specification.FramesInFlight);
+    for (FrameResources& frame : frames)
+    {
+        // Written by the CPU every frame
+        bool created = LearningVK::CreateBuffer(device, physicalDevice, sizeof(LightingData), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, frame.LightingData);
+        created &= LearningVK::CreateBuffer(device, physicalDevice, sizeof(PointLight) * specification.MaxLights, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, frame.Lights);
+
+        created &= LearningVK::CreateBuffer(device, physicalDevice, sizeof(LightCluster) * ClusterCount,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0, frame.Clusters);
+        // Room for every cluster to be full, so reserving a range never fails
+        created &= LearningVK::CreateBuffer(device, physicalDevice, sizeof(uint32_t) * ClusterCount * MaxLightsPerCluster,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0, frame.LightIndices);
+        created &= LearningVK::CreateBuffer(device, physicalDevice, sizeof(uint32_t),
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0, frame.IndexCount);
+
+        if (!created)
+            __debugbreak();
+    }
+}
+
+void ClusteredLighting::CreatePipeline()
+{
+    const LearningVK::ShaderVariant* assignShader = specification.Shaders->SelectVariant("light_assign.comp", 0);
+    if (!assignShader)
+    {
+        std::cout << "Error: Couldn't find the light assignment shader!" << std::endl;
+        __debugbreak();
+    }
+
+    LearningVK::ComputePipelineSpecification pipelineSpecification;
+    pipelineSpecification.Code = &assignShader->Code;
+    pipelineSpecification.Bindings = {
+        LearningVK::UniformBufferBinding(0),
+        LearningVK::StorageBufferBinding(1),
+        LearningVK::StorageBufferBinding(2),
+        LearningVK::StorageBufferBinding(3),
+        LearningVK::StorageBufferBinding(4)
+    };
+
+    if (!LearningVK::CreateComputePipeline(specification.Device, pipelineSpecification, assignPipeline))
+        __debugbreak();
+}
+
+void ClusteredLighting::CreateDescriptorSets()
+{
+    uint32_t frameCount = uint32_t(frames.size());
+    std::array<VkDescriptorPoolSize, 2> poolSizes = { {
+        { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, frameCount },
+        { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, frameCount * 4 }
+    } };
+
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.maxSets = frameCount;
+    poolInfo.poolSizeCount = uint32_t(poolSizes.size());
+    poolInfo.pPoolSizes = poolSizes.data();
+
+    if (vkCreateDescriptorPool(specification.Device, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS)
+    {
+        std::cout << "Error: Couldn't create the lighting descriptor pool!" << std::endl;
+        __debugbreak();
+    }
+
+    std::vector<VkDescriptorSetLayout> layouts(frameCount, assignPipeline.SetLayout);
+    std::vector<VkDescriptorSet> sets(frameCount);
+
+    VkDescriptorSetAllocateInfo allocateInfo{};
+    allocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocateInfo.descriptorPool = descriptorPool;
+    allocateInfo.descriptorSetCount = frameCount;
+    allocateInfo.pSetLayouts = layouts.data();
+
+    if (vkAllocateDescriptorSets(specification.Device, &allocateInfo, sets.data()) != VK_SUCCESS)
+    {
+        std::cout << "Error: Couldn't allocate the lighting descriptor sets!" << std::endl;
+        __debugbreak();
+    }
+
+    for (uint32_t i = 0; i < frameCount; i++)
+    {
+        FrameResources& frame = frames[i];
+        frame.DescriptorSet = sets[i];
+        LearningVK::DescriptorWriter(frame.DescriptorSet)
+            .WriteBuffer(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, frame.LightingData.Handle)
+            .WriteBuffer(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, frame.Lights.Handle)
+            .WriteBuffer(2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, frame.Clusters.Handle)
+            .WriteBuffer(3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, frame.LightIndices.Handle)
+            .WriteBuffer(4, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, frame.IndexCount.Handle)
+            .Update(specification.Device);
+    }
+}
@@ -0,0 +1,142 @@
+#pragma once
+
+#include "EngineVK.h"
+
+#include <vulkan/vulkan.h>
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+// Must match the constants in lighting.glsl
+const uint32_t ClusterGridX = 16;
+const uint32_t ClusterGridY = 9;
+const uint32_t ClusterGridZ = 24;
+const uint32_t ClusterCount = ClusterGridX * ClusterGridY * ClusterGridZ;
+const uint32_t MaxLightsPerCluster = 128;
+
+// Layout matches PointLight in lighting.glsl
+struct PointLight
+{
+    // World space position and radius of influence
+    glm::vec4 PositionRadius;
+    glm::vec4 ColorIntensity;
+};
+
+// Layout matches LightCluster in lighting.glsl
+struct LightCluster
+{
+    uint32_t Offset;
+    uint32_t Count;
+};
+
+// Layout matches LightingData in lighting.glsl
+struct LightingData
+{
+    glm::mat4 View;
+    glm::mat4 InverseProjection;
+    glm::vec2 ScreenSize;
+    float NearPlane;
+    float FarPlane;
+    uint32_t LightCount;
+    uint32_t Padding[3];
+};
+
+// The lights of every cluster, as a range of one compact index list
+struct LightAssignment
+{
+    std::vector<LightCluster> Clusters;
+    std::vector<uint32_t> LightIndices;
+};
+
+// CPU version of light_assign.comp, used to validate the GPU pass and as a baseline to benchmark it against.
+// Every cluster lists its lights in ascending order, like the GPU does, so both results compare cluster by cluster.
+LightAssignment AssignLightsReference(const LightingData& data, const std::vector<PointLight>& lights);
+
+struct ClusteredLightingSpecification
+{
+    VkDevice Device = VK_NULL_HANDLE;
+    VkPhysicalDevice PhysicalDevice = VK_NULL_HANDLE;
+    // Only used to read assignments back
+    VkQueue Queue = VK_NULL_HANDLE;
+    VkCommandPool CommandPool = VK_NULL_HANDLE;
+    const LearningVK::ShaderLibrary* Shaders = nullptr;
+
+    // The lights wander around inside this box
+    glm::vec3 BoundsMin = glm::vec3(-1.0f);
+    glm::vec3 BoundsMax = glm::vec3(1.0f);
+    uint32_t MaxLights = 16384;
+    uint32_t LightCount = 4096;
+
+    uint32_t FramesInFlight = 2;
+};
+
+// Clustered forward lighting: a compute pass assigns the lights to the clusters of the view frustum every frame,
+// then the fragment shader only evaluates the lights of the cluster it's in, so shading cost follows the local
+// light density rather than the total light count.
+class ClusteredLighting
+{
+public:
+    void Init(const ClusteredLightingSpecification& specification);
+    void Shutdown();
+
+    // Rebuilds the pipeline with the library's current shader
+    void RecreatePipeline(LearningVK::DeletionQueue& deletionQueue, uint64_t frameNumber);
+
+    // Clamped to the specification's MaxLights
+    void SetLightCount(uint32_t count);
+    uint32_t GetLightCount() const { return lightCount; }
+
+    // Animates the lights and writes them and the camera into the slot's buffers
+    void Update(uint32_t frameSlot, float time, const glm::mat4& view, const glm::mat4& projection, float nearPlane, float farPlane, VkExtent2D extent);
+
+    // Records the light assignment, outside of any render pass. The result is visible to fragment shaders.
+    void RecordAssignment(VkCommandBuffer commandBuffer, uint32_t frameSlot);
+
+    // Copies the slot's last assignment back, blocks until the GPU is done with it
+    LightAssignment ReadAssignment(uint32_t frameSlot);
+
+    // Inputs of the last Update, for the CPU reference
+    const LightingData& GetLightingData() const { return lightingData; }
+    const std::vector<PointLight>& GetLights() const { return lights; }
+
+    // Bound by the fragment shader next to the lights, clusters and light indices
+    const LearningVK::Buffer& GetLightingDataBuffer(uint32_t frameSlot) const { return frames[frameSlot].LightingData; }
+    const LearningVK::Buffer& GetLightBuffer(uint32_t frameSlot) const { return frames[frameSlot].Lights; }
+    const LearningVK::Buffer& GetClusterBuffer(uint32_t frameSlot) const { return frames[frameSlot].Clusters; }
+    const LearningVK::Buffer& GetLightIndexBuffer(uint32_t frameSlot) const { return frames[frameSlot].LightIndices; }
+private:
+    struct LightMotion
+    {
+        glm::vec3 Center;
+        float OrbitRadius;
+        float Speed;
+        float Phase;
+    };
+
+    struct FrameResources
+    {
+        LearningVK::Buffer LightingData;
+        LearningVK::Buffer Lights;
+        LearningVK::Buffer Clusters;
+        LearningVK::Buffer LightIndices;
+        LearningVK::Buffer IndexCount;
+        VkDescriptorSet DescriptorSet = VK_NULL_HANDLE;
+    };
+
+    void CreateLights();
+    void CreateBuffers();
+    void CreatePipeline();
+    void CreateDescriptorSets();
+private:
+    ClusteredLightingSpecification specification;
+    uint32_t lightCount = 0;
+
+    std::vector<LightMotion> motions;
+    std::vector<PointLight> lights;
+    LightingData lightingData{};
+
+    std::vector<FrameResources> frames;
+    LearningVK::ComputePipeline assignPipeline;
+    VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+};
@@ -0,0 +1,243 @@
+#include "MeshSimplifier.h"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <tuple>
+#include <unordered_map>
+
+// Sum of the squared distances to a set of planes, as the symmetric 4x4 matrix of their equations
+struct Quadric
+{
+    double XX = 0, XY = 0, XZ = 0, XW = 0;
+    double YY = 0, YZ = 0, YW = 0;
+    double ZZ = 0, ZW = 0;
+    double WW = 0;
+
+    void AddPlane(double a, double b, double c, double d)
+    {
+        XX += a * a; XY += a * b; XZ += a * c; XW += a * d;
+        YY += b * b; YZ += b * c; YW += b * d;
+        ZZ += c * c; ZW += c * d;
+        WW += d * d;
+    }
+
+    void Add(const Quadric& other)
+    {
+        XX += other.XX; XY += other.XY; XZ += other.XZ; XW += other.XW;
+        YY += other.YY; YZ += other.YZ; YW += other.YW;
+        ZZ += other.ZZ; ZW += other.ZW;
+        WW += other.WW;
+    }
+
+    double Evaluate(const glm::vec3& p) const
+    {
+        double x = p.x, y = p.y, z = p.z;
+        double error = XX * x * x + YY * y * y + ZZ * z * z + WW
+            + 2.0 * (XY * x * y + XZ * x * z + YZ * y * z + XW * x + YW * y + ZW * z);
+        return std::max(error, 0.0);
+    }
+};
+
+struct Collapse
+{
+    uint32_t From;
+    uint32_t To;
+    // Squared distance the surface moves by
+    float Error;
+};
+
+static uint64_t EdgeKey(uint32_t a, uint32_t b)
+{
+    return a < b ? (uint64_t(a) << 32) | b : (uint64_t(b) << 32) | a;
+}
+
+static glm::vec3 TriangleNormal(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c)
+{
+    return glm::cross(b - a, c - a);
+}
+
+// Vertices that must not move: on a seam, where several vertices share a position, or on the mesh's border
+static std::vector<bool> FindLockedVertices(const std::vector<SceneVertex>& vertices, const std::vector<uint32_t>& indices)
+{
+    std::vector<bool> locked(vertices.size(), false);
+
+    std::map<std::tuple<float, float, float>, uint32_t> firstAtPosition;
+    for (uint32_t i = 0; i < uint32_t(vertices.size()); i++)
+    {
+        const glm::vec3& position = vertices[i].Position;
+        auto [it, inserted] = firstAtPosition.emplace(std::make_tuple(position.x, position.y, position.z), i);
+        if (!inserted)
+        {
+            locked[i] = true;
+            locked[it->second] = true;
+        }
+    }
+
+    std::unordered_map<uint64_t, uint32_t> edgeTriangles;
+    for (size_t i = 0; i < indices.size(); i += 3)
+    {
+        for (size_t edge = 0; edge < 3; edge++)
+            edgeTriangles[EdgeKey(indices[i + edge], indices[i + (edge + 1) % 3])]++;
+    }
+
+    for (const auto& [key, triangles] : edgeTriangles)
+    {
+        if (triangles == 1)
+        {
+            locked[uint32_t(key >> 32)] = true;
+            locked[uint32_t(key)] = true;
+        }
+    }
+
+    return locked;
+}
+
+// Moving a vertex onto another must not turn any of its remaining triangles over
+static bool CollapseFlipsTriangle(const std::vector<SceneVertex>& vertices, const std::vector<uint32_t>& indices,
+    const std::vector<uint32_t>& triangleOffsets, const std::vector<uint32_t>& vertexTriangles, const Collapse& collapse)
+{
+    const glm::vec3& target = vertices[collapse.To].Position;
+
+    for (uint32_t i = triangleOffsets[collapse.From]; i < triangleOffsets[collapse.From + 1]; i++)
+    {
+        const uint32_t* triangle = &indices[vertexTriangles[i] * 3];
+        if (triangle[0] == collapse.To || triangle[1] == collapse.To || triangle[2] == collapse.To)
+            continue;
+
+        glm::vec3 corners[3], moved[3];
+        for (int corner = 0; corner < 3; corner++)
+        {
+            corners[corner] = vertices[triangle[corner]].Position;
+            moved[corner] = triangle[corner] == collapse.From ? target : corners[corner];
+        }
+
+        glm::vec3 before = TriangleNormal(corners[0], corners[1], corners[2]);
+        glm::vec3 after = TriangleNormal(moved[0], moved[1], moved[2]);
+        if (glm::dot(before, after) <= 0.0f)
+            return true;
+    }
+
+    return false;
+}
+
+std::vector<uint32_t> SimplifyMesh(const std::vector<SceneVertex>& vertices, const std::vector<uint32_t>& indices,
+    size_t targetIndexCount, float targetError, float& resultError)
+{
+    uint32_t vertexCount = uint32_t(vertices.size());
+    std::vector<uint32_t> result = indices;
+    std::vector<bool> locked = FindLockedVertices(vertices, indices);
+
+    // Unweighted planes, so the error is a sum of squared distances and bounds how far the surface moves
+    std::vector<Quadric> quadrics(vertexCount);
+    for (size_t i = 0; i < indices.size(); i += 3)
+    {
+        glm::vec3 a = vertices[indices[i]].Position;
+        glm::vec3 normal = TriangleNormal(a, vertices[indices[i + 1]].Position, vertices[indices[i + 2]].Position);
+        float length = glm::length(normal);
+        if (length <= 1e-12f)
+            continue;
+
+        normal = normal / length;
+        for (size_t corner = 0; corner < 3; corner++)
+            quadrics[indices[i + corner]].AddPlane(normal.x, normal.y, normal.z, -glm::dot(normal, a));
+    }
+
+    float maxError = targetError * targetError;
+    float largestError = 0.0f;
+
+    while (result.size() > targetIndexCount)
+    {
+        uint32_t triangleCount = uint32_t(result.size() / 3);
+
+        std::vector<uint32_t> triangleOffsets(vertexCount + 1, 0);
+        for (uint32_t index : result)
+            triangleOffsets[index + 1]++;
+        for (uint32_t i = 0; i < vertexCount; i++)
+            triangleOffsets[i + 1] += triangleOffsets[i];
+
+        std::vector<uint32_t> vertexTriangles(result.size());
+        std::vector<uint32_t> cursor(triangleOffsets.begin(), triangleOffsets.end() - 1);
+        for (uint32_t i = 0; i < uint32_t(result.size()); i++)
+            vertexTriangles[cursor[result[i]]++] = i / 3;
+
+        // Every interior edge shows up in both of its triangles, once per direction
+        std::vector<Collapse> collapses;
+        for (uint32_t triangle = 0; triangle < triangleCount; triangle++)
+        {
+            for (uint32_t edge = 0; edge < 3; edge++)
+            {
+                uint32_t a = result[triangle * 3 + edge];
+                uint32_t b = result[triangle * 3 + (edge + 1) % 3];
+                if (a > b || (locked[a] && locked[b]))
+                    continue;
+
+                Quadric combined = quadrics[a];
+                combined.Add(quadrics[b]);
+
+                float errorToB = locked[a] ? INFINITY : float(combined.Evaluate(vertices[b].Position));
+                float errorToA = locked[b] ? INFINITY : float(combined.Evaluate(vertices[a].Position));
+                if (errorToB <= errorToA)
+                    collapses.push_back({ a, b, errorToB });
+                else
+                    collapses.push_back({ b, a, errorToA });
+            }
+        }
+
+        std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) { return a.Error < b.Error; });
+
+        // Only collapses that don't share any triangles are made in the same pass, so the adjacency and quadrics
+        // they're checked against stay valid until the pass is applied
+        std::vector<uint32_t> remap(vertexCount);
+        for (uint32_t i = 0; i < vertexCount; i++)
+            remap[i] = i;
+        std::vector<bool> touched(vertexCount, false);
+
+        size_t trianglesToRemove = (result.size() - targetIndexCount + 2) / 3;
+        size_t removedTriangles = 0;
+        size_t collapsed = 0;
+
+        for (const Collapse& collapse : collapses)
+        {
+            if (collapse.Error > maxError || removedTriangles >= trianglesToRemove)
+                break;
+            if (touched[collapse.From] || touched[collapse.To])
+                continue;
+            if (CollapseFlipsTriangle(vertices, result, triangleOffsets, vertexTriangles, collapse))
+                continue;
+
+            for (uint32_t i = triangleOffsets[collapse.From]; i < triangleOffsets[collapse.From + 1]; i++)
+            {
+                const uint32_t* triangle = &result[vertexTriangles[i] * 3];
+                if (triangle[0] == collapse.To || triangle[1] == collapse.To || triangle[2] == collapse.To)
+                    removedTriangles++;
+                for (int corner = 0; corner < 3; corner++)
+                    touched[triangle[corner]] = true;
+            }
+
+            remap[collapse.From] = collapse.To;
+            quadrics[collapse.To].Add(quadrics[collapse.From]);
+            largestError = std::max(largestError, collapse.Error);
+            collapsed++;
+        }
+
+        if (collapsed == 0)
+            break;
+
+        size_t writeIndex = 0;
+        for (size_t i = 0; i < result.size(); i += 3)
+        {
+            uint32_t a = remap[result[i]], b = remap[result[i + 1]], c = remap[result[i + 2]];
+            if (a == b || b == c || a == c)
+                continue;
+
+            result[writeIndex++] = a;
+            result[writeIndex++] = b;
+            result[writeIndex++] = c;
+        }
+        result.resize(writeIndex);
+    }
+
+    resultError = std::sqrt(largestError);
+    return result;
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "Scene.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Simplifies a triangle mesh by collapsing edges in order of their quadric error (Garland and Heckbert).
+// Vertices are only ever merged into one another, never moved or created, so the result indexes the same vertices
+// and every LOD of a mesh can share its vertex buffer. Vertices on a border or on a seam (sharing a position with
+// another vertex) stay put so the mesh can't tear open.
+//
+// Stops once the index count reaches targetIndexCount or the next collapse would move the surface by more than
+// targetError, in the vertices' units. resultError is set to the largest error of the collapses that were made.
+std::vector<uint32_t> SimplifyMesh(const std::vector<SceneVertex>& vertices, const std::vector<uint32_t>& indices,
+    size_t targetIndexCount, float targetError, float& resultError);
@@ -0,0 +1,339 @@
+#include "ParticleSimulation.h"
+
+#include <iostream>
+#include <random>
+
+struct Particle
+{
+    float Position[2];
+    float Velocity[2];
+    float Color[4];
+};
+
+struct SimulationPushConstants
+{
+    float DeltaTime;
+    uint32_t ParticleCount;
+};
+
+void ParticleSimulation::Init(const ParticleSimulationSpecification& specification)
+{
+    this->specification = specification;
+
+    CreateBuffers();
+
+    const LearningVK::ShaderVariant* computeShader = specification.Shaders->SelectVariant("particles.comp", 0);
+    if (!computeShader)
+    {
+        std::cout << "Error: Couldn't find the particle simulation shader!" << std::endl;
+        __debugbreak();
+    }
+
+    LearningVK::ComputePipelineSpecification pipelineSpecification;
+    pipelineSpecification.Code = &computeShader->Code;
+    pipelineSpecification.Bindings = { LearningVK::StorageBufferBinding(0), LearningVK::StorageBufferBinding(1) };
+    pipelineSpecification.PushConstantSize = sizeof(SimulationPushConstants);
+
+    if (!LearningVK::CreateComputePipeline(specification.Device, pipelineSpecification, computePipeline))
+        __debugbreak();
+
+    CreateDescriptorSets();
+    CreateGraphicsPipeline();
+}
+
+void ParticleSimulation::Shutdown()
+{
+    VkDevice device = specification.Device;
+
+    vkDestroyPipeline(device, graphicsPipeline, nullptr);
+    vkDestroyPipelineLayout(device, graphicsPipelineLayout, nullptr);
+    vkDestroyDescriptorPool(device, descriptorPool, nullptr);
+    LearningVK::DestroyComputePipeline(device, computePipeline);
+
+    for (LearningVK::Buffer& buffer : particleBuffers)
+        LearningVK::DestroyBuffer(device, buffer);
+}
+
+void ParticleSimulation::RecreateGraphicsPipeline(VkRenderPass renderPass, LearningVK::DeletionQueue& deletionQueue, uint64_t frameNumber)
+{
+    VkDevice device = specification.Device;
+    VkPipeline oldPipeline = graphicsPipeline;
+    VkPipelineLayout oldPipelineLayout = graphicsPipelineLayout;
+    deletionQueue.Push(frameNumber, [=]() {
+        vkDestroyPipeline(device, oldPipeline, nullptr);
+        vkDestroyPipelineLayout(device, oldPipelineLayout, nullptr);
+    });
+
+    specification.RenderPass = renderPass;
+    CreateGraphicsPipeline();
+}
+
+void ParticleSimulation::RecordSimulation(VkCommandBuffer commandBuffer, uint64_t frameIndex, float deltaTime, bool drawnOnSameQueue)
+{
+    const LearningVK::DeviceDispatch& dispatch = LearningVK::GetDeviceDispatch();
+
+    uint32_t current = uint32_t(frameIndex % BufferCount);
+
+    // The previous frame's dispatch wrote the buffer this one reads. On the graphics queue the buffer being
+    // written was also drawn two frames ago, on the compute queue the in-flight fences already cover that.
+    VkPipelineStageFlags srcStages = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+    if (drawnOnSameQueue)
+        srcStages |= VK_PIPELINE_STAGE_VERTEX_INPUT_BIT;
+
+    VkMemoryBarrier previousWrite{};
+    previousWrite.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    previousWrite.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    previousWrite.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    dispatch.CmdPipelineBarrier(commandBuffer, srcStages, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &previousWrite, 0, nullptr, 0, nullptr);
+
+    SimulationPushConstants pushConstants;
+    pushConstants.DeltaTime = deltaTime;
+    pushConstants.ParticleCount = specification.ParticleCount;
+
+    dispatch.CmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, computePipeline.Pipeline);
+    dispatch.CmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, computePipeline.Layout, 0, 1, &descriptorSets[current], 0, nullptr);
+    dispatch.CmdPushConstants(commandBuffer, computePipeline.Layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pushConstants), &pushConstants);
+    dispatch.CmdDispatch(commandBuffer, (specification.ParticleCount + 255) / 256, 1, 1);
+
+    if (drawnOnSameQueue)
+    {
+        VkBufferMemoryBarrier toVertexInput{};
+        toVertexInput.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        toVertexInput.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        toVertexInput.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT;
+        toVertexInput.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        toVertexInput.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        toVertexInput.buffer = particleBuffers[current].Handle;
+        toVertexInput.offset = 0;
+        toVertexInput.size = VK_WHOLE_SIZE;
+        dispatch.CmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, 0, 0, nullptr, 1, &toVertexInput, 0, nullptr);
+    }
+}
+
+void ParticleSimulation::RecordDraw(VkCommandBuffer commandBuffer, uint64_t frameIndex)
+{
+    const LearningVK::DeviceDispatch& dispatch = LearningVK::GetDeviceDispatch();
+
+    uint32_t current = uint32_t(frameIndex % BufferCount);
+
+    VkDeviceSize offset = 0;
+    dispatch.CmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline);
+    dispatch.CmdBindVertexBuffers(commandBuffer, 0, 1, &particleBuffers[current].Handle, &offset);
+    dispatch.CmdDraw(commandBuffer, specification.ParticleCount, 1, 0, 0);
+}
+
+void ParticleSimulation::CreateBuffers()
+{
+    std::mt19937 random(1337);
+    std::uniform_real_distribution<float> position(-1.0f, 1.0f);
+    std::uniform_real_distribution<float> speed(-0.25f, 0.25f);
+    std::uniform_real_distribution<float> color(0.2f, 1.0f);
+
+    std::vector<Particle> particles(specification.ParticleCount);
+    for (Particle& particle : particles)
+    {
+        particle.Position[0] = position(random);
+        particle.Position[1] = position(random);
+        particle.Velocity[0] = speed(random);
+        particle.Velocity[1] = speed(random);
+        particle.Color[0] = color(random);
+        particle.Color[1] = color(random);
+        particle.Color[2] = color(random);
+        particle.Color[3] = 1.0f;
+    }
+
+    VkDeviceSize size = sizeof(Particle) * particles.size();
+    for (LearningVK::Buffer& buffer : particleBuffers)
+    {
+        if (!LearningVK::CreateBuffer(specification.Device, specification.PhysicalDevice, size,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0, buffer, specification.QueueFamilies))
+            __debugbreak();
+
+        LearningVK::UploadBuffer(specification.Device, specification.PhysicalDevice, specification.UploadQueue, specification.UploadCommandPool,
+            buffer, particles.data(), size);
+    }
+}
+
+void ParticleSimulation::CreateDescriptorSets()
+{
+    VkDescriptorPoolSize poolSize{};
+    poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    poolSize.descriptorCount = BufferCount * 2;
+
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.maxSets = BufferCount;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+
+    if (vkCreateDescriptorPool(specification.Device, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS)
+    {
+        std::cout << "Error: Couldn't create particle descriptor pool!" << std::endl;
+        __debugbreak();
+    }
+
+    std::array<VkDescriptorSetLayout, BufferCount> layouts;
+    layouts.fill(computePipeline.SetLayout);
+
+    VkDescriptorSetAllocateInfo allocateInfo{};
+    allocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocateInfo.descriptorPool = descriptorPool;
+    allocateInfo.descriptorSetCount = BufferCount;
+    allocateInfo.pSetLayouts = layouts.data();
+
+    if (vkAllocateDescriptorSets(specification.Device, &allocateInfo, descriptorSets.data()) != VK_SUCCESS)
+    {
+        std::cout << "Error: Couldn't allocate particle descriptor sets!" << std::endl;
+        __debugbreak();
+    }
+
+    for (uint32_t i = 0; i < BufferCount; i++)
+    {
+        VkDescriptorBufferInfo previousInfo{ particleBuffers[(i + BufferCount - 1) % BufferCount].Handle, 0, VK_WHOLE_SIZE };
+        VkDescriptorBufferInfo currentInfo{ particleBuffers[i].Handle, 0, VK_WHOLE_SIZE };
+
+        std::array<VkWriteDescriptorSet, 2> writes{};
+        for (uint32_t binding = 0; binding < 2; binding++)
+        {
+            writes[binding].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writes[binding].dstSet = descriptorSets[i];
+            writes[binding].dstBinding = binding;
+            writes[binding].descriptorCount = 1;
+            writes[binding].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        }
+        writes[0].pBufferInfo = &previousInfo;
+        writes[1].pBufferInfo = &currentInfo;
+
+        vkUpdateDescriptorSets(specification.Device, uint32_t(writes.size()), writes.data(), 0, nullptr);
+    }
+}
+
+void ParticleSimulation::CreateGraphicsPipeline()
+{
+    const LearningVK::ShaderVariant* vertexShader = specification.Shaders->SelectVariant("particle.vert", 0);
+    const LearningVK::ShaderVariant* fragShader = specification.Shaders->SelectVariant("particle.frag", 0);
+    if (!vertexShader || !fragShader)
+    {
+        std::cout << "Error: Couldn't find the particle shaders!" << std::endl;
+        __debugbreak();
+    }
+
+    VkShaderModuleCreateInfo moduleInfo{};
+    moduleInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+
+    VkShaderModule vertShaderModule, fragShaderModule;
+    moduleInfo.codeSize = vertexShader->Code.size() * sizeof(uint32_t);
+    moduleInfo.pCode = vertexShader->Code.data();
+    vkCreateShaderModule(specification.Device, &moduleInfo, nullptr, &vertShaderModule);
+    moduleInfo.codeSize = fragShader->Code.size() * sizeof(uint32_t);
+    moduleInfo.pCode = fragShader->Code.data();
+    vkCreateShaderModule(specification.Device, &moduleInfo, nullptr, &fragShaderModule);
+
+    std::array<VkPipelineShaderStageCreateInfo, 2> shaderStages{};
+    shaderStages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    shaderStages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
+    shaderStages[0].module = vertShaderModule;
+    shaderStages[0].pName = "main";
+    shaderStages[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    shaderStages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+    shaderStages[1].module = fragShaderModule;
+    shaderStages[1].pName = "main";
+
+    VkVertexInputBindingDescription bindingDescription{};
+    bindingDescription.binding = 0;
+    bindingDescription.stride = sizeof(Particle);
+    bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+    std::array<VkVertexInputAttributeDescription, 2> attributeDescriptions{};
+    attributeDescriptions[0].location = 0;
+    attributeDescriptions[0].binding = 0;
+    attributeDescriptions[0].format = VK_FORMAT_R32G32_SFLOAT;
+    attributeDescriptions[0].offset = offsetof(Particle, Position);
+    attributeDescriptions[1].location = 1;
+    attributeDescriptions[1].binding = 0;
+    attributeDescriptions[1].format = VK_FORMAT_R32G32B32A32_SFLOAT;
+    attributeDescriptions[1].offset = offsetof(Particle, Color);
+
+    VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
+    vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+    vertexInputInfo.vertexBindingDescriptionCount = 1;
+    vertexInputInfo.pVertexBindingDescriptions = &bindingDescription;
+    vertexInputInfo.vertexAttributeDescriptionCount = uint32_t(attributeDescriptions.size());
+    vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
+
+    VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
+    inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+    inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_POINT_LIST;
+
+    VkPipelineViewportStateCreateInfo viewportState{};
+    viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+    viewportState.viewportCount = 1;
+    viewportState.scissorCount = 1;
+
+    VkPipelineRasterizationStateCreateInfo rasterizer{};
+    rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+    rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
+    rasterizer.lineWidth = 1.0f;
+    rasterizer.cullMode = VK_CULL_MODE_NONE;
+    rasterizer.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+
+    VkPipelineMultisampleStateCreateInfo multisampling{};
+    multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+    multisampling.rasterizationSamples = specification.Samples;
+
+    // Particles are drawn behind everything else, so they neither test nor write depth
+    VkPipelineDepthStencilStateCreateInfo depthStencil{};
+    depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+    depthStencil.depthTestEnable = VK_FALSE;
+    depthStencil.depthWriteEnable = VK_FALSE;
+
+    VkPipelineColorBlendAttachmentState colorBlendAttachment{};
+    colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+    colorBlendAttachment.blendEnable = VK_FALSE;
+
+    VkPipelineColorBlendStateCreateInfo colorBlending{};
+    colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+    colorBlending.attachmentCount = 1;
+    colorBlending.pAttachments = &colorBlendAttachment;
+
+    std::array<VkDynamicState, 2> dynamicStates = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+    VkPipelineDynamicStateCreateInfo dynamicState{};
+    dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+    dynamicState.dynamicStateCount = uint32_t(dynamicStates.size());
+    dynamicState.pDynamicStates = dynamicStates.data();
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+
+    if (vkCreatePipelineLayout(specification.Device, &pipelineLayoutInfo, nullptr, &graphicsPipelineLayout) != VK_SUCCESS)
+    {
+        std::cout << "Couldn't create particle pipeline layout!" << std::endl;
+        __debugbreak();
+    }
+
+    VkGraphicsPipelineCreateInfo pipelineInfo{};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    pipelineInfo.stageCount = uint32_t(shaderStages.size());
+    pipelineInfo.pStages = shaderStages.data();
+    pipelineInfo.pVertexInputState = &vertexInputInfo;
+    pipelineInfo.pInputAssemblyState = &inputAssembly;
+    pipelineInfo.pViewportState = &viewportState;
+    pipelineInfo.pRasterizationState = &rasterizer;
+    pipelineInfo.pMultisampleState = &multisampling;
+    pipelineInfo.pDepthStencilState = &depthStencil;
+    pipelineInfo.pColorBlendState = &colorBlending;
+    pipelineInfo.pDynamicState = &dynamicState;
+    pipelineInfo.layout = graphicsPipelineLayout;
+    pipelineInfo.renderPass = specification.RenderPass;
+    pipelineInfo.subpass = 0;
+
+    if (vkCreateGraphicsPipelines(specification.Device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &graphicsPipeline) != VK_SUCCESS)
+    {
+        std::cout << "Error: Couldn't create particle pipeline!" << std::endl;
+        __debugbreak();
+    }
+
+    vkDestroyShaderModule(specification.Device, vertShaderModule, nullptr);
+    vkDestroyShaderModule(specification.Device, fragShaderModule, nullptr);
+}
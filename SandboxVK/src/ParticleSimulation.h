@@ -0,0 +1,60 @@
+#pragma once
+
+#include "EngineVK.h"
+
+#include <vulkan/vulkan.h>
+
+#include <array>
+#include <vector>
+
+struct ParticleSimulationSpecification
+{
+    VkDevice Device = VK_NULL_HANDLE;
+    VkPhysicalDevice PhysicalDevice = VK_NULL_HANDLE;
+    // Every family that touches the particle buffers, they are shared concurrently between them
+    std::vector<uint32_t> QueueFamilies;
+    VkQueue UploadQueue = VK_NULL_HANDLE;
+    VkCommandPool UploadCommandPool = VK_NULL_HANDLE;
+
+    const LearningVK::ShaderLibrary* Shaders = nullptr;
+    VkRenderPass RenderPass = VK_NULL_HANDLE;
+    VkSampleCountFlagBits Samples = VK_SAMPLE_COUNT_1_BIT;
+
+    uint32_t ParticleCount = 1 << 20;
+};
+
+// GPU particle simulation used as the reference compute workload. There's one storage buffer per frame in
+// flight: every frame's dispatch reads the previous frame's buffer and writes its own, so the compute queue can
+// update the next frame while the graphics queue is still drawing the last one.
+class ParticleSimulation
+{
+public:
+    static const uint32_t BufferCount = 2;
+
+    void Init(const ParticleSimulationSpecification& specification);
+    void Shutdown();
+
+    // Rebuilds the point pipeline for a new render pass, the old one is retired through the deletion queue
+    void RecreateGraphicsPipeline(VkRenderPass renderPass, LearningVK::DeletionQueue& deletionQueue, uint64_t frameNumber);
+
+    // Records the update of the buffer for frameIndex. When the draw happens on the same queue a barrier
+    // makes the results visible to the vertex input, otherwise the caller synchronizes with a semaphore.
+    void RecordSimulation(VkCommandBuffer commandBuffer, uint64_t frameIndex, float deltaTime, bool drawnOnSameQueue);
+    void RecordDraw(VkCommandBuffer commandBuffer, uint64_t frameIndex);
+
+    uint32_t GetParticleCount() const { return specification.ParticleCount; }
+private:
+    void CreateBuffers();
+    void CreateDescriptorSets();
+    void CreateGraphicsPipeline();
+private:
+    ParticleSimulationSpecification specification;
+
+    std::array<LearningVK::Buffer, BufferCount> particleBuffers;
+    LearningVK::ComputePipeline computePipeline;
+    VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+    std::array<VkDescriptorSet, BufferCount> descriptorSets{};
+
+    VkPipelineLayout graphicsPipelineLayout = VK_NULL_HANDLE;
+    VkPipeline graphicsPipeline = VK_NULL_HANDLE;
+};
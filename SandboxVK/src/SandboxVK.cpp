@@ -1,15 +1,38 @@
 #include "EngineVK.h"
 #include "EntryPoint.h"
+#include "ClusteredLighting.h"
+#include "ParticleSimulation.h"
+#include "SceneRenderer.h"
+#include "StatsOverlay.h"
 
 #include <vulkan/vulkan.hpp>
 #include <GLFW/glfw3.h>
 
+#include <algorithm>
 #include <iostream>
+#include <filesystem>
 #include <fstream>
+#include <memory>
+#include <chrono>
+#include <cstdio>
+#include <deque>
 #include <set>
+#include <thread>
 #include <vector>
 
 #include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+// Set to 1 to print benchmark results once Vulkan has been initialised
+#define VK_RUN_BENCHMARKS 0
+
+const uint32_t MAX_FRAMES_IN_FLIGHT = 2;
+// Windows that can be open at once, each is a view of the scene renderer and the lighting
+const uint32_t MAX_VIEWPORTS = 4;
+const float SCENE_NEAR_PLANE = 0.1f;
+const float SCENE_FAR_PLANE = 200.0f;
+// Render actions handled by a single frame, the rest wait for the following frames
+const uint32_t MAX_RENDER_ACTIONS_PER_FRAME = 1;
 
 struct WindowProperties
 {
@@ -20,15 +43,17 @@ struct WindowProperties
 
 struct QueueFamilyIndices
 {
-    uint32_t GraphicsFamily = -1;
-    uint32_t PresentFamily = -1;
+    uint32_t GraphicsFamily = UINT32_MAX;
+    uint32_t PresentFamily = UINT32_MAX;
+    // A compute-only family when the device has one so dispatches can overlap rendering, the graphics family otherwise
+    uint32_t ComputeFamily = UINT32_MAX;
 
-    bool IsComplete()
+    bool IsComplete() const
     {
-        if (GraphicsFamily < 0 && PresentFamily < 0)
-            return false;
-        return true;
+        return GraphicsFamily != UINT32_MAX && PresentFamily != UINT32_MAX && ComputeFamily != UINT32_MAX;
     }
+
+    bool HasAsyncCompute() const { return ComputeFamily != GraphicsFamily; }
 };
 
 struct SwapChainSupportDetails
@@ -38,40 +63,155 @@ struct SwapChainSupportDetails
     std::vector<VkPresentModeKHR> presentModes;
 };
 
+// Bit order must match the features of shader.frag in ShadersVK.lua
+enum FragmentShaderFeatures : uint32_t
+{
+    FragmentFeature_VertexColor = 1 << 0
+};
+
+// Work asked for by input events that rebuilds resources or waits for the device, so it can take longer than a frame
+enum RenderAction : uint32_t
+{
+    RenderAction_OpenViewport = 0,
+    RenderAction_CloseViewports,
+    RenderAction_ReloadShaders,
+    RenderAction_ToggleCapture,
+    RenderAction_ToggleAsyncCompute,
+    RenderAction_ToggleOcclusion,
+    RenderAction_RenderStill
+};
+
+struct Material
+{
+    uint32_t Features = 0;
+    float Brightness = 1.0f;
+};
+
+// A window the scene is rendered into. Every viewport has its own swapchain, targets and command buffers, while
+// the device, render pass, pipelines and scene resources are shared by all of them.
+struct Viewport
+{
+    GLFWwindow* Window = nullptr;
+    // Width and Height are the framebuffer size, kept up to date by resize events
+    WindowProperties Properties;
+    VkSurfaceKHR Surface = VK_NULL_HANDLE;
+    std::unique_ptr<LearningVK::Swapchain> SwapChain;
+    std::vector<VkFramebuffer> Framebuffers;
+    LearningVK::Attachment ColorTarget;
+    LearningVK::Attachment DepthTarget;
+    bool Resized = false;
+    // Set by its close event, it isn't drawn anymore and is closed by the next CloseViewports render action
+    bool Closing = false;
+
+    // Its view of the scene renderer and lighting
+    uint32_t View = 0;
+    // Seconds its camera runs ahead of the main window's along the camera path
+    float CameraOffset = 0.0f;
+
+    // Recorded on a thread of their own, so every viewport has its own pool
+    VkCommandPool CommandPool = VK_NULL_HANDLE;
+    // Recorded every frame with the commands that change every frame, submitted ahead of the cached commands
+    std::vector<VkCommandBuffer> SetupCommandBuffers;
+    // The rest of the frame, recorded once per frame slot, swapchain image and particle buffer. Invalidated by
+    // anything that recreates what it records: the swapchain, pipelines or the occlusion culling setting.
+    std::unique_ptr<LearningVK::CommandCache> FrameCommands;
+    // Recorded every frame with what's drawn over the finished image and the capture copy, submitted last
+    std::vector<VkCommandBuffer> FinishCommandBuffers;
+    std::vector<VkSemaphore> ImageAvailableSemaphores;
+
+    // Culling results of its last finished frame, summarised in the window title
+    OcclusionCullingStats CullingStats;
+    // Frame slots submitted with this viewport, their culling stats belong to it
+    std::array<bool, MAX_FRAMES_IN_FLIGHT> SlotSubmitted{};
+    // Image acquired for the frame being drawn
+    uint32_t ImageIndex = 0;
+};
+
 class SandboxVK : public LearningVK::Application
 {
-public:
-    GLFWwindow* window = nullptr;
-    WindowProperties windowProps;
-private:
+    // The main window is viewports[0] and is always open, closing it quits
+    std::vector<std::unique_ptr<Viewport>> viewports;
+    // Records the frames of the viewports side by side
+    LearningVK::ThreadPool recordingThreads{ MAX_VIEWPORTS };
+    // Queued by input events and handled MAX_RENDER_ACTIONS_PER_FRAME at a time, so a burst of key presses is
+    // spread over several frames instead of stalling one
+    std::deque<RenderAction> renderActions;
+
     VkInstance vkInstance = nullptr;
-    VkSurfaceKHR surface = nullptr;
     VkDebugUtilsMessengerEXT debugMessenger;
 
     const std::vector<const char*> validationLayers = { "VK_LAYER_KHRONOS_validation" };
     const std::vector<const char*> deviceExtensions = { VK_KHR_SWAPCHAIN_EXTENSION_NAME };
+    // Enabled when the device supports it, the memory tracker falls back to its own counts otherwise
+    bool memoryBudgetSupported = false;
 
     VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
     VkQueue graphicsQueue = nullptr;
     VkQueue presentQueue = nullptr;
+    VkQueue computeQueue = nullptr;
     VkDevice device = nullptr;
 
-    VkSwapchainKHR swapChain = nullptr;
-    std::vector<VkImage> swapChainImages;
-    VkFormat swapChainImageFormat;
-    VkExtent2D swapChainExtent;
-    std::vector<VkImageView> swapChainImageViews;
-    std::vector<VkFramebuffer> swapChainFramebuffers;
+
+    // MSAA is disabled when this is VK_SAMPLE_COUNT_1_BIT, otherwise the highest supported count up to it is used
+    const VkSampleCountFlagBits requestedMsaaSamples = VK_SAMPLE_COUNT_4_BIT;
+    VkSampleCountFlagBits msaaSamples = VK_SAMPLE_COUNT_1_BIT;
+    VkFormat depthFormat;
+
+    LearningVK::ShaderLibrary shaderLibrary;
+    Material triangleMaterial;
 
     VkRenderPass renderPass;
     VkPipelineLayout pipelineLayout;
     VkPipeline graphicsPipeline;
     VkCommandPool commandPool;
-    VkCommandBuffer commandBuffer;
 
-    VkSemaphore imageAvailableSemaphore;
-    VkSemaphore renderFinishedSemaphore;
-    VkFence inFlightFence;
+    // Every viewport drawn by a frame waits on its own image, all of them are presented once the frame is done
+    std::vector<VkSemaphore> renderFinishedSemaphores;
+    std::vector<VkFence> inFlightFences;
+    uint32_t currentFrame = 0;
+
+    // Number of the frame being recorded, resources retired during it are destroyed once the GPU finishes it
+    uint64_t frameNumber = 0;
+    // Frame count that is complete once the matching in-flight fence signals
+    std::array<uint64_t, MAX_FRAMES_IN_FLIGHT> inFlightFrameCounts{};
+    uint64_t completedFrameCount = 0;
+    LearningVK::DeletionQueue deletionQueue;
+
+    std::shared_ptr<LearningVK::FrameCapture> frameCapture;
+
+    ParticleSimulation particles;
+    // Runs the simulation on the compute queue and makes the draw wait on it with a semaphore,
+    // otherwise the dispatch is recorded in front of the render pass on the graphics queue
+    bool useAsyncCompute = true;
+    VkCommandPool computeCommandPool;
+    std::vector<VkCommandBuffer> computeCommandBuffers;
+    std::vector<VkSemaphore> computeFinishedSemaphores;
+    // Signalled behind the graphics queue's last dispatch when the simulation moves to the compute queue, the next
+    // submission waits on it
+    VkSemaphore queueHandoffSemaphore = VK_NULL_HANDLE;
+    bool queueHandoffPending = false;
+    std::chrono::steady_clock::time_point lastFrameTime;
+    // Wall time between the last two frames
+    float deltaTime = 0.0f;
+    // Scene time of the frame being drawn and how far the particles advance to it, which is zero while paused
+    float sceneTime = 0.0f;
+    float simulationStep = 0.0f;
+
+    ClusteredLighting lighting;
+    SceneRenderer sceneRenderer;
+    std::chrono::steady_clock::time_point startTime;
+    // Space pauses the scene at the time the key was pressed rather than when a frame got to the event
+    bool scenePaused = false;
+    std::chrono::steady_clock::time_point pauseStart;
+    std::chrono::steady_clock::duration pausedDuration{};
+    std::chrono::steady_clock::time_point lastTitleUpdate;
+
+    StatsOverlay overlay;
+    bool overlayVisible = true;
+    // Exponential averages, so the numbers can be read
+    float smoothedFrameTime = 0.0f;
+    // From an event arriving on the event thread to it being handled here
+    float smoothedInputLatency = 0.0f;
 
 #ifdef VK_DEBUG
     const bool vkEnableValidationLayers = true;
@@ -87,23 +227,40 @@ public:
         CreateSurface();
         ChoosePhysicalDevice();
         CreateLogicalDevice();
-        CreateSwapChain();
-        CreateImageViews();
+        ChooseAttachmentFormats();
+        if (!CreateSwapChain(*viewports[0]))
+            __debugbreak();
+        CreateAttachments(*viewports[0]);
         CreateRenderPass();
+        LoadShaders();
         CreateGraphicsPipeline();
-        CreateFrameBuffers();
+        CreateFrameBuffers(*viewports[0]);
         CreateCommandPool();
-        CreateCommandBuffer();
+        CreateCommandBuffers();
         CreateSyncObjects();
+        CreateParticleSimulation();
+        CreateClusteredLighting();
+        CreateSceneRenderer();
+        CreateStatsOverlay();
+
+#if VK_RUN_BENCHMARKS
+        RunBenchmarks();
+#endif
     }
 
     void OnUpdate() override
     {
-        while (!glfwWindowShouldClose(window))
+        while (!viewports[0]->Closing)
         {
-            glfwPollEvents();
+            // Only events that arrived before the tick started, later ones are handled by the next tick
+            auto tickStart = std::chrono::steady_clock::now();
+            LearningVK::Event event;
+            while (PollEvent(event, tickStart))
+                HandleEvent(event);
+
+            ProcessRenderActions();
             DrawFrame();
-            }
+        }
 
         vkDeviceWaitIdle(device);
 
@@ -112,25 +269,34 @@ public:
 
     void OnDestruct() override
     {
-        vkDestroySemaphore(device, imageAvailableSemaphore, nullptr);
-        vkDestroySemaphore(device, renderFinishedSemaphore, nullptr);
-        vkDestroyFence(device, inFlightFence, nullptr);
+        if (frameCapture)
+            StopCapture();
+        deletionQueue.FlushAll();
+        overlay.Shutdown();
+        sceneRenderer.Shutdown();
+        lighting.Shutdown();
+        particles.Shutdown();
+
+        for (std::unique_ptr<Viewport>& viewport : viewports)
+            DestroyViewport(*viewport);
+
+        for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+        {
+            vkDestroySemaphore(device, renderFinishedSemaphores[i], nullptr);
+            vkDestroySemaphore(device, computeFinishedSemaphores[i], nullptr);
+            vkDestroyFence(device, inFlightFences[i], nullptr);
+        }
+        vkDestroySemaphore(device, queueHandoffSemaphore, nullptr);
 
+        vkDestroyCommandPool(device, computeCommandPool, nullptr);
         vkDestroyCommandPool(device, commandPool, nullptr);
-        for (auto frameBuffer : swapChainFramebuffers)
-            vkDestroyFramebuffer(device, frameBuffer, nullptr);
         vkDestroyPipeline(device, graphicsPipeline, nullptr);
         vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
         vkDestroyRenderPass(device, renderPass, nullptr);
-        for (auto imageView : swapChainImageViews)
-            vkDestroyImageView(device, imageView, nullptr);
 
-        vkDestroySwapchainKHR(device, swapChain, nullptr);
         vkDestroyDevice(device, nullptr);
-        vkDestroySurfaceKHR(vkInstance, surface, nullptr);
         vkDestroyInstance(vkInstance, nullptr);
 
-        glfwDestroyWindow(window);
         glfwTerminate();
     }
 private:
@@ -156,13 +322,160 @@ private:
     {
         glfwInit();
 
-        windowProps.Width = 800;
-        windowProps.Height = 600;
-        windowProps.Title = "Hello Vulkan!";
         glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
-        glfwWindowHint(GLFW_RESIZABLE, GLFW_FALSE);
+        glfwWindowHint(GLFW_RESIZABLE, GLFW_TRUE);
+
+        viewports.push_back(std::make_unique<Viewport>());
+        CreateViewportWindow(*viewports[0], "Hello Vulkan!", 800, 600);
+    }
+
+    // GLFW only creates windows on the event thread, which sends the window's events to the queue from then on
+    void CreateViewportWindow(Viewport& viewport, const std::string& title, uint32_t width, uint32_t height)
+    {
+        viewport.Properties.Title = title;
+
+        RunOnEventThread([&]() {
+            viewport.Window = glfwCreateWindow(width, height, title.c_str(), nullptr, nullptr);
+            AttachWindow(viewport.Window);
+
+            // Differs from the window size on high DPI displays
+            int framebufferWidth = 0, framebufferHeight = 0;
+            glfwGetFramebufferSize(viewport.Window, &framebufferWidth, &framebufferHeight);
+            viewport.Properties.Width = uint32_t(framebufferWidth);
+            viewport.Properties.Height = uint32_t(framebufferHeight);
+        });
+    }
+
+    VkExtent2D GetFramebufferExtent(const Viewport& viewport) const
+    {
+        return { viewport.Properties.Width, viewport.Properties.Height };
+    }
+
+    // Settings are changed straight away, anything that rebuilds resources or waits for the device is queued
+    void HandleEvent(const LearningVK::Event& event)
+    {
+        auto found = std::find_if(viewports.begin(), viewports.end(),
+            [&](const std::unique_ptr<Viewport>& viewport) { return viewport->Window == event.Window; });
+        // Windows closed since the event arrived
+        if (found == viewports.end())
+            return;
+        Viewport& viewport = **found;
+
+        float latency = std::chrono::duration<float>(std::chrono::steady_clock::now() - event.Time).count();
+        smoothedInputLatency = smoothedInputLatency > 0.0f ? glm::mix(smoothedInputLatency, latency, 0.05f) : latency;
+
+        switch (event.Type)
+        {
+        case LearningVK::EventType_WindowClose:
+            // Closing the main window quits, closing any other window only closes its viewport
+            viewport.Closing = true;
+            if (&viewport != viewports[0].get())
+                renderActions.push_back(RenderAction_CloseViewports);
+            break;
+        case LearningVK::EventType_WindowResize:
+            viewport.Properties.Width = event.Width;
+            viewport.Properties.Height = event.Height;
+            viewport.Resized = true;
+            break;
+        case LearningVK::EventType_Key:
+            if (event.Action == GLFW_PRESS)
+                HandleKeyPress(event);
+            break;
+        default:
+            break;
+        }
+    }
+
+    void HandleKeyPress(const LearningVK::Event& event)
+    {
+        switch (event.Key)
+        {
+        case GLFW_KEY_SPACE:
+            SetScenePaused(!scenePaused, event.Time);
+            break;
+        case GLFW_KEY_F1:
+            overlayVisible = !overlayVisible;
+            break;
+        case GLFW_KEY_F8:
+            PrintCullingStats();
+            break;
+        case GLFW_KEY_F9:
+            sceneRenderer.SetLodSelection(!sceneRenderer.IsLodSelectionEnabled());
+            std::cout << "LOD selection " << (sceneRenderer.IsLodSelectionEnabled() ? "enabled" : "disabled") << std::endl;
+            break;
+        case GLFW_KEY_F11:
+            DumpMemoryStats();
+            break;
+        case GLFW_KEY_F2:
+            renderActions.push_back(RenderAction_OpenViewport);
+            break;
+        case GLFW_KEY_F5:
+            renderActions.push_back(RenderAction_ReloadShaders);
+            break;
+        case GLFW_KEY_F6:
+            renderActions.push_back(RenderAction_ToggleAsyncCompute);
+            break;
+        case GLFW_KEY_F7:
+            renderActions.push_back(RenderAction_ToggleOcclusion);
+            break;
+        case GLFW_KEY_F10:
+            renderActions.push_back(RenderAction_RenderStill);
+            break;
+        case GLFW_KEY_F12:
+            renderActions.push_back(RenderAction_ToggleCapture);
+            break;
+        default:
+            break;
+        }
+    }
+
+    void ProcessRenderActions()
+    {
+        for (uint32_t i = 0; i < MAX_RENDER_ACTIONS_PER_FRAME && !renderActions.empty(); i++)
+        {
+            RenderAction action = renderActions.front();
+            renderActions.pop_front();
+
+            switch (action)
+            {
+            case RenderAction_OpenViewport:
+                OpenViewport();
+                break;
+            case RenderAction_CloseViewports:
+                for (size_t index = viewports.size() - 1; index > 0; index--)
+                {
+                    if (viewports[index]->Closing)
+                        CloseViewport(index);
+                }
+                break;
+            case RenderAction_ReloadShaders:
+                ReloadShaders();
+                break;
+            case RenderAction_ToggleCapture:
+                if (frameCapture)
+                    StopCapture();
+                else
+                    StartCapture();
+                break;
+            case RenderAction_ToggleAsyncCompute:
+                SetAsyncCompute(!useAsyncCompute);
+                break;
+            case RenderAction_ToggleOcclusion:
+                sceneRenderer.SetOcclusionCulling(!sceneRenderer.IsOcclusionCullingEnabled());
+                InvalidateFrameCommands();
+                std::cout << "Occlusion culling " << (sceneRenderer.IsOcclusionCullingEnabled() ? "enabled" : "disabled") << std::endl;
+                break;
+            case RenderAction_RenderStill:
+                RenderStill();
+                break;
+            }
+        }
+    }
 
-        window = glfwCreateWindow(windowProps.Width, windowProps.Height, windowProps.Title.c_str(), nullptr, nullptr);
+    // Of the main window, every other viewport has to match it since they share the render pass
+    VkFormat GetColorFormat() const
+    {
+        return viewports[0]->SwapChain->GetFormat();
     }
 
     void InitVulkan()
@@ -244,7 +557,7 @@ private:
 
     void CreateSurface()
     {
-        VkResult result = glfwCreateWindowSurface(vkInstance, window, nullptr, &surface);
+        VkResult result = glfwCreateWindowSurface(vkInstance, viewports[0]->Window, nullptr, &viewports[0]->Surface);
         if (result != VK_SUCCESS)
         {
             std::cout << "Couldn't create surface!" << std::endl;
@@ -285,14 +598,11 @@ private:
         QueueFamilyIndices indices = FindQueueFamilies(physicalDevice);
 
         std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
-        std::array<uint32_t, 2> uniqueQueueFamilies = { indices.GraphicsFamily, indices.PresentFamily };
+        std::set<uint32_t> uniqueQueueFamilies = { indices.GraphicsFamily, indices.PresentFamily, indices.ComputeFamily };
 
         float queuePriority = 1.0f;
         for (uint32_t queueFamily : uniqueQueueFamilies)
         {
-            if (queueFamily < 0)
-                break;
-
             VkDeviceQueueCreateInfo queueCreateInfo{};
             queueCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
             queueCreateInfo.queueFamilyIndex = queueFamily;
@@ -302,18 +612,33 @@ private:
 
         }
 
-        VkPhysicalDeviceFeatures deviceFeatures{};
+        // The occlusion culling writes one indirect draw per visible object and the count it draws
+        VkPhysicalDeviceVulkan12Features vulkan12Features{};
+        vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+        vulkan12Features.drawIndirectCount = VK_TRUE;
+
+        VkPhysicalDeviceFeatures2 deviceFeatures{};
+        deviceFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        deviceFeatures.pNext = &vulkan12Features;
+        deviceFeatures.features.multiDrawIndirect = VK_TRUE;
+        deviceFeatures.features.drawIndirectFirstInstance = VK_TRUE;
         
         VkDeviceCreateInfo createInfo{};
         createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+        createInfo.pNext = &deviceFeatures;
         
         createInfo.queueCreateInfoCount = uint32_t(queueCreateInfos.size());
         createInfo.pQueueCreateInfos = queueCreateInfos.data();
         
-        createInfo.pEnabledFeatures = &deviceFeatures;
+        createInfo.pEnabledFeatures = nullptr;
         
-        createInfo.enabledExtensionCount = uint32_t(deviceExtensions.size());
-        createInfo.ppEnabledExtensionNames = deviceExtensions.data();
+        std::vector<const char*> enabledExtensions = deviceExtensions;
+        memoryBudgetSupported = IsDeviceExtensionSupported(physicalDevice, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+        if (memoryBudgetSupported)
+            enabledExtensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+
+        createInfo.enabledExtensionCount = uint32_t(enabledExtensions.size());
+        createInfo.ppEnabledExtensionNames = enabledExtensions.data();
         
         if (vkEnableValidationLayers)
         {
@@ -331,132 +656,395 @@ private:
             std::cout << "Couldn't create logical device!" << std::endl;
             __debugbreak();
         }
+
+        if (!LearningVK::LoadDeviceDispatch(device, LearningVK::GetDeviceDispatch()))
+        {
+            std::cout << "Error: Couldn't load the device's functions!" << std::endl;
+            __debugbreak();
+        }
         
         vkGetDeviceQueue(device, indices.GraphicsFamily, 0, &graphicsQueue);
         vkGetDeviceQueue(device, indices.PresentFamily, 0, &presentQueue);
+        vkGetDeviceQueue(device, indices.ComputeFamily, 0, &computeQueue);
+
+        if (!indices.HasAsyncCompute())
+            std::cout << "No dedicated compute queue, compute work shares the graphics queue" << std::endl;
+
+        LearningVK::MemoryTracker& memoryTracker = LearningVK::GetMemoryTracker();
+        memoryTracker.Init(physicalDevice, memoryBudgetSupported);
+        memoryTracker.AddBudgetCallback([](const LearningVK::MemoryHeapStats& heap) {
+            std::cout << "Warning: Memory heap " << heap.HeapIndex << " is at " << uint32_t(heap.GetBudgetFraction() * 100.0f)
+                << "% of its budget (" << heap.Usage / (1024 * 1024) << " of " << heap.Budget / (1024 * 1024) << " MiB)" << std::endl;
+        });
+        if (!memoryBudgetSupported)
+            std::cout << "VK_EXT_memory_budget isn't supported, memory budgets are estimated from the heap sizes" << std::endl;
+    }
+
+    bool CreateSwapChain(Viewport& viewport)
+    {
+        QueueFamilyIndices indices = FindQueueFamilies(physicalDevice);
 
+        LearningVK::SwapchainSpecification specification;
+        specification.Device = device;
+        specification.PhysicalDevice = physicalDevice;
+        specification.Surface = viewport.Surface;
+        specification.GraphicsFamily = indices.GraphicsFamily;
+        specification.PresentFamily = indices.PresentFamily;
+        // Other windows share the main window's render pass, so they have to use its format
+        if (&viewport != viewports[0].get())
+            specification.PreferredFormat = GetColorFormat();
+
+        viewport.SwapChain = std::make_unique<LearningVK::Swapchain>(specification, GetFramebufferExtent(viewport));
+        return viewport.SwapChain->IsValid();
     }
 
-    void CreateSwapChain()
+    // Builds a new swapchain from the old one so presentation carries on while it's replaced. Only the
+    // per-image framebuffers are always rebuilt, everything else is kept unless the extent or format
+    // changed, and the old objects are retired through the deletion queue once in-flight frames are done with them.
+    void RecreateSwapChain(Viewport& viewport)
     {
-        SwapChainSupportDetails swapChainDetails = QuerySwapChainSupport(physicalDevice);
+        bool mainWindow = &viewport == viewports[0].get();
 
-        VkExtent2D extent = ChooseSwapExtent(swapChainDetails.surfaceCapabilities);
-        VkSurfaceFormatKHR surfaceFormat = ChooseSwapSurfaceFormat(swapChainDetails.surfaceFormats);
-        VkPresentModeKHR presentMode = ChooseSwapPresentMode(swapChainDetails.presentModes);
+        VkFormat oldImageFormat = viewport.SwapChain->GetFormat();
+        VkExtent2D oldExtent = viewport.SwapChain->GetExtent();
+        std::vector<VkFramebuffer> oldFramebuffers = std::move(viewport.Framebuffers);
+        viewport.Resized = false;
 
-        uint32_t imageCount = swapChainDetails.surfaceCapabilities.minImageCount + 1;
-        if (swapChainDetails.surfaceCapabilities.maxImageCount > 0 && imageCount > swapChainDetails.surfaceCapabilities.maxImageCount)
-            imageCount = swapChainDetails.surfaceCapabilities.maxImageCount;
+        if (!viewport.SwapChain->Recreate(GetFramebufferExtent(viewport), deletionQueue, frameNumber))
+            __debugbreak();
 
-        VkSwapchainCreateInfoKHR createInfo{};
-        createInfo.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
-        createInfo.surface = surface;
-        createInfo.minImageCount = imageCount;
-        createInfo.imageFormat = surfaceFormat.format;
-        createInfo.imageColorSpace = surfaceFormat.colorSpace;
-        createInfo.imageExtent = extent;
-        createInfo.imageArrayLayers = 1;
-        createInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+        VkFormat imageFormat = viewport.SwapChain->GetFormat();
+        VkExtent2D extent = viewport.SwapChain->GetExtent();
+        bool formatChanged = imageFormat != oldImageFormat;
+        bool extentChanged = extent.width != oldExtent.width || extent.height != oldExtent.height;
 
-        QueueFamilyIndices indices = FindQueueFamilies(physicalDevice);
-        uint32_t queueFamilyIndices[] = { indices.GraphicsFamily, indices.PresentFamily };
+        VkDevice device = this->device;
+        if (!mainWindow && imageFormat != GetColorFormat())
+        {
+            std::cout << "Error: " << viewport.Properties.Title << " can't use the main window's format anymore, closing it" << std::endl;
+            deletionQueue.Push(frameNumber, [=]() {
+                for (auto frameBuffer : oldFramebuffers)
+                    vkDestroyFramebuffer(device, frameBuffer, nullptr);
+            });
+            viewport.Closing = true;
+            renderActions.push_back(RenderAction_CloseViewports);
+            return;
+        }
 
-        if (indices.GraphicsFamily != indices.PresentFamily)
+        LearningVK::Attachment oldColorTarget, oldDepthTarget;
+        if (formatChanged || extentChanged)
         {
-            createInfo.imageSharingMode = VK_SHARING_MODE_CONCURRENT;
-            createInfo.queueFamilyIndexCount = 2;
-            createInfo.pQueueFamilyIndices = queueFamilyIndices;
+            oldColorTarget = viewport.ColorTarget;
+            oldDepthTarget = viewport.DepthTarget;
+            viewport.ColorTarget = {};
+            viewport.DepthTarget = {};
+            CreateAttachments(viewport);
         }
+
+        VkRenderPass oldRenderPass = VK_NULL_HANDLE;
+        VkPipeline oldPipeline = VK_NULL_HANDLE;
+        VkPipelineLayout oldPipelineLayout = VK_NULL_HANDLE;
+        if (formatChanged)
+        {
+            oldRenderPass = renderPass;
+            oldPipeline = graphicsPipeline;
+            oldPipelineLayout = pipelineLayout;
+            CreateRenderPass();
+            CreateGraphicsPipeline();
+            particles.RecreateGraphicsPipeline(renderPass, deletionQueue, frameNumber);
+            sceneRenderer.RecreatePipelines(renderPass, deletionQueue, frameNumber);
+
+            // The other windows are still in the old format, their next recreation closes them if they can't follow
+            for (size_t i = 1; i < viewports.size(); i++)
+                viewports[i]->Resized = true;
+        }
+
+        if (extentChanged)
+            sceneRenderer.Resize(viewport.View, extent, deletionQueue, frameNumber);
+
+        CreateFrameBuffers(viewport);
+        if (mainWindow)
+            overlay.Resize(imageFormat, extent, viewport.SwapChain->GetImageViews(), deletionQueue, frameNumber);
+
+        deletionQueue.Push(frameNumber, [=]() mutable {
+            for (auto frameBuffer : oldFramebuffers)
+                vkDestroyFramebuffer(device, frameBuffer, nullptr);
+
+            LearningVK::DestroyAttachment(device, oldColorTarget);
+            LearningVK::DestroyAttachment(device, oldDepthTarget);
+
+            if (oldPipeline)
+            {
+                vkDestroyPipeline(device, oldPipeline, nullptr);
+                vkDestroyPipelineLayout(device, oldPipelineLayout, nullptr);
+                vkDestroyRenderPass(device, oldRenderPass, nullptr);
+            }
+        });
+
+        if (formatChanged)
+            InvalidateFrameCommands();
         else
+            viewport.FrameCommands->Invalidate();
+    }
+
+    // Opens another window onto the scene. It shares the device, queues, render pass, pipelines and scene
+    // resources with the main window, so it only adds its own swapchain, targets and the rendering of its view.
+    void OpenViewport()
+    {
+        if (viewports.size() >= MAX_VIEWPORTS)
         {
-            createInfo.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE;
+            std::cout << "Only " << MAX_VIEWPORTS << " viewports can be open at once" << std::endl;
+            return;
         }
 
-        createInfo.preTransform = swapChainDetails.surfaceCapabilities.currentTransform;
-        createInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
-        createInfo.presentMode = presentMode;
-        createInfo.clipped = VK_TRUE;
-        createInfo.oldSwapchain = VK_NULL_HANDLE;
+        // The lowest view no open viewport uses
+        uint32_t view = 1;
+        while (std::any_of(viewports.begin(), viewports.end(), [&](const std::unique_ptr<Viewport>& other) { return other->View == view; }))
+            view++;
 
-        VkResult result = vkCreateSwapchainKHR(device, &createInfo, nullptr, &swapChain);
-        if (result != VK_SUCCESS)
+        auto viewport = std::make_unique<Viewport>();
+        viewport->View = view;
+        viewport->CameraOffset = 7.5f * float(view);
+        CreateViewportWindow(*viewport, "Viewport " + std::to_string(view), 640, 360);
+
+        VkBool32 presentSupport = VK_FALSE;
+        if (glfwCreateWindowSurface(vkInstance, viewport->Window, nullptr, &viewport->Surface) == VK_SUCCESS)
+            vkGetPhysicalDeviceSurfaceSupportKHR(physicalDevice, FindQueueFamilies(physicalDevice).PresentFamily, viewport->Surface, &presentSupport);
+
+        bool created = presentSupport && CreateSwapChain(*viewport) && viewport->SwapChain->GetFormat() == GetColorFormat();
+        if (!created)
         {
-            std::cout << "Couldn't create swapchain!" << std::endl;
-            __debugbreak();
+            std::cout << "Error: Couldn't create a swapchain in the main window's format for a new viewport!" << std::endl;
+            DestroyViewport(*viewport);
+            return;
         }
 
-        vkGetSwapchainImagesKHR(device, swapChain, &imageCount, nullptr);
-        swapChainImages.resize(imageCount);
-        vkGetSwapchainImagesKHR(device, swapChain, &imageCount, swapChainImages.data());
+        CreateAttachments(*viewport);
+        CreateFrameBuffers(*viewport);
+        CreateViewportCommands(*viewport);
+        sceneRenderer.Resize(view, viewport->SwapChain->GetExtent(), deletionQueue, frameNumber);
+
+        std::cout << "Opened " << viewport->Properties.Title << ", " << viewports.size() + 1 << " viewports" << std::endl;
+        viewports.push_back(std::move(viewport));
+    }
+
+    // Closing a window is rare enough to wait for the device rather than retire everything the viewport owns
+    void CloseViewport(size_t index)
+    {
+        vkDeviceWaitIdle(device);
+
+        Viewport& viewport = *viewports[index];
+        sceneRenderer.RemoveView(viewport.View, deletionQueue, frameNumber);
+        DestroyViewport(viewport);
 
-        swapChainImageFormat = surfaceFormat.format;
-        swapChainExtent = extent;
+        viewports.erase(viewports.begin() + index);
+        std::cout << viewports.size() << (viewports.size() == 1 ? " viewport" : " viewports") << " left open" << std::endl;
     }
 
-    void CreateImageViews()
+    void CreateViewportCommands(Viewport& viewport)
     {
-        swapChainImageViews.resize(swapChainImages.size());
+        uint32_t graphicsFamily = FindQueueFamilies(physicalDevice).GraphicsFamily;
+
+        VkCommandPoolCreateInfo commandPoolInfo{};
+        commandPoolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        commandPoolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+        commandPoolInfo.queueFamilyIndex = graphicsFamily;
 
-        for (int i = 0; i < swapChainImages.size(); i++)
+        if (vkCreateCommandPool(device, &commandPoolInfo, nullptr, &viewport.CommandPool) != VK_SUCCESS)
         {
-            VkImageViewCreateInfo createInfo{};
-            createInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
-            createInfo.image = swapChainImages[i];
-            createInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
-            createInfo.format = swapChainImageFormat;
-            createInfo.components.r = VK_COMPONENT_SWIZZLE_IDENTITY;
-            createInfo.components.g = VK_COMPONENT_SWIZZLE_IDENTITY;
-            createInfo.components.b = VK_COMPONENT_SWIZZLE_IDENTITY;
-            createInfo.components.a = VK_COMPONENT_SWIZZLE_IDENTITY;
-            createInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-            createInfo.subresourceRange.baseMipLevel = 0;
-            createInfo.subresourceRange.levelCount = 1;
-            createInfo.subresourceRange.baseArrayLayer = 0;
-            createInfo.subresourceRange.layerCount = 1;
+            std::cout << "Error: Couldn't create the viewport's command pool!" << std::endl;
+            __debugbreak();
+        }
 
-            VkResult result = vkCreateImageView(device, &createInfo, nullptr, &swapChainImageViews[i]);
-            if (result != VK_SUCCESS)
+        viewport.SetupCommandBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+        viewport.FinishCommandBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+
+        VkCommandBufferAllocateInfo allocateInfo{};
+        allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocateInfo.commandPool = viewport.CommandPool;
+        allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        allocateInfo.commandBufferCount = MAX_FRAMES_IN_FLIGHT;
+
+        if (vkAllocateCommandBuffers(device, &allocateInfo, viewport.SetupCommandBuffers.data()) != VK_SUCCESS ||
+            vkAllocateCommandBuffers(device, &allocateInfo, viewport.FinishCommandBuffers.data()) != VK_SUCCESS)
+        {
+            std::cout << "Error: Couldn't allocate the viewport's command buffers!" << std::endl;
+            __debugbreak();
+        }
+
+        viewport.FrameCommands = std::make_unique<LearningVK::CommandCache>(device, graphicsFamily);
+
+        VkSemaphoreCreateInfo semaphoreInfo{};
+        semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+        viewport.ImageAvailableSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
+        for (VkSemaphore& semaphore : viewport.ImageAvailableSemaphores)
+        {
+            if (vkCreateSemaphore(device, &semaphoreInfo, nullptr, &semaphore) != VK_SUCCESS)
+                throw std::runtime_error("failed to create synchronization objects for a viewport!");
+        }
+    }
+
+    // Only call this once the GPU is done with the viewport
+    void DestroyViewport(Viewport& viewport)
+    {
+        viewport.FrameCommands.reset();
+        if (viewport.CommandPool)
+            vkDestroyCommandPool(device, viewport.CommandPool, nullptr);
+        for (VkSemaphore semaphore : viewport.ImageAvailableSemaphores)
+            vkDestroySemaphore(device, semaphore, nullptr);
+
+        for (VkFramebuffer frameBuffer : viewport.Framebuffers)
+            vkDestroyFramebuffer(device, frameBuffer, nullptr);
+        LearningVK::DestroyAttachment(device, viewport.ColorTarget);
+        LearningVK::DestroyAttachment(device, viewport.DepthTarget);
+
+        viewport.SwapChain.reset();
+        if (viewport.Surface)
+            vkDestroySurfaceKHR(vkInstance, viewport.Surface, nullptr);
+        RunOnEventThread([&]() { glfwDestroyWindow(viewport.Window); });
+    }
+
+    // For anything every viewport's cached commands record, like pipelines or the culling setting
+    void InvalidateFrameCommands()
+    {
+        for (std::unique_ptr<Viewport>& viewport : viewports)
+            viewport->FrameCommands->Invalidate();
+    }
+
+    void ChooseAttachmentFormats()
+    {
+        VkPhysicalDeviceProperties properties;
+        vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+
+        VkSampleCountFlags supportedSamples = properties.limits.framebufferColorSampleCounts & properties.limits.framebufferDepthSampleCounts;
+        msaaSamples = requestedMsaaSamples;
+        while (msaaSamples > VK_SAMPLE_COUNT_1_BIT && !(supportedSamples & msaaSamples))
+            msaaSamples = VkSampleCountFlagBits(msaaSamples >> 1);
+
+        // The occlusion pre-pass samples its depth to build the depth pyramid
+        std::array<VkFormat, 3> depthCandidates = { VK_FORMAT_D32_SFLOAT, VK_FORMAT_D32_SFLOAT_S8_UINT, VK_FORMAT_D24_UNORM_S8_UINT };
+        VkFormatFeatureFlags depthFeatures = VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT;
+        depthFormat = VK_FORMAT_UNDEFINED;
+        for (VkFormat format : depthCandidates)
+        {
+            VkFormatProperties formatProperties;
+            vkGetPhysicalDeviceFormatProperties(physicalDevice, format, &formatProperties);
+            if ((formatProperties.optimalTilingFeatures & depthFeatures) == depthFeatures)
             {
-                std::cout << "Couldn't create image view number " << i << "!" << std::endl;
-                __debugbreak();
+                depthFormat = format;
+                break;
             }
         }
+
+        if (depthFormat == VK_FORMAT_UNDEFINED)
+        {
+            std::cout << "Error: Couldn't find a supported depth format!" << std::endl;
+            __debugbreak();
+        }
+    }
+
+    void CreateAttachments(Viewport& viewport)
+    {
+        // Neither target outlives the render pass, so both are transient and never stored to memory
+        LearningVK::AttachmentSpecification depthSpecification;
+        depthSpecification.Extent = viewport.SwapChain->GetExtent();
+        depthSpecification.Format = depthFormat;
+        depthSpecification.Samples = msaaSamples;
+        depthSpecification.Usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+        depthSpecification.Aspect = VK_IMAGE_ASPECT_DEPTH_BIT;
+        depthSpecification.Transient = true;
+
+        if (!LearningVK::CreateAttachment(device, physicalDevice, depthSpecification, viewport.DepthTarget))
+            __debugbreak();
+
+        if (msaaSamples == VK_SAMPLE_COUNT_1_BIT)
+            return;
+
+        LearningVK::AttachmentSpecification colorSpecification;
+        colorSpecification.Extent = viewport.SwapChain->GetExtent();
+        colorSpecification.Format = viewport.SwapChain->GetFormat();
+        colorSpecification.Samples = msaaSamples;
+        colorSpecification.Usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+        colorSpecification.Transient = true;
+
+        if (!LearningVK::CreateAttachment(device, physicalDevice, colorSpecification, viewport.ColorTarget))
+            __debugbreak();
     }
 
     void CreateRenderPass()
     {   
+        bool multisampled = msaaSamples != VK_SAMPLE_COUNT_1_BIT;
+
+        // With MSAA the color is resolved into the swapchain image at the end of the subpass,
+        // so the multisampled color never has to be written out
         VkAttachmentDescription colorAttachment{};
-        colorAttachment.format = swapChainImageFormat;
-        colorAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+        colorAttachment.format = GetColorFormat();
+        colorAttachment.samples = msaaSamples;
         colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-        colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+        colorAttachment.storeOp = multisampled ? VK_ATTACHMENT_STORE_OP_DONT_CARE : VK_ATTACHMENT_STORE_OP_STORE;
         colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
         colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
         colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-        colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+        colorAttachment.finalLayout = multisampled ? VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+
+        VkAttachmentDescription depthAttachment{};
+        depthAttachment.format = depthFormat;
+        depthAttachment.samples = msaaSamples;
+        depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+        depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        depthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        depthAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        depthAttachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+        VkAttachmentDescription resolveAttachment{};
+        resolveAttachment.format = GetColorFormat();
+        resolveAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+        resolveAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        resolveAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+        resolveAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        resolveAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        resolveAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        resolveAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
 
         VkAttachmentReference colorAttachmentRef{};
         colorAttachmentRef.attachment = 0;
         colorAttachmentRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 
+        VkAttachmentReference depthAttachmentRef{};
+        depthAttachmentRef.attachment = 1;
+        depthAttachmentRef.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+        VkAttachmentReference resolveAttachmentRef{};
+        resolveAttachmentRef.attachment = 2;
+        resolveAttachmentRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
         VkSubpassDescription subpassDescription{};
         subpassDescription.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
         subpassDescription.colorAttachmentCount = 1;
         subpassDescription.pColorAttachments = &colorAttachmentRef;
+        subpassDescription.pDepthStencilAttachment = &depthAttachmentRef;
+        if (multisampled)
+            subpassDescription.pResolveAttachments = &resolveAttachmentRef;
 
         VkSubpassDependency dependency{};
         dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
         dependency.dstSubpass = 0;
-        dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-        dependency.srcAccessMask = 0;
-        dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-        dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+        dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+        // Every frame in flight shares the color and depth targets, so the clear has to wait for the last frame's writes
+        dependency.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+        dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+        dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+
+        std::vector<VkAttachmentDescription> attachments = { colorAttachment, depthAttachment };
+        if (multisampled)
+            attachments.push_back(resolveAttachment);
 
         VkRenderPassCreateInfo renderPassInfo{};
         renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-        renderPassInfo.attachmentCount = 1;
-        renderPassInfo.pAttachments = &colorAttachment;
+        renderPassInfo.attachmentCount = uint32_t(attachments.size());
+        renderPassInfo.pAttachments = attachments.data();
         renderPassInfo.subpassCount = 1;
         renderPassInfo.pSubpasses = &subpassDescription;
         renderPassInfo.dependencyCount = 1;
@@ -470,13 +1058,54 @@ private:
         }
     }
 
+    void LoadShaders()
+    {
+        if (!shaderLibrary.Load("res/shaders.pack"))
+        {
+            std::cout << "Error: Couldn't load shaders, build SandboxVK or run compileShaders.bat first!" << std::endl;
+            __debugbreak();
+        }
+    }
+
+    // Hot-swaps the graphics pipeline with freshly compiled shaders, the old one is retired
+    // through the deletion queue since frames in flight may still be using it
+    void ReloadShaders()
+    {
+        if (!shaderLibrary.Load("res/shaders.pack"))
+            return;
+
+        VkPipeline oldPipeline = graphicsPipeline;
+        VkPipelineLayout oldPipelineLayout = pipelineLayout;
+        CreateGraphicsPipeline();
+
+        VkDevice device = this->device;
+        deletionQueue.Push(frameNumber, [=]() {
+            vkDestroyPipeline(device, oldPipeline, nullptr);
+            vkDestroyPipelineLayout(device, oldPipelineLayout, nullptr);
+        });
+
+        particles.RecreateGraphicsPipeline(renderPass, deletionQueue, frameNumber);
+        sceneRenderer.RecreatePipelines(renderPass, deletionQueue, frameNumber);
+        lighting.RecreatePipeline(deletionQueue, frameNumber);
+        overlay.RecreatePipeline(deletionQueue, frameNumber);
+        InvalidateFrameCommands();
+    }
+
     void CreateGraphicsPipeline()
     {
-        std::vector<char> vertexShader = ReadShaders("res/vert.spv");
-        std::vector<char> fragShader = ReadShaders("res/frag.spv");
+        const LearningVK::ShaderVariant* vertexShader = shaderLibrary.SelectVariant("shader.vert", 0);
+        const LearningVK::ShaderVariant* fragShader = shaderLibrary.SelectVariant("shader.frag", triangleMaterial.Features);
+        if (!vertexShader || !fragShader)
+        {
+            std::cout << "Error: Couldn't find a shader variant for the material!" << std::endl;
+            __debugbreak();
+        }
 
-        VkShaderModule vertShaderModule = CreateShaderModule(vertexShader);
-        VkShaderModule fragShaderModule = CreateShaderModule(fragShader);
+        VkShaderModule vertShaderModule = CreateShaderModule(vertexShader->Code);
+        VkShaderModule fragShaderModule = CreateShaderModule(fragShader->Code);
+
+        LearningVK::SpecializationConstants fragConstants;
+        fragConstants.Set(0, triangleMaterial.Brightness);
 
         VkPipelineShaderStageCreateInfo vertShaderStageCreateInfo{};
         vertShaderStageCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
@@ -489,6 +1118,7 @@ private:
         fragShaderStageCreateInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
         fragShaderStageCreateInfo.module = fragShaderModule;
         fragShaderStageCreateInfo.pName = "main";
+        fragShaderStageCreateInfo.pSpecializationInfo = fragConstants.GetInfo();
 
         VkPipelineShaderStageCreateInfo shaderStages[] = { vertShaderStageCreateInfo, fragShaderStageCreateInfo };
 
@@ -520,7 +1150,15 @@ private:
         VkPipelineMultisampleStateCreateInfo multisampling{};
         multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
         multisampling.sampleShadingEnable = VK_FALSE;
-        multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+        multisampling.rasterizationSamples = msaaSamples;
+
+        VkPipelineDepthStencilStateCreateInfo depthStencil{};
+        depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+        depthStencil.depthTestEnable = VK_TRUE;
+        depthStencil.depthWriteEnable = VK_TRUE;
+        depthStencil.depthCompareOp = VK_COMPARE_OP_LESS;
+        depthStencil.depthBoundsTestEnable = VK_FALSE;
+        depthStencil.stencilTestEnable = VK_FALSE;
 
         VkPipelineColorBlendAttachmentState colorBlendAttachment{};
         colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
@@ -567,6 +1205,7 @@ private:
         graphicsPipelineInfo.pViewportState = &viewportState;
         graphicsPipelineInfo.pRasterizationState = &rasterizer;
         graphicsPipelineInfo.pMultisampleState = &multisampling;
+        graphicsPipelineInfo.pDepthStencilState = &depthStencil;
         graphicsPipelineInfo.pColorBlendState = &colorBlending;
         graphicsPipelineInfo.pDynamicState = &dynamicState;
         graphicsPipelineInfo.layout = pipelineLayout;
@@ -585,26 +1224,30 @@ private:
         vkDestroyShaderModule(device, fragShaderModule, nullptr);
     }
 
-    void CreateFrameBuffers()
+    void CreateFrameBuffers(Viewport& viewport)
     {
-        swapChainFramebuffers.resize(swapChainImageViews.size());
+        const std::vector<VkImageView>& imageViews = viewport.SwapChain->GetImageViews();
+        VkExtent2D extent = viewport.SwapChain->GetExtent();
+        viewport.Framebuffers.resize(imageViews.size());
 
-        for (int i = 0; i < swapChainImageViews.size(); i++)
+        for (int i = 0; i < imageViews.size(); i++)
         {
-            VkImageView attachments[] = {
-                swapChainImageViews[i]
-            };
+            std::vector<VkImageView> attachments;
+            if (msaaSamples != VK_SAMPLE_COUNT_1_BIT)
+                attachments = { viewport.ColorTarget.View, viewport.DepthTarget.View, imageViews[i] };
+            else
+                attachments = { imageViews[i], viewport.DepthTarget.View };
 
             VkFramebufferCreateInfo frameBufferInfo{};
             frameBufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
             frameBufferInfo.renderPass = renderPass;
-            frameBufferInfo.attachmentCount = 1;
-            frameBufferInfo.pAttachments = attachments;
-            frameBufferInfo.width = swapChainExtent.width;
-            frameBufferInfo.height = swapChainExtent.height;
+            frameBufferInfo.attachmentCount = uint32_t(attachments.size());
+            frameBufferInfo.pAttachments = attachments.data();
+            frameBufferInfo.width = extent.width;
+            frameBufferInfo.height = extent.height;
             frameBufferInfo.layers = 1;
 
-            VkResult result = vkCreateFramebuffer(device, &frameBufferInfo, nullptr, &swapChainFramebuffers[i]);
+            VkResult result = vkCreateFramebuffer(device, &frameBufferInfo, nullptr, &viewport.Framebuffers[i]);
             if (result != VK_SUCCESS)
             {
                 std::cout << "Error: Couldn't create framebuffer!" << std::endl;
@@ -628,176 +1271,1299 @@ private:
             std::cout << "Error: Couldn't create command pool!" << std::endl;
             __debugbreak();
         }
+
+        commandPoolInfo.queueFamilyIndex = indices.ComputeFamily;
+        result = vkCreateCommandPool(device, &commandPoolInfo, nullptr, &computeCommandPool);
+        if (result != VK_SUCCESS)
+        {
+            std::cout << "Error: Couldn't create compute command pool!" << std::endl;
+            __debugbreak();
+        }
     }
 
-    void CreateCommandBuffer()
+    void CreateCommandBuffers()
     {
+        computeCommandBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+
         VkCommandBufferAllocateInfo allocateInfo{};
         allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-        allocateInfo.commandPool = commandPool;
+        allocateInfo.commandPool = computeCommandPool;
         allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-        allocateInfo.commandBufferCount = 1;
+        allocateInfo.commandBufferCount = uint32_t(computeCommandBuffers.size());
 
-        VkResult result = vkAllocateCommandBuffers(device, &allocateInfo, &commandBuffer);
+        VkResult result = vkAllocateCommandBuffers(device, &allocateInfo, computeCommandBuffers.data());
         if (result != VK_SUCCESS)
         {
-            std::cout << "Error: Couldn't allocate command buffer!" << std::endl;
+            std::cout << "Error: Couldn't allocate compute command buffer!" << std::endl;
             __debugbreak();
         }
+
+        CreateViewportCommands(*viewports[0]);
     }
 
-    void RecordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex)
+    void CreateParticleSimulation()
     {
-        VkCommandBufferBeginInfo beginInfo{};
-        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        QueueFamilyIndices indices = FindQueueFamilies(physicalDevice);
 
-        VkResult beginCommandBufferResult = vkBeginCommandBuffer(commandBuffer, &beginInfo);
-        if (beginCommandBufferResult != VK_SUCCESS)
-        {
-            std::cout << "Error: Couldn't begin command buffer!" << std::endl;
-            __debugbreak();
-        }
+        ParticleSimulationSpecification specification;
+        specification.Device = device;
+        specification.PhysicalDevice = physicalDevice;
+        specification.QueueFamilies = { indices.GraphicsFamily, indices.ComputeFamily };
+        specification.UploadQueue = graphicsQueue;
+        specification.UploadCommandPool = commandPool;
+        specification.Shaders = &shaderLibrary;
+        specification.RenderPass = renderPass;
+        specification.Samples = msaaSamples;
+        particles.Init(specification);
+
+        lastFrameTime = std::chrono::steady_clock::now();
+    }
 
-        VkRenderPassBeginInfo renderPassBeginInfo{};
-        renderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-        renderPassBeginInfo.renderPass = renderPass;
-        renderPassBeginInfo.framebuffer = swapChainFramebuffers[imageIndex];
-        renderPassBeginInfo.renderArea.offset = { 0,0 };
-        renderPassBeginInfo.renderArea.extent = swapChainExtent;
+    void CreateClusteredLighting()
+    {
+        ClusteredLightingSpecification specification;
+        specification.Device = device;
+        specification.PhysicalDevice = physicalDevice;
+        specification.Queue = graphicsQueue;
+        specification.CommandPool = commandPool;
+        specification.Shaders = &shaderLibrary;
+        GetRoomsSceneBounds(specification.BoundsMin, specification.BoundsMax);
+        // Slots are numbered like the scene renderer's, every viewport's frames have their own
+        specification.FramesInFlight = MAX_FRAMES_IN_FLIGHT * MAX_VIEWPORTS;
+        lighting.Init(specification);
+    }
 
-        VkClearValue clearColor = { 0.0f, 0.0f, 0.0f, 1.0f };
-        renderPassBeginInfo.clearValueCount = 1;
-        renderPassBeginInfo.pClearValues = &clearColor;
+    void CreateSceneRenderer()
+    {
+        SceneRendererSpecification specification;
+        specification.Device = device;
+        specification.PhysicalDevice = physicalDevice;
+        specification.UploadQueue = graphicsQueue;
+        specification.UploadCommandPool = commandPool;
+        specification.Shaders = &shaderLibrary;
+        specification.RenderPass = renderPass;
+        specification.Samples = msaaSamples;
+        specification.DepthFormat = depthFormat;
+        specification.Extent = viewports[0]->SwapChain->GetExtent();
+        specification.Lighting = &lighting;
+        specification.FramesInFlight = MAX_FRAMES_IN_FLIGHT;
+        specification.ViewCount = MAX_VIEWPORTS;
+        sceneRenderer.Init(specification);
+
+        startTime = std::chrono::steady_clock::now();
+        lastTitleUpdate = startTime;
+    }
 
-        vkCmdBeginRenderPass(commandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+    void CreateStatsOverlay()
+    {
+        StatsOverlaySpecification specification;
+        specification.Device = device;
+        specification.PhysicalDevice = physicalDevice;
+        specification.UploadQueue = graphicsQueue;
+        specification.UploadCommandPool = commandPool;
+        specification.Shaders = &shaderLibrary;
+        // Only drawn in the main window
+        specification.ColorFormat = GetColorFormat();
+        specification.Extent = viewports[0]->SwapChain->GetExtent();
+        specification.ImageViews = viewports[0]->SwapChain->GetImageViews();
+        specification.FramesInFlight = MAX_FRAMES_IN_FLIGHT;
+        overlay.Init(specification);
+    }
 
-        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline);
+    float GetSceneTimeAt(std::chrono::steady_clock::time_point time) const
+    {
+        if (scenePaused)
+            time = pauseStart;
+        return std::chrono::duration<float>(time - startTime - pausedDuration).count();
+    }
 
-        VkViewport viewPort{};
-        viewPort.x = 0.0f;
-        viewPort.y = 0.0f;
-        viewPort.width = float(swapChainExtent.width);
-        viewPort.height = float(swapChainExtent.height);
-        viewPort.minDepth = 0.0f;
-        viewPort.maxDepth = 1.0f;
-        vkCmdSetViewport(commandBuffer, 0, 1, &viewPort);
+    float GetSceneTime() const
+    {
+        return GetSceneTimeAt(std::chrono::steady_clock::now());
+    }
 
-        VkRect2D scissors{};
-        scissors.offset = { 0, 0 };
-        scissors.extent = swapChainExtent;
-        vkCmdSetScissor(commandBuffer, 0, 1, &scissors);
+    void SetScenePaused(bool paused, std::chrono::steady_clock::time_point time)
+    {
+        if (paused == scenePaused)
+            return;
 
-        vkCmdDraw(commandBuffer, 3, 1, 0, 0);
+        // Events that arrived while the last frame waited for its fence or image are older than that frame, so
+        // the scene would step back to them
+        time = std::max(time, lastFrameTime);
 
-        vkCmdEndRenderPass(commandBuffer);
-        VkResult endCommandBufferResult = vkEndCommandBuffer(commandBuffer);
-        if (endCommandBufferResult != VK_SUCCESS)
-        {
-            std::cout << "Error: Couldn't end the command buffer!" << std::endl;
-            __debugbreak();
-        }
+        if (paused)
+            pauseStart = time;
+        else
+            pausedDuration += time - pauseStart;
+        scenePaused = paused;
     }
 
-    void DrawFrame()
+    void GetSceneView(float time, VkExtent2D extent, glm::vec3& cameraPosition, glm::mat4& view, glm::mat4& projection)
     {
-        vkWaitForFences(device, 1, &inFlightFence, VK_TRUE, UINT64_MAX);
-        vkResetFences(device, 1, &inFlightFence);
-
-        uint32_t imageIndex;
-        vkAcquireNextImageKHR(device, swapChain, UINT64_MAX, imageAvailableSemaphore, nullptr, &imageIndex);
+        glm::vec3 cameraTarget;
+        GetSceneCamera(time, cameraPosition, cameraTarget);
 
-        vkResetCommandBuffer(commandBuffer, 0);
-        RecordCommandBuffer(commandBuffer, imageIndex);
+        view = glm::lookAt(cameraPosition, cameraTarget, glm::vec3(0.0f, 1.0f, 0.0f));
+        projection = glm::perspective(glm::radians(70.0f), float(extent.width) / float(extent.height), SCENE_NEAR_PLANE, SCENE_FAR_PLANE);
+        // Vulkan's clip space y points down
+        projection[1][1] *= -1.0f;
+    }
 
-        VkSubmitInfo submitInfo{};
-        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    uint32_t GetFrameSlot(const Viewport& viewport) const
+    {
+        return sceneRenderer.GetFrameSlot(viewport.View, currentFrame);
+    }
 
-        VkSemaphore waitSemaphores[] = { imageAvailableSemaphore };
-        VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
-        submitInfo.waitSemaphoreCount = 1;
-        submitInfo.pWaitSemaphores = waitSemaphores;
-        submitInfo.pWaitDstStageMask = waitStages;
+    // The lights are animated on the calling thread, so every viewport is updated here and only recorded in parallel
+    void UpdateScene(const std::vector<Viewport*>& drawnViewports)
+    {
+        float time = sceneTime;
 
-        submitInfo.commandBufferCount = 1;
-        submitInfo.pCommandBuffers = &commandBuffer;
+        for (Viewport* viewport : drawnViewports)
+        {
+            uint32_t frameSlot = GetFrameSlot(*viewport);
+            VkExtent2D extent = viewport->SwapChain->GetExtent();
 
-        VkSemaphore signalSemaphores[] = { renderFinishedSemaphore };
-        submitInfo.signalSemaphoreCount = 1;
-        submitInfo.pSignalSemaphores = signalSemaphores;
+            glm::vec3 cameraPosition;
+            glm::mat4 view, projection;
+            GetSceneView(time + viewport->CameraOffset, extent, cameraPosition, view, projection);
 
-        VkResult result = vkQueueSubmit(graphicsQueue, 1, &submitInfo, inFlightFence);
-        if (result != VK_SUCCESS)
-        {
-            std::cout << "Error: Couldn't submit to graphics queue!" << std::endl;
-            __debugbreak();
+            sceneRenderer.Update(frameSlot, cameraPosition, view, projection, extent);
+            lighting.Update(frameSlot, time, view, projection, SCENE_NEAR_PLANE, SCENE_FAR_PLANE, extent);
         }
+    }
 
-        VkPresentInfoKHR presentInfo{};
-        presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
-        presentInfo.waitSemaphoreCount = 1;
-        presentInfo.pWaitSemaphores = signalSemaphores;
+    void UpdateStatsTitles()
+    {
+        auto now = std::chrono::steady_clock::now();
+        if (std::chrono::duration<float>(now - lastTitleUpdate).count() < 0.5f)
+            return;
+        lastTitleUpdate = now;
 
-        VkSwapchainKHR swapChains[] = { swapChain };
-        presentInfo.swapchainCount = 1;
-        presentInfo.pSwapchains = swapChains;
-        presentInfo.pImageIndices = &imageIndex;
+        std::vector<std::pair<GLFWwindow*, std::string>> titles;
+        for (std::unique_ptr<Viewport>& viewport : viewports)
+        {
+            const OcclusionCullingStats& stats = viewport->CullingStats;
+            std::string title = viewport->Properties.Title + " - " + std::to_string(stats.GetDrawnObjects()) + "/" + std::to_string(sceneRenderer.GetObjectCount())
+                + " objects, " + std::to_string(stats.GetDrawnTriangles() / 1000) + "k triangles, occlusion culling "
+                + (sceneRenderer.IsOcclusionCullingEnabled() ? "on" : "off") + " (F7), LODs "
+                + (sceneRenderer.IsLodSelectionEnabled() ? "on" : "off") + " (F9)";
+            titles.emplace_back(viewport->Window, title);
+        }
 
-        vkQueuePresentKHR(presentQueue, &presentInfo);
+        // All windows in one trip to the event thread, which doesn't return from glfwWaitEvents() while a window is
+        // dragged on some platforms, so the frame doesn't wait for it. Windows are destroyed through the same
+        // queue, so they're still open when their titles are set.
+        PostToEventThread([titles]() {
+            for (const std::pair<GLFWwindow*, std::string>& title : titles)
+                glfwSetWindowTitle(title.first, title.second.c_str());
+        });
     }
 
-    void CreateSyncObjects()
+    void PrintCullingStats()
     {
-        VkSemaphoreCreateInfo semaphoreInfo{};
-        semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
-
-        VkFenceCreateInfo fenceInfo{};
-        fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-        fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
-
-        if (vkCreateSemaphore(device, &semaphoreInfo, nullptr, &imageAvailableSemaphore) != VK_SUCCESS ||
-            vkCreateSemaphore(device, &semaphoreInfo, nullptr, &renderFinishedSemaphore) != VK_SUCCESS ||
-            vkCreateFence(device, &fenceInfo, nullptr, &inFlightFence) != VK_SUCCESS) {
-            throw std::runtime_error("failed to create synchronization objects for a frame!");
+        for (std::unique_ptr<Viewport>& viewport : viewports)
+        {
+            const OcclusionCullingStats& stats = viewport->CullingStats;
+            std::cout << "Culling in " << viewport->Properties.Title << " (" << sceneRenderer.GetObjectCount() << " objects):" << std::endl;
+            std::cout << "  frustum culled   " << stats.FrustumCulledObjects << " objects, " << stats.FrustumCulledTriangles << " triangles" << std::endl;
+            std::cout << "  early drawn      " << stats.EarlyDrawnObjects << " objects, " << stats.EarlyDrawnTriangles << " triangles" << std::endl;
+            std::cout << "  early occluded   " << stats.EarlyOccludedObjects << " objects, " << stats.EarlyOccludedTriangles << " triangles" << std::endl;
+            std::cout << "  late drawn       " << stats.LateDrawnObjects << " objects, " << stats.LateDrawnTriangles << " triangles" << std::endl;
+            std::cout << "  late occluded    " << stats.LateOccludedObjects << " objects, " << stats.LateOccludedTriangles << " triangles" << std::endl;
         }
     }
 
-    VkShaderModule CreateShaderModule(const std::vector<char>& code)
+    void UpdateOverlay()
     {
-        VkShaderModuleCreateInfo createInfo{};
-        createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-        createInfo.codeSize = (uint32_t)code.size();
-        createInfo.pCode = (const uint32_t*)code.data();
+        smoothedFrameTime = smoothedFrameTime > 0.0f ? glm::mix(smoothedFrameTime, deltaTime, 0.05f) : deltaTime;
 
-        VkShaderModule shaderModule;
-        VkResult result = vkCreateShaderModule(device, &createInfo, nullptr, &shaderModule);
-        if (result != VK_SUCCESS)
+        VkDeviceSize memoryUsage = 0, memoryBudget = 0;
+        for (const LearningVK::MemoryHeapStats& heap : LearningVK::GetMemoryTracker().GetStats().Heaps)
         {
-            std::cout << "Error: Couldn't create a shader module!" << std::endl;
+            if (!heap.DeviceLocal)
+                continue;
+            memoryUsage += heap.Usage;
+            memoryBudget += heap.Budget;
+        }
+
+        const Viewport& mainViewport = *viewports[0];
+        const OcclusionCullingStats& cullingStats = mainViewport.CullingStats;
+        const LearningVK::CommandCacheStats& commandStats = mainViewport.FrameCommands->GetStats();
+        const LearningVK::SpriteBatchStats& overlayStats = overlay.GetBatchStats();
+
+        char frameLine[64];
+        std::snprintf(frameLine, sizeof(frameLine), "%.2f ms (%.0f fps)", smoothedFrameTime * 1000.0f, smoothedFrameTime > 0.0f ? 1.0f / smoothedFrameTime : 0.0f);
+        char inputLine[64];
+        std::snprintf(inputLine, sizeof(inputLine), "Input %.2f ms behind, %llu dropped", smoothedInputLatency * 1000.0f,
+            (unsigned long long)GetDroppedEventCount());
+
+        std::vector<std::string> lines = {
+            frameLine,
+            std::string(inputLine) + (scenePaused ? ", paused (Space)" : ""),
+            "GPU memory " + std::to_string(memoryUsage / (1024 * 1024)) + " / " + std::to_string(memoryBudget / (1024 * 1024)) + " MiB",
+            "Objects " + std::to_string(cullingStats.GetDrawnObjects()) + " / " + std::to_string(sceneRenderer.GetObjectCount())
+                + ", " + std::to_string(cullingStats.GetDrawnTriangles() / 1000) + "k triangles",
+            "Occlusion culled " + std::to_string(cullingStats.LateOccludedObjects)
+                + ", frustum culled " + std::to_string(cullingStats.FrustumCulledObjects),
+            "Occlusion " + std::string(sceneRenderer.IsOcclusionCullingEnabled() ? "on" : "off") + " (F7), LODs "
+                + (sceneRenderer.IsLodSelectionEnabled() ? "on" : "off") + " (F9)",
+            "Commands " + std::to_string(commandStats.Hits) + " reused, " + std::to_string(commandStats.Recordings) + " recorded",
+            "Viewports " + std::to_string(viewports.size()) + " / " + std::to_string(MAX_VIEWPORTS) + " (F2)",
+            "Overlay " + std::to_string(overlayStats.Quads) + " quads, " + std::to_string(overlayStats.Draws) + " draws (F1)"
+        };
+
+        overlay.Update(currentFrame, lines);
+    }
+
+    // Every dispatch reads what the previous one wrote. A draw always waits for the last compute queue dispatch, so
+    // moving to the graphics queue is ordered already. Moving to the compute queue signals a semaphore behind the
+    // graphics queue's work instead, rather than waiting for the device.
+    void SetAsyncCompute(bool enabled)
+    {
+        if (enabled == useAsyncCompute)
+            return;
+
+        // A handoff nobody waited on yet is still behind every dispatch on the graphics queue
+        if (enabled && !queueHandoffPending)
+        {
+            VkSubmitInfo submitInfo{};
+            submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+            submitInfo.signalSemaphoreCount = 1;
+            submitInfo.pSignalSemaphores = &queueHandoffSemaphore;
+
+            if (LearningVK::GetDeviceDispatch().QueueSubmit(graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS)
+            {
+                std::cout << "Error: Couldn't submit the queue handoff to the graphics queue!" << std::endl;
+                __debugbreak();
+            }
+            queueHandoffPending = true;
+        }
+
+        useAsyncCompute = enabled;
+        std::cout << "Particle simulation runs on the " << (enabled ? "compute" : "graphics") << " queue" << std::endl;
+    }
+
+    void SubmitSimulation()
+    {
+        const LearningVK::DeviceDispatch& dispatch = LearningVK::GetDeviceDispatch();
+
+        VkCommandBuffer commandBuffer = computeCommandBuffers[currentFrame];
+        dispatch.ResetCommandBuffer(commandBuffer, 0);
+
+        VkCommandBufferBeginInfo beginInfo{};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+        dispatch.BeginCommandBuffer(commandBuffer, &beginInfo);
+        particles.RecordSimulation(commandBuffer, frameNumber, simulationStep, false);
+        dispatch.EndCommandBuffer(commandBuffer);
+
+        VkSubmitInfo submitInfo{};
+        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers = &commandBuffer;
+        submitInfo.signalSemaphoreCount = 1;
+        submitInfo.pSignalSemaphores = &computeFinishedSemaphores[currentFrame];
+
+        VkPipelineStageFlags handoffStage = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+        if (queueHandoffPending)
+        {
+            submitInfo.waitSemaphoreCount = 1;
+            submitInfo.pWaitSemaphores = &queueHandoffSemaphore;
+            submitInfo.pWaitDstStageMask = &handoffStage;
+            queueHandoffPending = false;
+        }
+
+        if (dispatch.QueueSubmit(computeQueue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS)
+        {
+            std::cout << "Error: Couldn't submit to compute queue!" << std::endl;
             __debugbreak();
         }
+    }
 
-        return shaderModule;
+    // Resets the command buffer and records into it for a single submission
+    void RecordCommandBuffer(VkCommandBuffer commandBuffer, const std::function<void(VkCommandBuffer)>& record)
+    {
+        const LearningVK::DeviceDispatch& dispatch = LearningVK::GetDeviceDispatch();
+
+        dispatch.ResetCommandBuffer(commandBuffer, 0);
+
+        VkCommandBufferBeginInfo beginInfo{};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+        VkResult beginCommandBufferResult = dispatch.BeginCommandBuffer(commandBuffer, &beginInfo);
+        if (beginCommandBufferResult != VK_SUCCESS)
+        {
+            std::cout << "Error: Couldn't begin command buffer!" << std::endl;
+            __debugbreak();
+        }
+
+        record(commandBuffer);
+
+        VkResult endCommandBufferResult = dispatch.EndCommandBuffer(commandBuffer);
+        if (endCommandBufferResult != VK_SUCCESS)
+        {
+            std::cout << "Error: Couldn't end the command buffer!" << std::endl;
+            __debugbreak();
+        }
+    }
+
+    // The commands ahead of the cached frame commands that change every frame. The particles are simulated by the
+    // first viewport submitted, every viewport after it draws them.
+    void RecordFrameSetup(VkCommandBuffer commandBuffer, const Viewport& viewport, bool simulate)
+    {
+        // The pyramid's initialization mustn't end up in commands that are submitted again
+        sceneRenderer.RecordInitialization(commandBuffer, viewport.View);
+        if (simulate && !useAsyncCompute)
+            particles.RecordSimulation(commandBuffer, frameNumber, simulationStep, true);
     }
 
-    std::vector<char> ReadShaders(const std::string& path)
+    // The commands after the cached frame commands that change every frame, the overlay is part of the capture.
+    // Both only happen in the main window.
+    void RecordFrameFinish(VkCommandBuffer commandBuffer, const Viewport& viewport, uint32_t imageIndex)
     {
-        std::ifstream file(path, std::ios::ate | std::ios::binary);
+        if (overlayVisible)
+            overlay.RecordDraw(commandBuffer, imageIndex);
+        // A recreated swapchain keeps the surface's usages, but the copy would be invalid without them
+        if (frameCapture && viewport.SwapChain->SupportsCapture())
+            frameCapture->RecordCopy(commandBuffer, viewport.SwapChain->GetImages()[imageIndex], viewport.SwapChain->GetFormat(), viewport.SwapChain->GetExtent(), frameNumber);
+    }
+
+    // Everything else stays the same from frame to frame, the camera and lights are read from buffers UpdateScene
+    // writes, so these can be recorded once and submitted again. Only the particle buffer alternates by frameIndex.
+    void RecordFrameCommands(VkCommandBuffer commandBuffer, const Viewport& viewport, uint32_t frameSlot, uint32_t imageIndex, uint64_t frameIndex)
+    {
+        const LearningVK::DeviceDispatch& dispatch = LearningVK::GetDeviceDispatch();
+
+        VkExtent2D extent = viewport.SwapChain->GetExtent();
 
-        if (!file.is_open())
+        sceneRenderer.RecordCulling(commandBuffer, frameSlot);
+        lighting.RecordAssignment(commandBuffer, frameSlot);
+
+        VkRenderPassBeginInfo renderPassBeginInfo{};
+        renderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+        renderPassBeginInfo.renderPass = renderPass;
+        renderPassBeginInfo.framebuffer = viewport.Framebuffers[imageIndex];
+        renderPassBeginInfo.renderArea.offset = { 0,0 };
+        renderPassBeginInfo.renderArea.extent = extent;
+
+        std::array<VkClearValue, 2> clearValues{};
+        clearValues[0].color = { { 0.0f, 0.0f, 0.0f, 1.0f } };
+        clearValues[1].depthStencil = { 1.0f, 0 };
+        renderPassBeginInfo.clearValueCount = uint32_t(clearValues.size());
+        renderPassBeginInfo.pClearValues = clearValues.data();
+
+        dispatch.CmdBeginRenderPass(commandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+
+        VkViewport viewPort{};
+        viewPort.x = 0.0f;
+        viewPort.y = 0.0f;
+        viewPort.width = float(extent.width);
+        viewPort.height = float(extent.height);
+        viewPort.minDepth = 0.0f;
+        viewPort.maxDepth = 1.0f;
+        dispatch.CmdSetViewport(commandBuffer, 0, 1, &viewPort);
+
+        VkRect2D scissors{};
+        scissors.offset = { 0, 0 };
+        scissors.extent = extent;
+        dispatch.CmdSetScissor(commandBuffer, 0, 1, &scissors);
+
+        particles.RecordDraw(commandBuffer, frameIndex);
+        sceneRenderer.RecordDraw(commandBuffer, frameSlot);
+
+        dispatch.CmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline);
+        dispatch.CmdDraw(commandBuffer, 3, 1, 0, 0);
+
+        dispatch.CmdEndRenderPass(commandBuffer);
+    }
+
+    // Returns the viewport's cached frame commands, recording them first if they're new or invalidated. The frame
+    // slot's fence has been waited on, so none of the slot's command buffers are in flight anymore.
+    VkCommandBuffer GetFrameCommands(Viewport& viewport, uint32_t imageIndex)
+    {
+        uint32_t particleBuffer = uint32_t(frameNumber % ParticleSimulation::BufferCount);
+        uint64_t key = (uint64_t(currentFrame) << 40) | (uint64_t(particleBuffer) << 32) | imageIndex;
+
+        return viewport.FrameCommands->Get(key, [&](VkCommandBuffer commandBuffer) {
+            RecordFrameCommands(commandBuffer, viewport, GetFrameSlot(viewport), imageIndex, frameNumber);
+        });
+    }
+
+    // Records the viewport's part of the frame into its own command buffers, so viewports can be recorded on
+    // different threads. The frame's own commands come first, ahead of any cached commands recorded for it. What's
+    // drawn over the image and the capture copy come last and are only submitted when there's any of them.
+    uint32_t RecordViewportFrame(Viewport& viewport, bool simulate, std::array<VkCommandBuffer, 3>& submittedBuffers)
+    {
+        uint32_t submittedBufferCount = 0;
+
+        submittedBuffers[submittedBufferCount++] = viewport.SetupCommandBuffers[currentFrame];
+        RecordCommandBuffer(viewport.SetupCommandBuffers[currentFrame], [&](VkCommandBuffer commandBuffer) {
+            RecordFrameSetup(commandBuffer, viewport, simulate);
+        });
+
+        VkCommandBuffer frameCommandBuffer = GetFrameCommands(viewport, viewport.ImageIndex);
+        if (!frameCommandBuffer)
         {
-            std::cout << "Error: Couldn't open shader file!" << std::endl;
+            std::cout << "Error: Couldn't record the frame's commands!" << std::endl;
             __debugbreak();
         }
+        submittedBuffers[submittedBufferCount++] = frameCommandBuffer;
+
+        bool mainWindow = &viewport == viewports[0].get();
+        if (mainWindow && (overlayVisible || frameCapture))
+        {
+            submittedBuffers[submittedBufferCount++] = viewport.FinishCommandBuffers[currentFrame];
+            RecordCommandBuffer(viewport.FinishCommandBuffers[currentFrame], [&](VkCommandBuffer commandBuffer) {
+                RecordFrameFinish(commandBuffer, viewport, viewport.ImageIndex);
+            });
+        }
 
-        size_t fileSize = (size_t)file.tellg();
-        std::vector<char> buffer(fileSize);
+        return submittedBufferCount;
+    }
 
-        file.seekg(0);
-        file.read(buffer.data(), fileSize);
+    // Acquires an image of every window that can be drawn to. Minimized windows are left out, and so are windows
+    // whose swapchain turned out of date, they're recreated before the next frame acquires from them.
+    std::vector<Viewport*> AcquireViewportImages(bool& anyVisible)
+    {
+        std::vector<Viewport*> drawnViewports;
+        anyVisible = false;
 
-        file.close();
+        for (std::unique_ptr<Viewport>& viewport : viewports)
+        {
+            VkExtent2D extent = GetFramebufferExtent(*viewport);
+            if (extent.width == 0 || extent.height == 0 || viewport->Closing)
+                continue;
+            anyVisible = true;
+
+            if (viewport->Resized)
+                RecreateSwapChain(*viewport);
+            if (viewport->Closing)
+                continue;
+
+            VkResult acquireResult = viewport->SwapChain->AcquireNextImage(viewport->ImageAvailableSemaphores[currentFrame], viewport->ImageIndex);
+            if (acquireResult == VK_ERROR_OUT_OF_DATE_KHR)
+            {
+                viewport->Resized = true;
+                continue;
+            }
+            else if (acquireResult != VK_SUCCESS && acquireResult != VK_SUBOPTIMAL_KHR)
+            {
+                std::cout << "Error: Couldn't acquire swapchain image!" << std::endl;
+                __debugbreak();
+            }
 
-        return buffer;
+            drawnViewports.push_back(viewport.get());
+        }
+
+        return drawnViewports;
+    }
+
+    void DrawFrame()
+    {
+        const LearningVK::DeviceDispatch& dispatch = LearningVK::GetDeviceDispatch();
+
+        dispatch.WaitForFences(device, 1, &inFlightFences[currentFrame], VK_TRUE, UINT64_MAX);
+
+        PollCompletedFrames();
+        deletionQueue.Flush(completedFrameCount);
+        LearningVK::GetMemoryTracker().Update();
+        if (frameCapture)
+            frameCapture->Poll(completedFrameCount);
+
+        // The slot's last frame has finished, so the culling stats of the viewports it drew are ready
+        for (std::unique_ptr<Viewport>& viewport : viewports)
+        {
+            if (viewport->SlotSubmitted[currentFrame])
+                viewport->CullingStats = sceneRenderer.CollectStats(GetFrameSlot(*viewport));
+        }
+        UpdateStatsTitles();
+
+        bool anyVisible;
+        std::vector<Viewport*> drawnViewports = AcquireViewportImages(anyVisible);
+        if (drawnViewports.empty())
+        {
+            // The fence is only reset once work is submitted, so the next attempt doesn't wait forever.
+            // Minimized windows have nothing to present to, so wait a little for a resize event to bring one back.
+            if (!anyVisible)
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            return;
+        }
+
+        dispatch.ResetFences(device, 1, &inFlightFences[currentFrame]);
+
+        auto now = std::chrono::steady_clock::now();
+        deltaTime = std::chrono::duration<float>(now - lastFrameTime).count();
+        lastFrameTime = now;
+
+        float time = GetSceneTimeAt(now);
+        simulationStep = time - sceneTime;
+        sceneTime = time;
+
+        // Submitted only once an image was acquired, so its semaphore always has a waiting draw
+        if (useAsyncCompute)
+            SubmitSimulation();
+
+        UpdateScene(drawnViewports);
+        if (overlayVisible && drawnViewports[0] == viewports[0].get())
+            UpdateOverlay();
+
+        // Every viewport records into its own pool, so they're recorded side by side. The first viewport is recorded
+        // here rather than handed to a worker and waited on.
+        std::vector<std::array<VkCommandBuffer, 3>> viewportBuffers(drawnViewports.size());
+        std::vector<uint32_t> viewportBufferCounts(drawnViewports.size(), 0);
+        auto recordViewport = [&](size_t i) {
+            viewportBufferCounts[i] = RecordViewportFrame(*drawnViewports[i], i == 0, viewportBuffers[i]);
+        };
+
+        for (size_t i = 1; i < drawnViewports.size(); i++)
+            recordingThreads.Submit([&, i]() { recordViewport(i); });
+        recordViewport(0);
+        if (drawnViewports.size() > 1)
+            recordingThreads.Wait();
+
+        // One submission for every viewport, in the order they were acquired
+        std::vector<VkCommandBuffer> submittedBuffers;
+        std::vector<VkSemaphore> waitSemaphores;
+        std::vector<VkPipelineStageFlags> waitStages;
+        for (size_t i = 0; i < drawnViewports.size(); i++)
+        {
+            submittedBuffers.insert(submittedBuffers.end(), viewportBuffers[i].begin(), viewportBuffers[i].begin() + viewportBufferCounts[i]);
+            waitSemaphores.push_back(drawnViewports[i]->ImageAvailableSemaphores[currentFrame]);
+            waitStages.push_back(VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+        }
+
+        if (useAsyncCompute)
+        {
+            waitSemaphores.push_back(computeFinishedSemaphores[currentFrame]);
+            waitStages.push_back(VK_PIPELINE_STAGE_VERTEX_INPUT_BIT);
+        }
+        // Switched back before a compute dispatch waited on it, the semaphore has to be waited on before it's signalled again
+        if (queueHandoffPending)
+        {
+            waitSemaphores.push_back(queueHandoffSemaphore);
+            waitStages.push_back(VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+            queueHandoffPending = false;
+        }
+
+        VkSubmitInfo submitInfo{};
+        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.waitSemaphoreCount = uint32_t(waitSemaphores.size());
+        submitInfo.pWaitSemaphores = waitSemaphores.data();
+        submitInfo.pWaitDstStageMask = waitStages.data();
+
+        submitInfo.commandBufferCount = uint32_t(submittedBuffers.size());
+        submitInfo.pCommandBuffers = submittedBuffers.data();
+
+        VkSemaphore signalSemaphores[] = { renderFinishedSemaphores[currentFrame] };
+        submitInfo.signalSemaphoreCount = 1;
+        submitInfo.pSignalSemaphores = signalSemaphores;
+
+        VkResult result = dispatch.QueueSubmit(graphicsQueue, 1, &submitInfo, inFlightFences[currentFrame]);
+        if (result != VK_SUCCESS)
+        {
+            std::cout << "Error: Couldn't submit to graphics queue!" << std::endl;
+            __debugbreak();
+        }
+        inFlightFrameCounts[currentFrame] = frameNumber + 1;
+
+        for (std::unique_ptr<Viewport>& viewport : viewports)
+            viewport->SlotSubmitted[currentFrame] = std::find(drawnViewports.begin(), drawnViewports.end(), viewport.get()) != drawnViewports.end();
+
+        // Every window is presented by one call, each swapchain reports whether it has to be recreated
+        std::vector<LearningVK::SwapchainPresent> presents(drawnViewports.size());
+        for (size_t i = 0; i < drawnViewports.size(); i++)
+        {
+            presents[i].Target = drawnViewports[i]->SwapChain.get();
+            presents[i].ImageIndex = drawnViewports[i]->ImageIndex;
+        }
+
+        VkResult presentResult = LearningVK::PresentSwapchains(presentQueue, { signalSemaphores[0] }, presents);
+        if (presentResult != VK_SUCCESS && presentResult != VK_SUBOPTIMAL_KHR && presentResult != VK_ERROR_OUT_OF_DATE_KHR)
+        {
+            std::cout << "Error: Couldn't present swapchain image!" << std::endl;
+            __debugbreak();
+        }
+
+        for (size_t i = 0; i < drawnViewports.size(); i++)
+        {
+            if (presents[i].Result == VK_ERROR_OUT_OF_DATE_KHR || presents[i].Result == VK_SUBOPTIMAL_KHR)
+                drawnViewports[i]->Resized = true;
+        }
+
+        currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+        frameNumber++;
+    }
+
+    // Checks every in-flight fence without blocking, a signalled fence means its frame and every frame
+    // submitted before it have finished
+    void PollCompletedFrames()
+    {
+        const LearningVK::DeviceDispatch& dispatch = LearningVK::GetDeviceDispatch();
+
+        for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+        {
+            if (inFlightFrameCounts[i] > completedFrameCount && dispatch.GetFenceStatus(device, inFlightFences[i]) == VK_SUCCESS)
+                completedFrameCount = inFlightFrameCounts[i];
+        }
+    }
+
+    void DumpMemoryStats()
+    {
+        std::filesystem::create_directories("captures");
+
+        const LearningVK::MemoryTracker& memoryTracker = LearningVK::GetMemoryTracker();
+        if (!memoryTracker.WriteJSON("captures/memory.json"))
+            return;
+
+        LearningVK::MemoryStats stats = memoryTracker.GetStats();
+        std::cout << "Wrote captures/memory.json, " << stats.AllocationCount << " of " << stats.MaxAllocationCount << " allocations" << std::endl;
+        for (const LearningVK::MemoryHeapStats& heap : stats.Heaps)
+        {
+            std::cout << "  Heap " << heap.HeapIndex << (heap.DeviceLocal ? " (device local)" : "") << ": " << heap.Usage / (1024 * 1024)
+                << " of " << heap.Budget / (1024 * 1024) << " MiB, peak " << heap.Peak / (1024 * 1024) << " MiB" << std::endl;
+        }
+    }
+
+    // Renders the scene's current view at a resolution no swapchain or framebuffer could hold, tile by tile
+    void RenderStill()
+    {
+        vkDeviceWaitIdle(device);
+        std::filesystem::create_directories("captures");
+
+        LearningVK::TiledRenderSpecification specification;
+        specification.Extent = { 16384, 9216 };
+        specification.ColorFormat = GetColorFormat();
+        specification.DepthFormat = depthFormat;
+        specification.Samples = msaaSamples;
+        // Every tile slot maps to a frame slot of the scene renderer and lighting
+        specification.PoolSize = MAX_FRAMES_IN_FLIGHT;
+        specification.OutputPath = "captures/still.ppm";
+
+        LearningVK::TiledRenderer tiledRenderer(device, physicalDevice, graphicsQueue, FindQueueFamilies(physicalDevice).GraphicsFamily, specification);
+
+        float time = GetSceneTime();
+        glm::vec3 cameraPosition;
+        glm::mat4 view, projection;
+        GetSceneView(time, specification.Extent, cameraPosition, view, projection);
+
+        auto recordPrepare = [&](VkCommandBuffer commandBuffer, const LearningVK::Tile& tile) {
+            glm::mat4 tileProjection = tile.ProjectionOffset * projection;
+            sceneRenderer.Update(tile.Slot, cameraPosition, view, tileProjection, tile.Extent);
+            lighting.Update(tile.Slot, time, view, tileProjection, SCENE_NEAR_PLANE, SCENE_FAR_PLANE, tile.Extent);
+            sceneRenderer.RecordCulling(commandBuffer, tile.Slot);
+            lighting.RecordAssignment(commandBuffer, tile.Slot);
+        };
+        auto recordDraw = [&](VkCommandBuffer commandBuffer, const LearningVK::Tile& tile) {
+            sceneRenderer.RecordDraw(commandBuffer, tile.Slot);
+        };
+
+        bool rendered = tiledRenderer.Render(recordPrepare, recordDraw);
+        vkDeviceWaitIdle(device);
+
+        const LearningVK::TiledRenderStats& stats = tiledRenderer.GetStats();
+        if (!rendered)
+        {
+            std::cout << "Error: Couldn't render " << specification.OutputPath << "!" << std::endl;
+            return;
+        }
+
+        std::cout << "Rendered " << specification.Extent.width << "x" << specification.Extent.height << " to " << specification.OutputPath
+            << " in " << stats.TileCount << " tiles of " << stats.TileExtent.width << "x" << stats.TileExtent.height
+            << ", " << stats.PoolMemory / (1024.0 * 1024.0) << " MB of tile memory, " << stats.BytesWritten / (1024.0 * 1024.0) << " MB written in "
+            << stats.Seconds << " s" << std::endl;
+    }
+
+    void StartCapture()
+    {
+        if (!viewports[0]->SwapChain->SupportsCapture())
+        {
+            std::cout << "Error: The main window's swapchain images can't be copied from, so frames can't be captured!" << std::endl;
+            return;
+        }
+
+        LearningVK::FrameCaptureSpecification specification;
+        specification.OutputDirectory = "captures";
+        specification.Format = LearningVK::CaptureFormat::PNG;
+        frameCapture = std::make_shared<LearningVK::FrameCapture>(device, physicalDevice, specification);
+
+        std::cout << "Started capturing frames to " << specification.OutputDirectory << std::endl;
+    }
+
+    // The readback buffers may still be written by frames in flight, so the capture is only finished
+    // and torn down once those frames are done
+    void StopCapture()
+    {
+        std::shared_ptr<LearningVK::FrameCapture> capture = std::move(frameCapture);
+        deletionQueue.Push(frameNumber, [capture]() {
+            capture->Poll(UINT64_MAX);
+            capture->Wait();
+
+            LearningVK::FrameCaptureStats stats = capture->GetStats();
+            std::cout << "Captured " << stats.FramesWritten << " frames (" << stats.FramesDropped << " dropped) in " << stats.Seconds << "s: "
+                << stats.GetFramesPerSecond() << " frames/sec, " << stats.GetMegabytesPerSecond() << " MB/s" << std::endl;
+        });
+    }
+
+    void CreateSyncObjects()
+    {
+        VkSemaphoreCreateInfo semaphoreInfo{};
+        semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+        VkFenceCreateInfo fenceInfo{};
+        fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+        fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+
+        renderFinishedSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
+        computeFinishedSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
+        inFlightFences.resize(MAX_FRAMES_IN_FLIGHT);
+
+        for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+        {
+            if (vkCreateSemaphore(device, &semaphoreInfo, nullptr, &renderFinishedSemaphores[i]) != VK_SUCCESS ||
+                vkCreateSemaphore(device, &semaphoreInfo, nullptr, &computeFinishedSemaphores[i]) != VK_SUCCESS ||
+                vkCreateFence(device, &fenceInfo, nullptr, &inFlightFences[i]) != VK_SUCCESS) {
+                throw std::runtime_error("failed to create synchronization objects for a frame!");
+            }
+        }
+
+        if (vkCreateSemaphore(device, &semaphoreInfo, nullptr, &queueHandoffSemaphore) != VK_SUCCESS)
+            throw std::runtime_error("failed to create the queue handoff semaphore!");
+    }
+
+#if VK_RUN_BENCHMARKS
+    void RunBenchmarks()
+    {
+        BenchmarkAttachmentFootprint();
+        BenchmarkParticleQueues();
+        BenchmarkLightAssignment();
+        BenchmarkCommandReuse();
+        BenchmarkViewportRecording();
+        BenchmarkDeviceDispatch();
+        BenchmarkSpriteBatch();
+        BenchmarkTextureStreaming();
+    }
+
+    // Writes a set of RGBA texture files with full mip chains, unless they're there from an earlier run
+    std::vector<std::string> GenerateStreamingTextures(uint32_t count, uint32_t size)
+    {
+        std::filesystem::create_directories("textures");
+
+        std::vector<std::string> paths;
+        for (uint32_t i = 0; i < count; i++)
+        {
+            std::string path = "textures/streaming" + std::to_string(i) + ".lvkt";
+            paths.push_back(path);
+            if (std::filesystem::exists(path))
+                continue;
+
+            // Checkers of a colour of their own, so every texture compresses about as well as the others
+            std::vector<std::vector<uint8_t>> levels(1, std::vector<uint8_t>(size_t(size) * size * 4));
+            for (uint32_t y = 0; y < size; y++)
+            {
+                for (uint32_t x = 0; x < size; x++)
+                {
+                    uint8_t* texel = &levels[0][(size_t(y) * size + x) * 4];
+                    bool checker = ((x / 32) + (y / 32)) % 2 == 0;
+                    texel[0] = checker ? uint8_t(i * 37) : uint8_t(x * 255 / size);
+                    texel[1] = checker ? uint8_t(i * 91) : uint8_t(y * 255 / size);
+                    texel[2] = checker ? uint8_t(i * 53) : 64;
+                    texel[3] = 255;
+                }
+            }
+
+            for (uint32_t mipSize = size / 2; mipSize > 0; mipSize /= 2)
+            {
+                const std::vector<uint8_t>& previous = levels.back();
+                std::vector<uint8_t> level(size_t(mipSize) * mipSize * 4);
+                for (uint32_t y = 0; y < mipSize; y++)
+                {
+                    for (uint32_t x = 0; x < mipSize; x++)
+                    {
+                        for (uint32_t channel = 0; channel < 4; channel++)
+                        {
+                            auto at = [&](uint32_t px, uint32_t py) { return uint32_t(previous[(size_t(py) * mipSize * 2 + px) * 4 + channel]); };
+                            uint32_t sum = at(x * 2, y * 2) + at(x * 2 + 1, y * 2) + at(x * 2, y * 2 + 1) + at(x * 2 + 1, y * 2 + 1);
+                            level[(size_t(y) * mipSize + x) * 4 + channel] = uint8_t(sum / 4);
+                        }
+                    }
+                }
+                levels.push_back(std::move(level));
+            }
+
+            LearningVK::WriteTextureFile(path, VK_FORMAT_R8G8B8A8_SRGB, { size, size }, levels);
+        }
+
+        return paths;
+    }
+
+    // How soon a texture set can be shown when only the tails are loaded up front, against loading every mip, then
+    // where the residency settles with half the textures close up and the other half far away. The device is idle,
+    // so every replaced texture can be destroyed straight away.
+    void BenchmarkTextureStreaming()
+    {
+        const uint32_t textureCount = 32;
+        const uint32_t textureSize = 1024;
+        std::vector<std::string> paths = GenerateStreamingTextures(textureCount, textureSize);
+
+        vkDeviceWaitIdle(device);
+        LearningVK::DeletionQueue retired;
+
+        LearningVK::TextureStreamerSpecification specification;
+        specification.Device = device;
+        specification.PhysicalDevice = physicalDevice;
+        specification.UploadQueue = graphicsQueue;
+        specification.UploadCommandPool = commandPool;
+        specification.MemoryBudget = 64ull * 1024 * 1024;
+
+        auto updateUntil = [&](LearningVK::TextureStreamer& streamer, auto done) {
+            uint32_t updates = 0;
+            while (!done(streamer.GetStats()) && updates < 100000)
+            {
+                streamer.Update(retired, frameNumber);
+                retired.FlushAll();
+                std::this_thread::yield();
+                updates++;
+            }
+            return updates;
+        };
+
+        std::cout << "Texture streaming (" << textureCount << " textures of " << textureSize << "x" << textureSize << "):" << std::endl;
+        for (bool tailsOnly : { false, true })
+        {
+            LearningVK::TextureStreamerSpecification loadSpecification = specification;
+            loadSpecification.TailSize = tailsOnly ? specification.TailSize : textureSize;
+            loadSpecification.MemoryBudget = ~VkDeviceSize(0);
+            loadSpecification.MaxUploadBytesPerUpdate = ~VkDeviceSize(0);
+
+            auto start = std::chrono::steady_clock::now();
+            LearningVK::TextureStreamer streamer(loadSpecification);
+            for (const std::string& path : paths)
+                streamer.Load(path);
+            updateUntil(streamer, [&](const LearningVK::TextureStreamerStats& stats) { return stats.ReadyCount == textureCount; });
+            double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+            std::cout << "  " << (tailsOnly ? "tails first " : "every mip   ") << "  all shown after " << milliseconds << " ms, "
+                << streamer.GetStats().ResidentBytes / (1024.0 * 1024.0) << " MB resident" << std::endl;
+        }
+
+        LearningVK::TextureStreamer streamer(specification);
+        for (const std::string& path : paths)
+            streamer.Load(path);
+
+        // Reported every update like a frame would, settled once nothing is decoding and nothing was replaced
+        uint32_t quietUpdates = 0;
+        uint32_t updates = updateUntil(streamer, [&](const LearningVK::TextureStreamerStats& stats) {
+            for (LearningVK::StreamedTextureId id = 0; id < textureCount; id++)
+                streamer.ReportUsage(id, id % 2 == 0 ? float(textureSize) : 48.0f);
+
+            quietUpdates = stats.PendingDecodes == 0 && stats.ReadyCount == textureCount ? quietUpdates + 1 : 0;
+            return quietUpdates > 2;
+        });
+
+        const LearningVK::TextureStreamerStats& stats = streamer.GetStats();
+        std::cout << "  settled after " << updates << " updates  resident: " << stats.ResidentBytes / (1024.0 * 1024.0) << " MB"
+            << " of " << stats.FullBytes / (1024.0 * 1024.0) << " MB, budget " << stats.Budget / (1024.0 * 1024.0) << " MB"
+            << "  decoded: " << stats.DecodedBytes / (1024.0 * 1024.0) << " MB"
+            << "  " << stats.Raises << " raises, " << stats.Lowers << " lowers" << std::endl;
+    }
+
+    // CPU cost of batching quads: adding them, sorting by material and writing the vertices. The materials only
+    // have made up handles since nothing is recorded, the more of them the more runs the sort has to split.
+    void BenchmarkSpriteBatch()
+    {
+        const uint32_t quadCount = 65536;
+        const uint32_t runs = 100;
+
+        LearningVK::SpriteBatchSpecification specification;
+        specification.Device = device;
+        specification.PhysicalDevice = physicalDevice;
+        specification.UploadQueue = graphicsQueue;
+        specification.UploadCommandPool = commandPool;
+        specification.MaxQuads = quadCount;
+        specification.FrameCount = 1;
+        LearningVK::SpriteBatch batch(specification);
+
+        std::vector<LearningVK::SpriteBatch::MaterialId> materials;
+        for (uint64_t pipeline = 1; pipeline <= 4; pipeline++)
+        {
+            for (uint64_t texture = 1; texture <= 4; texture++)
+                materials.push_back(batch.AddMaterial({ reinterpret_cast<VkPipeline>(pipeline), VK_NULL_HANDLE, reinterpret_cast<VkDescriptorSet>(texture) }));
+        }
+
+        std::cout << "Sprite batching (" << quadCount << " quads):" << std::endl;
+        for (uint32_t materialCount : { 1u, uint32_t(materials.size()) })
+        {
+            double seconds = 0.0;
+            for (uint32_t run = 0; run < runs; run++)
+            {
+                auto start = std::chrono::steady_clock::now();
+
+                batch.Begin(0, viewports[0]->SwapChain->GetExtent());
+                for (uint32_t i = 0; i < quadCount; i++)
+                {
+                    glm::vec2 position(float(i % 256) * 4.0f, float(i / 256) * 4.0f);
+                    batch.DrawQuad(materials[(i * 7) % materialCount], position, position + 4.0f, glm::vec2(0.0f), glm::vec2(1.0f), 0xFFFFFFFF, uint16_t(i % 3));
+                }
+                batch.End();
+
+                seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            }
+
+            const LearningVK::SpriteBatchStats& stats = batch.GetStats();
+            std::cout << "  " << materialCount << (materialCount == 1 ? " material  " : " materials ")
+                << "  " << double(quadCount) * runs / (seconds * 1000.0) << " quads/ms, " << stats.Draws << " draws" << std::endl;
+        }
+    }
+
+    // Cost of a recorded command through the loader's exported function against the function from
+    // vkGetDeviceProcAddr. Dynamic scissors are about the cheapest command there is, so the call overhead shows.
+    void BenchmarkDeviceDispatch()
+    {
+        const uint32_t commandsPerRun = 100000;
+        const uint32_t runs = 20;
+        const LearningVK::DeviceDispatch& dispatch = LearningVK::GetDeviceDispatch();
+
+        vkDeviceWaitIdle(device);
+        VkCommandBuffer commandBuffer = viewports[0]->SetupCommandBuffers[currentFrame];
+
+        VkCommandBufferBeginInfo beginInfo{};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+        VkRect2D scissor{};
+        scissor.extent = viewports[0]->SwapChain->GetExtent();
+
+        std::cout << "Command dispatch (" << commandsPerRun << " vkCmdSetScissor calls):" << std::endl;
+        for (bool direct : { false, true })
+        {
+            double seconds = 0.0;
+            for (uint32_t run = 0; run < runs; run++)
+            {
+                vkResetCommandBuffer(commandBuffer, 0);
+                vkBeginCommandBuffer(commandBuffer, &beginInfo);
+
+                auto start = std::chrono::steady_clock::now();
+                if (direct)
+                {
+                    for (uint32_t i = 0; i < commandsPerRun; i++)
+                        dispatch.CmdSetScissor(commandBuffer, 0, 1, &scissor);
+                }
+                else
+                {
+                    for (uint32_t i = 0; i < commandsPerRun; i++)
+                        vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+                }
+                seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+                vkEndCommandBuffer(commandBuffer);
+            }
+
+            std::cout << "  " << (direct ? "device dispatch table" : "loader trampoline    ")
+                << "  " << seconds * 1e9 / (double(runs) * commandsPerRun) << " ns/command" << std::endl;
+        }
+
+        vkResetCommandBuffer(commandBuffer, 0);
+    }
+
+    // CPU time spent recording a frame, recorded in full every frame against reusing the cached frame commands.
+    // Nothing is submitted, the device is idle so none of the command buffers are in flight.
+    void BenchmarkCommandReuse()
+    {
+        const uint32_t runs = 1000;
+        Viewport& viewport = *viewports[0];
+        vkDeviceWaitIdle(device);
+
+        std::cout << "Frame recording (" << sceneRenderer.GetObjectCount() << " objects):" << std::endl;
+        for (bool cached : { false, true })
+        {
+            std::chrono::steady_clock::time_point start;
+            // The first run isn't measured, it records the cached commands if they aren't yet
+            for (uint32_t i = 0; i <= runs; i++)
+            {
+                if (i == 1)
+                    start = std::chrono::steady_clock::now();
+
+                RecordCommandBuffer(viewport.SetupCommandBuffers[currentFrame], [&](VkCommandBuffer commandBuffer) {
+                    RecordFrameSetup(commandBuffer, viewport, true);
+                    if (!cached)
+                        RecordFrameCommands(commandBuffer, viewport, GetFrameSlot(viewport), 0, frameNumber);
+                });
+                if (cached)
+                    GetFrameCommands(viewport, 0);
+            }
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            std::cout << "  " << (cached ? "cached      " : "full record ") << "  " << seconds * 1000000.0 / runs << " us/frame" << std::endl;
+        }
+
+        const LearningVK::CommandCacheStats& stats = viewport.FrameCommands->GetStats();
+        std::cout << "  " << viewport.FrameCommands->GetCommandBufferCount() << " cached command buffers, " << stats.Recordings << " recordings, "
+            << stats.Hits << " reuses so far" << std::endl;
+    }
+
+    // CPU time spent recording the frame commands of every viewport, first one after another and then side by side
+    // on the recording threads. Like DrawFrame() every recording has a view of its own, views no window has open
+    // yet are created for the benchmark and sized like the main window. Each recording goes into a command buffer
+    // of its own pool, only the recording is measured and nothing is submitted.
+    void BenchmarkViewportRecording()
+    {
+        const uint32_t runs = 200;
+        Viewport& viewport = *viewports[0];
+        uint32_t graphicsFamily = FindQueueFamilies(physicalDevice).GraphicsFamily;
+        vkDeviceWaitIdle(device);
+
+        std::vector<uint32_t> addedViews;
+        for (uint32_t view = 0; view < MAX_VIEWPORTS; view++)
+        {
+            if (sceneRenderer.HasView(view))
+                continue;
+            sceneRenderer.Resize(view, viewport.SwapChain->GetExtent(), deletionQueue, frameNumber);
+            addedViews.push_back(view);
+        }
+
+        std::vector<VkCommandPool> pools(MAX_VIEWPORTS);
+        std::vector<VkCommandBuffer> buffers(MAX_VIEWPORTS);
+        for (uint32_t i = 0; i < MAX_VIEWPORTS; i++)
+        {
+            VkCommandPoolCreateInfo poolInfo{};
+            poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+            poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+            poolInfo.queueFamilyIndex = graphicsFamily;
+            vkCreateCommandPool(device, &poolInfo, nullptr, &pools[i]);
+
+            VkCommandBufferAllocateInfo allocateInfo{};
+            allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+            allocateInfo.commandPool = pools[i];
+            allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+            allocateInfo.commandBufferCount = 1;
+            vkAllocateCommandBuffers(device, &allocateInfo, &buffers[i]);
+        }
+
+        auto record = [&](uint32_t i) {
+            RecordCommandBuffer(buffers[i], [&](VkCommandBuffer commandBuffer) {
+                RecordFrameCommands(commandBuffer, viewport, sceneRenderer.GetFrameSlot(i, currentFrame), 0, frameNumber);
+            });
+        };
+
+        std::cout << "Viewport recording (" << MAX_VIEWPORTS << " viewports, " << sceneRenderer.GetObjectCount() << " objects each):" << std::endl;
+        for (bool parallel : { false, true })
+        {
+            auto start = std::chrono::steady_clock::now();
+            for (uint32_t run = 0; run < runs; run++)
+            {
+                if (parallel)
+                {
+                    for (uint32_t i = 0; i < MAX_VIEWPORTS; i++)
+                        recordingThreads.Submit([&, i]() { record(i); });
+                    recordingThreads.Wait();
+                }
+                else
+                {
+                    for (uint32_t i = 0; i < MAX_VIEWPORTS; i++)
+                        record(i);
+                }
+            }
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            std::cout << "  " << (parallel ? "recording threads" : "one thread       ") << "  " << seconds * 1000000.0 / runs << " us/frame" << std::endl;
+        }
+
+        for (VkCommandPool pool : pools)
+            vkDestroyCommandPool(device, pool, nullptr);
+        for (uint32_t view : addedViews)
+            sceneRenderer.RemoveView(view, deletionQueue, frameNumber);
+    }
+
+    // Light assignment on the GPU against the CPU reference, for a growing number of lights. The GPU result is
+    // read back and compared cluster by cluster, lights touching a cluster's edge may differ by float rounding.
+    void BenchmarkLightAssignment()
+    {
+        const LearningVK::DeviceDispatch& dispatch = LearningVK::GetDeviceDispatch();
+
+        const uint32_t cpuRuns = 5;
+        const uint32_t gpuRuns = 20;
+        uint32_t previousLightCount = lighting.GetLightCount();
+
+        VkPhysicalDeviceProperties properties;
+        vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+
+        VkQueryPoolCreateInfo queryPoolInfo{};
+        queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+        queryPoolInfo.queryCount = 2;
+
+        VkQueryPool queryPool;
+        if (vkCreateQueryPool(device, &queryPoolInfo, nullptr, &queryPool) != VK_SUCCESS)
+        {
+            std::cout << "Error: Couldn't create the timestamp query pool!" << std::endl;
+            return;
+        }
+
+        vkDeviceWaitIdle(device);
+        float time = GetSceneTime();
+        glm::vec3 cameraPosition;
+        glm::mat4 view, projection;
+        VkExtent2D extent = viewports[0]->SwapChain->GetExtent();
+        GetSceneView(time, extent, cameraPosition, view, projection);
+
+        std::cout << "Light assignment (" << ClusterCount << " clusters):" << std::endl;
+        for (uint32_t lightCount : { 256u, 1024u, 4096u, 16384u })
+        {
+            lighting.SetLightCount(lightCount);
+            lighting.Update(0, time, view, projection, SCENE_NEAR_PLANE, SCENE_FAR_PLANE, extent);
+
+            LightAssignment reference;
+            auto start = std::chrono::steady_clock::now();
+            for (uint32_t i = 0; i < cpuRuns; i++)
+                reference = AssignLightsReference(lighting.GetLightingData(), lighting.GetLights());
+            double cpuMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / cpuRuns;
+
+            double gpuMilliseconds = 0.0;
+            for (uint32_t i = 0; i < gpuRuns; i++)
+            {
+                LearningVK::SubmitImmediate(device, graphicsQueue, commandPool, [&](VkCommandBuffer commandBuffer) {
+                    dispatch.CmdResetQueryPool(commandBuffer, queryPool, 0, 2);
+                    dispatch.CmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, queryPool, 0);
+                    lighting.RecordAssignment(commandBuffer, 0);
+                    dispatch.CmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, queryPool, 1);
+                });
+
+                uint64_t timestamps[2];
+                vkGetQueryPoolResults(device, queryPool, 0, 2, sizeof(timestamps), timestamps, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT);
+                gpuMilliseconds += double(timestamps[1] - timestamps[0]) * properties.limits.timestampPeriod / 1e6;
+            }
+            gpuMilliseconds /= gpuRuns;
+
+            LightAssignment result = lighting.ReadAssignment(0);
+            uint32_t mismatches = 0;
+            for (uint32_t cluster = 0; cluster < ClusterCount; cluster++)
+            {
+                const LightCluster& expected = reference.Clusters[cluster];
+                const LightCluster& actual = result.Clusters[cluster];
+                bool same = expected.Count == actual.Count && actual.Offset + actual.Count <= result.LightIndices.size() && std::equal(reference.LightIndices.begin() + expected.Offset,
+                    reference.LightIndices.begin() + expected.Offset + expected.Count, result.LightIndices.begin() + actual.Offset);
+                if (!same)
+                    mismatches++;
+            }
+
+            std::cout << "  " << lightCount << " lights"
+                << "  cpu: " << cpuMilliseconds << " ms"
+                << "  gpu: " << gpuMilliseconds << " ms"
+                << "  " << float(reference.LightIndices.size()) / ClusterCount << " lights/cluster"
+                << "  " << mismatches << " mismatching clusters" << std::endl;
+        }
+
+        vkDestroyQueryPool(device, queryPool, nullptr);
+        lighting.SetLightCount(previousLightCount);
+    }
+
+    // Average frame time with the particle dispatch on the compute queue and in front of the render pass on the
+    // graphics queue. Only meaningful when the present mode doesn't wait for vblank (mailbox).
+    void BenchmarkParticleQueues()
+    {
+        const uint32_t warmupFrames = 50;
+        const uint32_t measuredFrames = 500;
+        bool wasAsync = useAsyncCompute;
+
+        if (!FindQueueFamilies(physicalDevice).HasAsyncCompute())
+            std::cout << "Note: the compute and graphics queues are in the same family, expect no overlap" << std::endl;
+
+        std::cout << "Particle simulation (" << particles.GetParticleCount() << " particles):" << std::endl;
+        for (bool async : { true, false })
+        {
+            SetAsyncCompute(async);
+            for (uint32_t i = 0; i < warmupFrames; i++)
+                DrawFrame();
+            vkDeviceWaitIdle(device);
+
+            auto start = std::chrono::steady_clock::now();
+            for (uint32_t i = 0; i < measuredFrames; i++)
+                DrawFrame();
+            vkDeviceWaitIdle(device);
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            std::cout << "  " << (async ? "async compute queue" : "graphics queue     ")
+                << "  " << seconds * 1000.0 / measuredFrames << " ms/frame" << std::endl;
+        }
+
+        SetAsyncCompute(wasAsync);
+    }
+
+    // Memory needed by the MSAA color and depth targets at every supported sample count, with and without
+    // transient attachments. Lazily allocated memory only counts as committed once the driver backs it.
+    void BenchmarkAttachmentFootprint()
+    {
+        VkPhysicalDeviceProperties properties;
+        vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+        VkSampleCountFlags supportedSamples = properties.limits.framebufferColorSampleCounts & properties.limits.framebufferDepthSampleCounts;
+
+        VkExtent2D extent = viewports[0]->SwapChain->GetExtent();
+        std::cout << "Attachment footprint at " << extent.width << "x" << extent.height << ":" << std::endl;
+        for (uint32_t samples = VK_SAMPLE_COUNT_1_BIT; samples <= VK_SAMPLE_COUNT_64_BIT; samples <<= 1)
+        {
+            if (!(supportedSamples & samples))
+                continue;
+
+            for (bool transient : { false, true })
+            {
+                LearningVK::AttachmentSpecification depthSpecification;
+                depthSpecification.Extent = extent;
+                depthSpecification.Format = depthFormat;
+                depthSpecification.Samples = VkSampleCountFlagBits(samples);
+                depthSpecification.Usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+                depthSpecification.Aspect = VK_IMAGE_ASPECT_DEPTH_BIT;
+                depthSpecification.Transient = transient;
+
+                LearningVK::AttachmentSpecification colorSpecification = depthSpecification;
+                colorSpecification.Format = GetColorFormat();
+                colorSpecification.Usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+                colorSpecification.Aspect = VK_IMAGE_ASPECT_COLOR_BIT;
+
+                std::vector<LearningVK::Attachment> targets(samples > VK_SAMPLE_COUNT_1_BIT ? 2 : 1);
+                LearningVK::CreateAttachment(device, physicalDevice, depthSpecification, targets[0]);
+                if (targets.size() > 1)
+                    LearningVK::CreateAttachment(device, physicalDevice, colorSpecification, targets[1]);
+
+                VkDeviceSize reserved = 0, committed = 0;
+                for (LearningVK::Attachment& target : targets)
+                {
+                    reserved += target.Size;
+
+                    VkDeviceSize targetCommitted = target.Size;
+                    if (target.LazilyAllocated)
+                        vkGetDeviceMemoryCommitment(device, target.Memory, &targetCommitted);
+                    committed += targetCommitted;
+
+                    LearningVK::DestroyAttachment(device, target);
+                }
+
+                std::cout << "  " << samples << "x " << (transient ? "transient" : "regular  ")
+                    << "  reserved: " << reserved / (1024.0 * 1024.0) << " MB"
+                    << "  committed: " << committed / (1024.0 * 1024.0) << " MB" << std::endl;
+            }
+        }
+    }
+#endif
+
+    VkShaderModule CreateShaderModule(const std::vector<uint32_t>& code)
+    {
+        VkShaderModuleCreateInfo createInfo{};
+        createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+        createInfo.codeSize = code.size() * sizeof(uint32_t);
+        createInfo.pCode = code.data();
+
+        VkShaderModule shaderModule;
+        VkResult result = vkCreateShaderModule(device, &createInfo, nullptr, &shaderModule);
+        if (result != VK_SUCCESS)
+        {
+            std::cout << "Error: Couldn't create a shader module!" << std::endl;
+            __debugbreak();
+        }
+
+        return shaderModule;
     }
 
     bool CheckDeviceCompatibility(const VkPhysicalDevice& device)
@@ -813,11 +2579,18 @@ private:
         }
 
         VkPhysicalDeviceProperties deviceProperties;
-        VkPhysicalDeviceFeatures deviceFeatures;
         vkGetPhysicalDeviceProperties(device, &deviceProperties);
-        vkGetPhysicalDeviceFeatures(device, &deviceFeatures);
 
-        return indices.IsComplete() && extensionSupport && swapChainSupport && deviceProperties.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU;
+        VkPhysicalDeviceVulkan12Features vulkan12Features{};
+        vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+        VkPhysicalDeviceFeatures2 deviceFeatures{};
+        deviceFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        deviceFeatures.pNext = &vulkan12Features;
+        vkGetPhysicalDeviceFeatures2(device, &deviceFeatures);
+
+        bool indirectSupport = deviceFeatures.features.multiDrawIndirect && deviceFeatures.features.drawIndirectFirstInstance && vulkan12Features.drawIndirectCount;
+
+        return indices.IsComplete() && extensionSupport && swapChainSupport && indirectSupport && deviceProperties.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU;
     }
 
     bool CheckDeviceExtensionSupport(const VkPhysicalDevice& device)
@@ -838,6 +2611,23 @@ private:
         return requiredExtensions.empty();
     }
 
+    bool IsDeviceExtensionSupported(const VkPhysicalDevice& device, const char* name)
+    {
+        uint32_t extensionCount;
+        vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
+
+        std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+        vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, availableExtensions.data());
+
+        for (const auto& extension : availableExtensions)
+        {
+            if (strcmp(extension.extensionName, name) == 0)
+                return true;
+        }
+
+        return false;
+    }
+
     QueueFamilyIndices FindQueueFamilies(const VkPhysicalDevice& device)
     {
         QueueFamilyIndices indices;
@@ -847,15 +2637,36 @@ private:
         std::vector<VkQueueFamilyProperties> queueFamilyProperties(queueFamilyCount);
         vkGetPhysicalDeviceQueueFamilyProperties(device, &queueFamilyCount, queueFamilyProperties.data());
 
+        // First matching family wins, a graphics family that can also present is preferred so both share a queue
         for (uint32_t i = 0; i < queueFamilyCount; i++)
         {
-            VkBool32 presentSupport;
-            vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &presentSupport);
+            VkBool32 presentSupport = VK_FALSE;
+            vkGetPhysicalDeviceSurfaceSupportKHR(device, i, viewports[0]->Surface, &presentSupport);
 
-            if (queueFamilyProperties[i].queueFlags & VK_QUEUE_GRAPHICS_BIT)
+            bool graphics = queueFamilyProperties[i].queueFlags & VK_QUEUE_GRAPHICS_BIT;
+            if (graphics && presentSupport)
+            {
                 indices.GraphicsFamily = i;
-            if (presentSupport)
                 indices.PresentFamily = i;
+                break;
+            }
+
+            if (graphics && indices.GraphicsFamily == UINT32_MAX)
+                indices.GraphicsFamily = i;
+            if (presentSupport && indices.PresentFamily == UINT32_MAX)
+                indices.PresentFamily = i;
+        }
+
+        // Graphics families always support compute, a family without graphics is a dedicated async compute queue
+        indices.ComputeFamily = indices.GraphicsFamily;
+        for (uint32_t i = 0; i < queueFamilyCount; i++)
+        {
+            VkQueueFlags flags = queueFamilyProperties[i].queueFlags;
+            if ((flags & VK_QUEUE_COMPUTE_BIT) && !(flags & VK_QUEUE_GRAPHICS_BIT))
+            {
+                indices.ComputeFamily = i;
+                break;
+            }
         }
 
         return indices;
@@ -865,72 +2676,28 @@ private:
     {
         SwapChainSupportDetails details;
 
-        vkGetPhysicalDeviceSurfaceCapabilitiesKHR(device, surface, &details.surfaceCapabilities);
+        vkGetPhysicalDeviceSurfaceCapabilitiesKHR(device, viewports[0]->Surface, &details.surfaceCapabilities);
 
         uint32_t formatCount;
-        vkGetPhysicalDeviceSurfaceFormatsKHR(device, surface, &formatCount, nullptr);
+        vkGetPhysicalDeviceSurfaceFormatsKHR(device, viewports[0]->Surface, &formatCount, nullptr);
         if (formatCount != 0)
         {
             details.surfaceFormats.resize(formatCount);    
-            vkGetPhysicalDeviceSurfaceFormatsKHR(device, surface, &formatCount, details.surfaceFormats.data());
+            vkGetPhysicalDeviceSurfaceFormatsKHR(device, viewports[0]->Surface, &formatCount, details.surfaceFormats.data());
         }
 
         uint32_t presentModeCount;
-        vkGetPhysicalDeviceSurfacePresentModesKHR(device, surface, &presentModeCount, nullptr);
+        vkGetPhysicalDeviceSurfacePresentModesKHR(device, viewports[0]->Surface, &presentModeCount, nullptr);
         if (presentModeCount != 0)
         {
             details.presentModes.resize(presentModeCount);
-            vkGetPhysicalDeviceSurfacePresentModesKHR(device, surface, &presentModeCount, details.presentModes.data());
+            vkGetPhysicalDeviceSurfacePresentModesKHR(device, viewports[0]->Surface, &presentModeCount, details.presentModes.data());
         }
 
 
         return details;
     }
 
-    VkSurfaceFormatKHR ChooseSwapSurfaceFormat(const std::vector<VkSurfaceFormatKHR>& availableFormats)
-    {
-        for (const auto& format : availableFormats)
-        {
-            if (format.format == VK_FORMAT_B8G8R8A8_SRGB)
-                return format;
-        }
-
-        return availableFormats[0];
-    }
-
-    VkPresentModeKHR ChooseSwapPresentMode(const std::vector<VkPresentModeKHR>& presentModes)
-    {
-        for (const auto& presentMode : presentModes)
-        {
-            if (presentMode == VK_PRESENT_MODE_MAILBOX_KHR)
-                return presentMode;
-        }
-
-        return VK_PRESENT_MODE_FIFO_KHR;
-    }
-
-    VkExtent2D ChooseSwapExtent(const VkSurfaceCapabilitiesKHR& capabilities)
-    {
-        if (capabilities.currentExtent.width == std::numeric_limits<uint32_t>::max())
-        {
-            int width, height;
-            glfwGetFramebufferSize(window, &width, &height);
-
-            VkExtent2D actualExtent = {
-                uint32_t(width),
-                uint32_t(height)
-            };
-
-            actualExtent.width = std::clamp(actualExtent.width, capabilities.minImageExtent.width, capabilities.maxImageExtent.width);
-            actualExtent.height = std::clamp(actualExtent.height, capabilities.minImageExtent.height, capabilities.maxImageExtent.height);
-            
-            return actualExtent;
-        }
-
-        return capabilities.currentExtent;
-    }
-
-
     std::vector<const char*> GetRequiredExtensions()
     {
         uint32_t glfwExtensionCount;
@@ -0,0 +1,216 @@
+#include "Scene.h"
+#include "MeshSimplifier.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/constants.hpp>
+
+#include <random>
+
+static const float RoomSize = 10.0f;
+static const float WallHeight = 4.0f;
+static const float WallThickness = 0.2f;
+static const float DoorwayWidth = 2.0f;
+
+enum SceneMeshes : uint32_t
+{
+    SceneMesh_Cube = 0,
+    SceneMesh_Sphere = 1
+};
+
+// Meshes are about a unit across, so this is a fraction of their size
+static const float LodMaxError = 0.15f;
+// A LOD that removes less than this fraction of the previous one's triangles isn't worth drawing
+static const float LodMinReduction = 0.1f;
+
+static void AddMesh(Scene& scene, const std::vector<SceneVertex>& vertices, const std::vector<uint32_t>& indices)
+{
+    SceneMesh mesh{};
+    mesh.VertexOffset = int32_t(scene.Vertices.size());
+    scene.Vertices.insert(scene.Vertices.end(), vertices.begin(), vertices.end());
+
+    // Every LOD halves the triangles of the previous one. The errors of the steps add up, so the chain ends once
+    // the total would pass LodMaxError.
+    std::vector<uint32_t> lodIndices = indices;
+    float lodError = 0.0f;
+    while (true)
+    {
+        SceneMeshLod& lod = mesh.Lods[mesh.LodCount++];
+        lod.FirstIndex = uint32_t(scene.Indices.size());
+        lod.IndexCount = uint32_t(lodIndices.size());
+        lod.Error = lodError;
+        scene.Indices.insert(scene.Indices.end(), lodIndices.begin(), lodIndices.end());
+
+        if (mesh.LodCount == MaxMeshLods)
+            break;
+
+        float stepError;
+        size_t targetIndexCount = lodIndices.size() / 6 * 3;
+        std::vector<uint32_t> simplified = SimplifyMesh(vertices, lodIndices, targetIndexCount, LodMaxError - lodError, stepError);
+        if (simplified.size() > (1.0f - LodMinReduction) * lodIndices.size())
+            break;
+
+        lodIndices = std::move(simplified);
+        lodError += stepError;
+    }
+
+    scene.Meshes.push_back(mesh);
+}
+
+// Unit cube centred on the origin, with its own vertices per face so the normals stay flat
+static void AddCube(Scene& scene)
+{
+    std::vector<SceneVertex> vertices;
+    std::vector<uint32_t> indices;
+
+    for (int axis = 0; axis < 3; axis++)
+    {
+        for (float sign : { 1.0f, -1.0f })
+        {
+            glm::vec3 normal(0.0f);
+            normal[axis] = sign;
+            glm::vec3 u(0.0f), v(0.0f);
+            u[(axis + 1) % 3] = sign;
+            v[(axis + 2) % 3] = 1.0f;
+
+            uint32_t first = uint32_t(vertices.size());
+            for (int corner = 0; corner < 4; corner++)
+            {
+                glm::vec2 uv(float(corner & 1), float(corner >> 1));
+                glm::vec3 position = 0.5f * normal + (uv.x - 0.5f) * u + (uv.y - 0.5f) * v;
+                vertices.push_back({ position, normal, uv });
+            }
+
+            for (uint32_t index : { 0u, 1u, 3u, 0u, 3u, 2u })
+                indices.push_back(first + index);
+        }
+    }
+
+    AddMesh(scene, vertices, indices);
+}
+
+// Sphere with a radius of 0.5, so it fills the same unit box as the cube
+static void AddSphere(Scene& scene, uint32_t segments, uint32_t rings)
+{
+    std::vector<SceneVertex> vertices;
+    std::vector<uint32_t> indices;
+
+    for (uint32_t ring = 0; ring <= rings; ring++)
+    {
+        float v = float(ring) / float(rings);
+        float phi = v * glm::pi<float>();
+
+        for (uint32_t segment = 0; segment <= segments; segment++)
+        {
+            float u = float(segment) / float(segments);
+            float theta = u * 2.0f * glm::pi<float>();
+
+            glm::vec3 normal(std::sin(phi) * std::cos(theta), std::cos(phi), std::sin(phi) * std::sin(theta));
+            vertices.push_back({ 0.5f * normal, normal, glm::vec2(u, v) });
+        }
+    }
+
+    for (uint32_t ring = 0; ring < rings; ring++)
+    {
+        for (uint32_t segment = 0; segment < segments; segment++)
+        {
+            uint32_t current = ring * (segments + 1) + segment;
+            uint32_t below = current + segments + 1;
+            for (uint32_t index : { current, below, current + 1, current + 1, below, below + 1 })
+                indices.push_back(index);
+        }
+    }
+
+    AddMesh(scene, vertices, indices);
+}
+
+static void AddObject(Scene& scene, uint32_t mesh, const glm::vec3& center, const glm::vec3& size, const glm::vec3& color)
+{
+    SceneObject object{};
+    object.Model = glm::scale(glm::translate(glm::mat4(1.0f), center), size);
+    // Half the box diagonal, which also bounds the sphere
+    object.BoundingSphere = glm::vec4(center, 0.5f * glm::length(size));
+    object.Color = glm::vec4(color, 1.0f);
+    object.MeshIndex = mesh;
+    scene.Objects.push_back(object);
+}
+
+Scene CreateRoomsScene(uint32_t roomsPerSide, uint32_t propsPerSide)
+{
+    Scene scene;
+    AddCube(scene);
+    AddSphere(scene, 64, 32);
+
+    std::mt19937 random(1337);
+    std::uniform_real_distribution<float> color(0.2f, 1.0f);
+    std::uniform_real_distribution<float> propSize(0.4f, 1.0f);
+
+    float levelSize = RoomSize * roomsPerSide;
+    float origin = -0.5f * levelSize;
+    glm::vec3 wallColor(0.7f, 0.68f, 0.65f);
+
+    AddObject(scene, SceneMesh_Cube, glm::vec3(0.0f, -0.5f * WallThickness, 0.0f), glm::vec3(levelSize, WallThickness, levelSize), glm::vec3(0.4f));
+
+    // Walls run along both axes on every grid line. Inner walls are split around a doorway, the outer ones are solid.
+    float segmentLength = 0.5f * (RoomSize - DoorwayWidth);
+    for (uint32_t line = 0; line <= roomsPerSide; line++)
+    {
+        bool outer = line == 0 || line == roomsPerSide;
+        float across = origin + line * RoomSize;
+
+        for (uint32_t room = 0; room < roomsPerSide; room++)
+        {
+            float along = origin + room * RoomSize;
+
+            std::vector<std::pair<float, float>> segments;
+            if (outer)
+                segments = { { along + 0.5f * RoomSize, RoomSize } };
+            else
+                segments = { { along + 0.5f * segmentLength, segmentLength }, { along + RoomSize - 0.5f * segmentLength, segmentLength } };
+
+            for (const auto& [center, length] : segments)
+            {
+                AddObject(scene, SceneMesh_Cube, glm::vec3(center, 0.5f * WallHeight, across), glm::vec3(length, WallHeight, WallThickness), wallColor);
+                AddObject(scene, SceneMesh_Cube, glm::vec3(across, 0.5f * WallHeight, center), glm::vec3(WallThickness, WallHeight, length), wallColor);
+            }
+        }
+    }
+
+    float propSpacing = RoomSize / float(propsPerSide + 1);
+    for (uint32_t roomZ = 0; roomZ < roomsPerSide; roomZ++)
+    {
+        for (uint32_t roomX = 0; roomX < roomsPerSide; roomX++)
+        {
+            for (uint32_t propZ = 0; propZ < propsPerSide; propZ++)
+            {
+                for (uint32_t propX = 0; propX < propsPerSide; propX++)
+                {
+                    float size = propSize(random);
+                    glm::vec3 center(origin + roomX * RoomSize + (propX + 1) * propSpacing, 0.5f * size,
+                        origin + roomZ * RoomSize + (propZ + 1) * propSpacing);
+
+                    uint32_t mesh = (propX + propZ) % 2 ? SceneMesh_Sphere : SceneMesh_Cube;
+                    AddObject(scene, mesh, center, glm::vec3(size), glm::vec3(color(random), color(random), color(random)));
+                }
+            }
+        }
+    }
+
+    return scene;
+}
+
+void GetRoomsSceneBounds(glm::vec3& boundsMin, glm::vec3& boundsMax, uint32_t roomsPerSide)
+{
+    float halfSize = 0.5f * RoomSize * roomsPerSide;
+    boundsMin = glm::vec3(-halfSize, 0.3f, -halfSize);
+    boundsMax = glm::vec3(halfSize, WallHeight - 0.5f, halfSize);
+}
+
+void GetSceneCamera(float time, glm::vec3& position, glm::vec3& target)
+{
+    // The walls across the x axis have their doorways halfway through a room, which is z = 5 next to the origin
+    float phase = time * 0.1f;
+    position = glm::vec3(35.0f * std::sin(phase), 1.7f, 0.5f * RoomSize);
+
+    float direction = std::cos(phase) >= 0.0f ? 1.0f : -1.0f;
+    target = position + glm::vec3(direction, -0.05f, 0.0f);
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+struct SceneVertex
+{
+    glm::vec3 Position;
+    glm::vec3 Normal;
+    glm::vec2 UV;
+};
+
+// Layout matches ObjectData in scene.glsl
+struct SceneObject
+{
+    glm::mat4 Model;
+    // World space center and radius
+    glm::vec4 BoundingSphere;
+    glm::vec4 Color;
+    uint32_t MeshIndex;
+    uint32_t Padding[3];
+};
+
+// Must match MAX_MESH_LODS in scene.glsl
+const uint32_t MaxMeshLods = 6;
+
+// Layout matches MeshLod in scene.glsl
+struct SceneMeshLod
+{
+    uint32_t FirstIndex;
+    uint32_t IndexCount;
+    // Bound on how far the LOD's surface is from the full detail mesh, in mesh units
+    float Error;
+    uint32_t Padding;
+};
+
+// Layout matches MeshData in scene.glsl. LOD 0 is the full detail mesh, every LOD indexes the same vertices.
+struct SceneMesh
+{
+    int32_t VertexOffset;
+    uint32_t LodCount;
+    uint32_t Padding[2];
+    SceneMeshLod Lods[MaxMeshLods];
+};
+
+// Every mesh lives in the same vertex and index arrays, so the whole scene is drawn from one pair of buffers.
+// The index array holds every LOD of every mesh.
+struct Scene
+{
+    std::vector<SceneVertex> Vertices;
+    std::vector<uint32_t> Indices;
+    std::vector<SceneMesh> Meshes;
+    std::vector<SceneObject> Objects;
+};
+
+// A grid of walled rooms joined by doorways, each filled with props. From anywhere inside, the walls hide most
+// of the level, which is the case occlusion culling is meant for.
+Scene CreateRoomsScene(uint32_t roomsPerSide = 8, uint32_t propsPerSide = 6);
+
+// The space inside the rooms' walls, from the floor to just under the top of the walls
+void GetRoomsSceneBounds(glm::vec3& boundsMin, glm::vec3& boundsMax, uint32_t roomsPerSide = 8);
+
+// Eye position and look-at point of a camera walking back and forth through a row of doorways
+void GetSceneCamera(float time, glm::vec3& position, glm::vec3& target);
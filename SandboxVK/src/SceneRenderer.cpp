@@ -0,0 +1,654 @@
+#include "SceneRenderer.h"
+
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+// Layout matches FrameData in scene.glsl
+struct SceneFrameData
+{
+    glm::mat4 ViewProjection;
+    glm::mat4 PreviousViewProjection;
+    glm::vec4 FrustumPlanes[6];
+    glm::vec4 CameraPosition;
+    glm::vec2 PyramidSize;
+    uint32_t ObjectCount;
+    uint32_t OcclusionCulling;
+    uint32_t PyramidValid;
+    float LodScale;
+    float LodThreshold;
+    uint32_t Padding[1];
+};
+
+// Planes point inwards, for a depth range of 0 to 1
+static void ExtractFrustumPlanes(const glm::mat4& viewProjection, glm::vec4 planes[6])
+{
+    glm::vec4 rows[4];
+    for (int i = 0; i < 4; i++)
+        rows[i] = glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+
+    planes[0] = rows[3] + rows[0];
+    planes[1] = rows[3] - rows[0];
+    planes[2] = rows[3] + rows[1];
+    planes[3] = rows[3] - rows[1];
+    planes[4] = rows[2];
+    planes[5] = rows[3] - rows[2];
+
+    for (int i = 0; i < 6; i++)
+        planes[i] /= glm::length(glm::vec3(planes[i].x, planes[i].y, planes[i].z));
+}
+
+static void RecordMemoryBarrier(VkCommandBuffer commandBuffer, VkPipelineStageFlags srcStages, VkAccessFlags srcAccess,
+    VkPipelineStageFlags dstStages, VkAccessFlags dstAccess)
+{
+    VkMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = srcAccess;
+    barrier.dstAccessMask = dstAccess;
+    LearningVK::GetDeviceDispatch().CmdPipelineBarrier(commandBuffer, srcStages, dstStages, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+}
+
+void SceneRenderer::Init(const SceneRendererSpecification& specification)
+{
+    this->specification = specification;
+    scene = CreateRoomsScene();
+
+    CreateBuffers();
+    CreatePrepassRenderPasses();
+    CreatePipelines();
+
+    const LearningVK::ShaderVariant* reduceShader = specification.Shaders->SelectVariant("depth_reduce.comp", 0);
+    if (!reduceShader)
+    {
+        std::cout << "Error: Couldn't find the depth reduction shader!" << std::endl;
+        __debugbreak();
+    }
+    reduceShaderCode = reduceShader->Code;
+
+    // Nothing exists yet, so there's nothing for the first resize to retire
+    LearningVK::DeletionQueue unused;
+    views.resize(specification.ViewCount);
+    Resize(0, specification.Extent, unused, 0);
+
+    std::cout << "Scene: " << scene.Objects.size() << " objects" << std::endl;
+    for (uint32_t i = 0; i < uint32_t(scene.Meshes.size()); i++)
+    {
+        const SceneMesh& mesh = scene.Meshes[i];
+        std::cout << "  Mesh " << i << " LOD triangles:";
+        for (uint32_t lod = 0; lod < mesh.LodCount; lod++)
+            std::cout << " " << mesh.Lods[lod].IndexCount / 3;
+        std::cout << std::endl;
+    }
+}
+
+void SceneRenderer::Shutdown()
+{
+    VkDevice device = specification.Device;
+
+    // Nothing is in flight anymore, so retiring destroys the views straight away
+    LearningVK::DeletionQueue retired;
+    for (uint32_t view = 0; view < uint32_t(views.size()); view++)
+        RemoveView(view, retired, 0);
+    retired.FlushAll();
+
+    for (VkRenderPass renderPass : prepassRenderPasses)
+        vkDestroyRenderPass(device, renderPass, nullptr);
+
+    LearningVK::DestroyGraphicsPipeline(device, scenePipeline);
+    LearningVK::DestroyGraphicsPipeline(device, prepassPipeline);
+    for (LearningVK::ComputePipeline& pipeline : cullPipelines)
+        LearningVK::DestroyComputePipeline(device, pipeline);
+
+    for (FrameResources& frame : frames)
+    {
+        LearningVK::DestroyBuffer(device, frame.FrameData);
+        LearningVK::DestroyBuffer(device, frame.Stats);
+        for (uint32_t phase = 0; phase < CullPhase_Count; phase++)
+        {
+            LearningVK::DestroyBuffer(device, frame.DrawCommands[phase]);
+            LearningVK::DestroyBuffer(device, frame.DrawCounts[phase]);
+        }
+    }
+
+    LearningVK::DestroyBuffer(device, vertexBuffer);
+    LearningVK::DestroyBuffer(device, indexBuffer);
+    LearningVK::DestroyBuffer(device, objectBuffer);
+    LearningVK::DestroyBuffer(device, meshBuffer);
+}
+
+void SceneRenderer::Resize(uint32_t view, VkExtent2D extent, LearningVK::DeletionQueue& deletionQueue, uint64_t frameNumber)
+{
+    VkDevice device = specification.Device;
+    ViewResources& resources = views[view];
+
+    if (resources.DepthPyramid)
+    {
+        VkFramebuffer oldFramebuffer = resources.PrepassFramebuffer;
+        LearningVK::Attachment oldDepth = resources.PrepassDepth;
+        deletionQueue.Push(frameNumber, [=]() mutable {
+            vkDestroyFramebuffer(device, oldFramebuffer, nullptr);
+            LearningVK::DestroyAttachment(device, oldDepth);
+        });
+        RetireDescriptorSets(view, deletionQueue, frameNumber);
+    }
+    else
+    {
+        if (!LearningVK::CreateBuffer(device, specification.PhysicalDevice, sizeof(uint32_t) * GetObjectCount(), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0, resources.VisibilityBuffer))
+            __debugbreak();
+
+        resources.DepthPyramid = std::make_unique<LearningVK::DepthPyramid>(device, specification.PhysicalDevice, reduceShaderCode);
+    }
+
+    resources.Extent = extent;
+    resources.PrepassDepth = {};
+    CreatePrepassTarget(resources);
+
+    // The culling sets sample the pyramid, which is a new image now
+    resources.DepthPyramid->Resize(extent, resources.PrepassDepth.View, deletionQueue, frameNumber);
+    CreateDescriptorSets(view);
+
+    resources.PyramidValid = false;
+}
+
+void SceneRenderer::RemoveView(uint32_t view, LearningVK::DeletionQueue& deletionQueue, uint64_t frameNumber)
+{
+    ViewResources& resources = views[view];
+    if (!resources.DepthPyramid)
+        return;
+
+    VkDevice device = specification.Device;
+    RetireDescriptorSets(view, deletionQueue, frameNumber);
+
+    std::shared_ptr<LearningVK::DepthPyramid> pyramid = std::move(resources.DepthPyramid);
+    VkFramebuffer framebuffer = resources.PrepassFramebuffer;
+    LearningVK::Attachment depth = resources.PrepassDepth;
+    LearningVK::Buffer visibilityBuffer = resources.VisibilityBuffer;
+    deletionQueue.Push(frameNumber, [=]() mutable {
+        pyramid.reset();
+        vkDestroyFramebuffer(device, framebuffer, nullptr);
+        LearningVK::DestroyAttachment(device, depth);
+        LearningVK::DestroyBuffer(device, visibilityBuffer);
+    });
+    resources = {};
+}
+
+void SceneRenderer::RecreatePipelines(VkRenderPass renderPass, LearningVK::DeletionQueue& deletionQueue, uint64_t frameNumber)
+{
+    VkDevice device = specification.Device;
+    LearningVK::GraphicsPipeline oldScenePipeline = scenePipeline;
+    LearningVK::GraphicsPipeline oldPrepassPipeline = prepassPipeline;
+    std::array<LearningVK::ComputePipeline, CullPhase_Count> oldCullPipelines = cullPipelines;
+    deletionQueue.Push(frameNumber, [=]() mutable {
+        LearningVK::DestroyGraphicsPipeline(device, oldScenePipeline);
+        LearningVK::DestroyGraphicsPipeline(device, oldPrepassPipeline);
+        for (LearningVK::ComputePipeline& pipeline : oldCullPipelines)
+            LearningVK::DestroyComputePipeline(device, pipeline);
+    });
+
+    specification.RenderPass = renderPass;
+    CreatePipelines();
+
+    // The sets were allocated from the old set layouts
+    for (uint32_t view = 0; view < uint32_t(views.size()); view++)
+    {
+        if (!HasView(view))
+            continue;
+
+        RetireDescriptorSets(view, deletionQueue, frameNumber);
+        CreateDescriptorSets(view);
+    }
+}
+
+void SceneRenderer::SetOcclusionCulling(bool enabled)
+{
+    occlusionCulling = enabled;
+    // Frames recorded without it don't build the pyramid
+    for (ViewResources& view : views)
+        view.PyramidValid = false;
+}
+
+void SceneRenderer::SetLodSelection(bool enabled, float thresholdPixels)
+{
+    lodSelection = enabled;
+    lodThreshold = thresholdPixels;
+}
+
+void SceneRenderer::Update(uint32_t frameSlot, const glm::vec3& cameraPosition, const glm::mat4& view, const glm::mat4& projection, VkExtent2D viewport)
+{
+    ViewResources& resources = views[GetView(frameSlot)];
+    VkExtent2D pyramidExtent = resources.DepthPyramid->GetExtent();
+
+    SceneFrameData data{};
+    data.ViewProjection = projection * view;
+    data.PreviousViewProjection = resources.PreviousViewProjection;
+    ExtractFrustumPlanes(data.ViewProjection, data.FrustumPlanes);
+    data.CameraPosition = glm::vec4(cameraPosition, 1.0f);
+    data.PyramidSize = glm::vec2(float(pyramidExtent.width), float(pyramidExtent.height));
+    data.ObjectCount = GetObjectCount();
+    data.OcclusionCulling = occlusionCulling ? 1 : 0;
+    data.PyramidValid = resources.PyramidValid ? 1 : 0;
+    // Half the viewport height over the tangent of half the vertical field of view
+    data.LodScale = lodSelection ? 0.5f * float(viewport.height) * std::abs(projection[1][1]) : 0.0f;
+    data.LodThreshold = lodThreshold;
+
+    const LearningVK::Buffer& buffer = frames[frameSlot].FrameData;
+    std::memcpy(buffer.Mapped, &data, sizeof(data));
+    LearningVK::FlushBuffer(specification.Device, buffer);
+
+    resources.PreviousViewProjection = data.ViewProjection;
+}
+
+void SceneRenderer::RecordInitialization(VkCommandBuffer commandBuffer, uint32_t view)
+{
+    views[view].DepthPyramid->RecordInitialization(commandBuffer);
+}
+
+void SceneRenderer::RecordCulling(VkCommandBuffer commandBuffer, uint32_t frameSlot)
+{
+    const LearningVK::DeviceDispatch& dispatch = LearningVK::GetDeviceDispatch();
+
+    FrameResources& frame = frames[frameSlot];
+    ViewResources& view = views[GetView(frameSlot)];
+
+    for (uint32_t phase = 0; phase < CullPhase_Count; phase++)
+        dispatch.CmdFillBuffer(commandBuffer, frame.DrawCounts[phase].Handle, 0, VK_WHOLE_SIZE, 0);
+    dispatch.CmdFillBuffer(commandBuffer, frame.Stats.Handle, 0, VK_WHOLE_SIZE, 0);
+
+    // Also orders this frame's culling after last frame's pyramid build and visibility reads
+    RecordMemoryBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+    view.DepthPyramid->RecordInitialization(commandBuffer);
+
+    RecordCull(commandBuffer, frameSlot, CullPhase_Early);
+    RecordMemoryBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT,
+        VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT);
+
+    if (occlusionCulling)
+    {
+        // The pre-pass render passes order the depth against the pyramid builds on both sides
+        RecordPrepass(commandBuffer, frameSlot, CullPhase_Early);
+        view.DepthPyramid->RecordBuild(commandBuffer);
+
+        RecordCull(commandBuffer, frameSlot, CullPhase_Late);
+        RecordMemoryBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT,
+            VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT);
+
+        // Next frame's early cull tests against everything drawn this frame
+        RecordPrepass(commandBuffer, frameSlot, CullPhase_Late);
+        view.DepthPyramid->RecordBuild(commandBuffer);
+        view.PyramidValid = true;
+    }
+
+    RecordMemoryBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT,
+        VK_PIPELINE_STAGE_HOST_BIT, VK_ACCESS_HOST_READ_BIT);
+}
+
+void SceneRenderer::RecordDraw(VkCommandBuffer commandBuffer, uint32_t frameSlot)
+{
+    const FrameResources& frame = frames[frameSlot];
+
+    BindSceneGeometry(commandBuffer, scenePipeline, frame);
+    RecordIndirectDraws(commandBuffer, frame, CullPhase_Early);
+    RecordIndirectDraws(commandBuffer, frame, CullPhase_Late);
+}
+
+OcclusionCullingStats SceneRenderer::CollectStats(uint32_t frameSlot) const
+{
+    const LearningVK::Buffer& buffer = frames[frameSlot].Stats;
+    LearningVK::InvalidateBuffer(specification.Device, buffer);
+
+    OcclusionCullingStats stats;
+    std::memcpy(&stats, buffer.Mapped, sizeof(stats));
+    return stats;
+}
+
+void SceneRenderer::RecordCull(VkCommandBuffer commandBuffer, uint32_t frameSlot, CullPhase phase)
+{
+    const LearningVK::DeviceDispatch& dispatch = LearningVK::GetDeviceDispatch();
+
+    const LearningVK::ComputePipeline& pipeline = cullPipelines[phase];
+
+    dispatch.CmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline.Pipeline);
+    dispatch.CmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline.Layout, 0, 1, &frames[frameSlot].CullSets[phase], 0, nullptr);
+    dispatch.CmdDispatch(commandBuffer, (GetObjectCount() + 63) / 64, 1, 1);
+}
+
+void SceneRenderer::RecordPrepass(VkCommandBuffer commandBuffer, uint32_t frameSlot, CullPhase phase)
+{
+    const LearningVK::DeviceDispatch& dispatch = LearningVK::GetDeviceDispatch();
+
+    const ViewResources& view = views[GetView(frameSlot)];
+
+    VkClearValue clearValue{};
+    clearValue.depthStencil = { 1.0f, 0 };
+
+    VkRenderPassBeginInfo renderPassBeginInfo{};
+    renderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+    renderPassBeginInfo.renderPass = prepassRenderPasses[phase];
+    renderPassBeginInfo.framebuffer = view.PrepassFramebuffer;
+    renderPassBeginInfo.renderArea.offset = { 0, 0 };
+    renderPassBeginInfo.renderArea.extent = view.Extent;
+    renderPassBeginInfo.clearValueCount = 1;
+    renderPassBeginInfo.pClearValues = &clearValue;
+
+    dispatch.CmdBeginRenderPass(commandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+
+    VkViewport viewport{};
+    viewport.width = float(view.Extent.width);
+    viewport.height = float(view.Extent.height);
+    viewport.maxDepth = 1.0f;
+    dispatch.CmdSetViewport(commandBuffer, 0, 1, &viewport);
+
+    VkRect2D scissor{};
+    scissor.extent = view.Extent;
+    dispatch.CmdSetScissor(commandBuffer, 0, 1, &scissor);
+
+    const FrameResources& frame = frames[frameSlot];
+    BindSceneGeometry(commandBuffer, prepassPipeline, frame);
+    RecordIndirectDraws(commandBuffer, frame, phase);
+
+    dispatch.CmdEndRenderPass(commandBuffer);
+}
+
+void SceneRenderer::BindSceneGeometry(VkCommandBuffer commandBuffer, const LearningVK::GraphicsPipeline& pipeline, const FrameResources& frame)
+{
+    const LearningVK::DeviceDispatch& dispatch = LearningVK::GetDeviceDispatch();
+
+    VkDeviceSize offset = 0;
+    dispatch.CmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline.Pipeline);
+    dispatch.CmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline.Layout, 0, 1, &frame.GraphicsSet, 0, nullptr);
+    dispatch.CmdBindVertexBuffers(commandBuffer, 0, 1, &vertexBuffer.Handle, &offset);
+    dispatch.CmdBindIndexBuffer(commandBuffer, indexBuffer.Handle, 0, VK_INDEX_TYPE_UINT32);
+}
+
+void SceneRenderer::RecordIndirectDraws(VkCommandBuffer commandBuffer, const FrameResources& frame, CullPhase phase)
+{
+    const LearningVK::DeviceDispatch& dispatch = LearningVK::GetDeviceDispatch();
+
+    dispatch.CmdDrawIndexedIndirectCount(commandBuffer, frame.DrawCommands[phase].Handle, 0, frame.DrawCounts[phase].Handle, 0,
+        GetObjectCount(), sizeof(VkDrawIndexedIndirectCommand));
+}
+
+void SceneRenderer::CreateBuffers()
+{
+    VkDevice device = specification.Device;
+    VkPhysicalDevice physicalDevice = specification.PhysicalDevice;
+
+    struct Upload
+    {
+        LearningVK::Buffer& Buffer;
+        VkBufferUsageFlags Usage;
+        const void* Data;
+        VkDeviceSize Size;
+    };
+
+    std::array<Upload, 4> uploads = { {
+        { vertexBuffer, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, scene.Vertices.data(), sizeof(SceneVertex) * scene.Vertices.size() },
+        { indexBuffer, VK_BUFFER_USAGE_INDEX_BUFFER_BIT, scene.Indices.data(), sizeof(uint32_t) * scene.Indices.size() },
+        { objectBuffer, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, scene.Objects.data(), sizeof(SceneObject) * scene.Objects.size() },
+        { meshBuffer, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, scene.Meshes.data(), sizeof(SceneMesh) * scene.Meshes.size() }
+    } };
+
+    for (Upload& upload : uploads)
+    {
+        if (!LearningVK::CreateBuffer(device, physicalDevice, upload.Size, upload.Usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0, upload.Buffer))
+            __debugbreak();
+
+        LearningVK::UploadBuffer(device, physicalDevice, specification.UploadQueue, specification.UploadCommandPool, upload.Buffer, upload.Data, upload.Size);
+    }
+
+    uint32_t objectCount = GetObjectCount();
+    frames.resize(specification.FramesInFlight * specification.ViewCount);
+    for (FrameResources& frame : frames)
+    {
+        bool created = LearningVK::CreateBuffer(device, physicalDevice, sizeof(SceneFrameData), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, frame.FrameData);
+
+        // Read back every frame, so cached memory is preferred
+        created &= LearningVK::CreateBuffer(device, physicalDevice, sizeof(OcclusionCullingStats), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, VK_MEMORY_PROPERTY_HOST_CACHED_BIT, frame.Stats);
+
+        for (uint32_t phase = 0; phase < CullPhase_Count; phase++)
+        {
+            created &= LearningVK::CreateBuffer(device, physicalDevice, sizeof(VkDrawIndexedIndirectCommand) * objectCount,
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0, frame.DrawCommands[phase]);
+            created &= LearningVK::CreateBuffer(device, physicalDevice, sizeof(uint32_t),
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0, frame.DrawCounts[phase]);
+        }
+
+        if (!created)
+            __debugbreak();
+    }
+}
+
+void SceneRenderer::CreatePrepassRenderPasses()
+{
+    for (uint32_t phase = 0; phase < CullPhase_Count; phase++)
+    {
+        bool early = phase == CullPhase_Early;
+
+        // Left readable by the depth reduction between the passes
+        VkAttachmentDescription depthAttachment{};
+        depthAttachment.format = specification.DepthFormat;
+        depthAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+        depthAttachment.loadOp = early ? VK_ATTACHMENT_LOAD_OP_CLEAR : VK_ATTACHMENT_LOAD_OP_LOAD;
+        depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+        depthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        depthAttachment.initialLayout = early ? VK_IMAGE_LAYOUT_UNDEFINED : VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+        depthAttachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+
+        VkAttachmentReference depthAttachmentRef{};
+        depthAttachmentRef.attachment = 0;
+        depthAttachmentRef.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+        VkSubpassDescription subpassDescription{};
+        subpassDescription.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+        subpassDescription.pDepthStencilAttachment = &depthAttachmentRef;
+
+        // The depth is written after the previous reduction read it and read by the next one
+        std::array<VkSubpassDependency, 2> dependencies{};
+        dependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
+        dependencies[0].dstSubpass = 0;
+        dependencies[0].srcStageMask = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+        dependencies[0].srcAccessMask = 0;
+        dependencies[0].dstStageMask = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+        dependencies[0].dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+        dependencies[1].srcSubpass = 0;
+        dependencies[1].dstSubpass = VK_SUBPASS_EXTERNAL;
+        dependencies[1].srcStageMask = VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+        dependencies[1].srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+        dependencies[1].dstStageMask = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+        dependencies[1].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+        VkRenderPassCreateInfo renderPassInfo{};
+        renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+        renderPassInfo.attachmentCount = 1;
+        renderPassInfo.pAttachments = &depthAttachment;
+        renderPassInfo.subpassCount = 1;
+        renderPassInfo.pSubpasses = &subpassDescription;
+        renderPassInfo.dependencyCount = uint32_t(dependencies.size());
+        renderPassInfo.pDependencies = dependencies.data();
+
+        if (vkCreateRenderPass(specification.Device, &renderPassInfo, nullptr, &prepassRenderPasses[phase]) != VK_SUCCESS)
+        {
+            std::cout << "Error: Couldn't create the occlusion pre-pass!" << std::endl;
+            __debugbreak();
+        }
+    }
+}
+
+void SceneRenderer::CreatePrepassTarget(ViewResources& view)
+{
+    LearningVK::AttachmentSpecification depthSpecification;
+    depthSpecification.Extent = view.Extent;
+    depthSpecification.Format = specification.DepthFormat;
+    depthSpecification.Usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    depthSpecification.Aspect = VK_IMAGE_ASPECT_DEPTH_BIT;
+
+    if (!LearningVK::CreateAttachment(specification.Device, specification.PhysicalDevice, depthSpecification, view.PrepassDepth))
+        __debugbreak();
+
+    VkFramebufferCreateInfo frameBufferInfo{};
+    frameBufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+    frameBufferInfo.renderPass = prepassRenderPasses[CullPhase_Early];
+    frameBufferInfo.attachmentCount = 1;
+    frameBufferInfo.pAttachments = &view.PrepassDepth.View;
+    frameBufferInfo.width = view.Extent.width;
+    frameBufferInfo.height = view.Extent.height;
+    frameBufferInfo.layers = 1;
+
+    if (vkCreateFramebuffer(specification.Device, &frameBufferInfo, nullptr, &view.PrepassFramebuffer) != VK_SUCCESS)
+    {
+        std::cout << "Error: Couldn't create the occlusion pre-pass framebuffer!" << std::endl;
+        __debugbreak();
+    }
+}
+
+void SceneRenderer::CreatePipelines()
+{
+    const LearningVK::ShaderVariant* vertexShader = specification.Shaders->SelectVariant("scene.vert", 0);
+    const LearningVK::ShaderVariant* fragShader = specification.Shaders->SelectVariant("scene.frag", 0);
+    const LearningVK::ShaderVariant* cullShader = specification.Shaders->SelectVariant("cull.comp", 0);
+    if (!vertexShader || !fragShader || !cullShader)
+    {
+        std::cout << "Error: Couldn't find the scene shaders!" << std::endl;
+        __debugbreak();
+    }
+
+    LearningVK::GraphicsPipelineSpecification pipelineSpecification;
+    pipelineSpecification.VertexCode = &vertexShader->Code;
+    pipelineSpecification.FragmentCode = &fragShader->Code;
+    pipelineSpecification.VertexBindings = { { 0, sizeof(SceneVertex), VK_VERTEX_INPUT_RATE_VERTEX } };
+    pipelineSpecification.VertexAttributes = {
+        { 0, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(SceneVertex, Position) },
+        { 1, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(SceneVertex, Normal) },
+        { 2, 0, VK_FORMAT_R32G32_SFLOAT, offsetof(SceneVertex, UV) }
+    };
+    pipelineSpecification.Bindings = {
+        LearningVK::UniformBufferBinding(0, VK_SHADER_STAGE_VERTEX_BIT),
+        LearningVK::StorageBufferBinding(1, VK_SHADER_STAGE_VERTEX_BIT),
+        LearningVK::UniformBufferBinding(2, VK_SHADER_STAGE_FRAGMENT_BIT),
+        LearningVK::StorageBufferBinding(3, VK_SHADER_STAGE_FRAGMENT_BIT),
+        LearningVK::StorageBufferBinding(4, VK_SHADER_STAGE_FRAGMENT_BIT),
+        LearningVK::StorageBufferBinding(5, VK_SHADER_STAGE_FRAGMENT_BIT)
+    };
+    pipelineSpecification.RenderPass = specification.RenderPass;
+    pipelineSpecification.Samples = specification.Samples;
+
+    if (!LearningVK::CreateGraphicsPipeline(specification.Device, pipelineSpecification, scenePipeline))
+        __debugbreak();
+
+    pipelineSpecification.FragmentCode = nullptr;
+    pipelineSpecification.RenderPass = prepassRenderPasses[CullPhase_Early];
+    pipelineSpecification.Samples = VK_SAMPLE_COUNT_1_BIT;
+
+    if (!LearningVK::CreateGraphicsPipeline(specification.Device, pipelineSpecification, prepassPipeline))
+        __debugbreak();
+
+    for (uint32_t phase = 0; phase < CullPhase_Count; phase++)
+    {
+        LearningVK::SpecializationConstants constants;
+        constants.Set(0, VkBool32(phase == CullPhase_Late));
+
+        LearningVK::ComputePipelineSpecification cullSpecification;
+        cullSpecification.Code = &cullShader->Code;
+        cullSpecification.Bindings = {
+            LearningVK::UniformBufferBinding(0),
+            LearningVK::StorageBufferBinding(1),
+            LearningVK::StorageBufferBinding(2),
+            LearningVK::StorageBufferBinding(3),
+            LearningVK::StorageBufferBinding(4),
+            LearningVK::StorageBufferBinding(5),
+            LearningVK::StorageBufferBinding(6),
+            LearningVK::CombinedImageSamplerBinding(7)
+        };
+        cullSpecification.Specialization = constants.GetInfo();
+
+        if (!LearningVK::CreateComputePipeline(specification.Device, cullSpecification, cullPipelines[phase]))
+            __debugbreak();
+    }
+}
+
+void SceneRenderer::CreateDescriptorSets(uint32_t view)
+{
+    ViewResources& resources = views[view];
+    uint32_t frameCount = specification.FramesInFlight;
+    std::array<VkDescriptorPoolSize, 3> poolSizes = { {
+        { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, frameCount * (2 + CullPhase_Count) },
+        { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, frameCount * (4 + 6 * CullPhase_Count) },
+        { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, frameCount * CullPhase_Count }
+    } };
+
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.maxSets = frameCount * (1 + CullPhase_Count);
+    poolInfo.poolSizeCount = uint32_t(poolSizes.size());
+    poolInfo.pPoolSizes = poolSizes.data();
+
+    if (vkCreateDescriptorPool(specification.Device, &poolInfo, nullptr, &resources.DescriptorPool) != VK_SUCCESS)
+    {
+        std::cout << "Error: Couldn't create the scene descriptor pool!" << std::endl;
+        __debugbreak();
+    }
+
+    const ClusteredLighting* lighting = specification.Lighting;
+    for (uint32_t frameIndex = 0; frameIndex < frameCount; frameIndex++)
+    {
+        uint32_t slot = GetFrameSlot(view, frameIndex);
+        FrameResources& frame = frames[slot];
+        std::array<VkDescriptorSetLayout, 1 + CullPhase_Count> layouts = { scenePipeline.SetLayout, cullPipelines[CullPhase_Early].SetLayout, cullPipelines[CullPhase_Late].SetLayout };
+        std::array<VkDescriptorSet, 1 + CullPhase_Count> sets;
+
+        VkDescriptorSetAllocateInfo allocateInfo{};
+        allocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocateInfo.descriptorPool = resources.DescriptorPool;
+        allocateInfo.descriptorSetCount = uint32_t(layouts.size());
+        allocateInfo.pSetLayouts = layouts.data();
+
+        if (vkAllocateDescriptorSets(specification.Device, &allocateInfo, sets.data()) != VK_SUCCESS)
+        {
+            std::cout << "Error: Couldn't allocate the scene descriptor sets!" << std::endl;
+            __debugbreak();
+        }
+
+        // The pre-pass pipeline has the same bindings, so it shares the set
+        frame.GraphicsSet = sets[0];
+        LearningVK::DescriptorWriter(frame.GraphicsSet)
+            .WriteBuffer(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, frame.FrameData.Handle)
+            .WriteBuffer(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, objectBuffer.Handle)
+            .WriteBuffer(2, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, lighting->GetLightingDataBuffer(slot).Handle)
+            .WriteBuffer(3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, lighting->GetLightBuffer(slot).Handle)
+            .WriteBuffer(4, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, lighting->GetClusterBuffer(slot).Handle)
+            .WriteBuffer(5, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, lighting->GetLightIndexBuffer(slot).Handle)
+            .Update(specification.Device);
+
+        for (uint32_t phase = 0; phase < CullPhase_Count; phase++)
+        {
+            frame.CullSets[phase] = sets[1 + phase];
+            LearningVK::DescriptorWriter(frame.CullSets[phase])
+                .WriteBuffer(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, frame.FrameData.Handle)
+                .WriteBuffer(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, objectBuffer.Handle)
+                .WriteBuffer(2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, meshBuffer.Handle)
+                .WriteBuffer(3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, resources.VisibilityBuffer.Handle)
+                .WriteBuffer(4, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, frame.DrawCommands[phase].Handle)
+                .WriteBuffer(5, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, frame.DrawCounts[phase].Handle)
+                .WriteBuffer(6, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, frame.Stats.Handle)
+                .WriteImage(7, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, resources.DepthPyramid->GetView(), VK_IMAGE_LAYOUT_GENERAL, resources.DepthPyramid->GetSampler())
+                .Update(specification.Device);
+        }
+    }
+}
+
+void SceneRenderer::RetireDescriptorSets(uint32_t view, LearningVK::DeletionQueue& deletionQueue, uint64_t frameNumber)
+{
+    VkDevice device = specification.Device;
+    VkDescriptorPool oldPool = views[view].DescriptorPool;
+    deletionQueue.Push(frameNumber, [=]() {
+        vkDestroyDescriptorPool(device, oldPool, nullptr);
+    });
+    views[view].DescriptorPool = VK_NULL_HANDLE;
+}
@@ -0,0 +1,179 @@
+#pragma once
+
+#include "EngineVK.h"
+#include "ClusteredLighting.h"
+#include "Scene.h"
+
+#include <vulkan/vulkan.h>
+#include <glm/glm.hpp>
+
+#include <array>
+#include <memory>
+#include <vector>
+
+struct SceneRendererSpecification
+{
+    VkDevice Device = VK_NULL_HANDLE;
+    VkPhysicalDevice PhysicalDevice = VK_NULL_HANDLE;
+    VkQueue UploadQueue = VK_NULL_HANDLE;
+    VkCommandPool UploadCommandPool = VK_NULL_HANDLE;
+
+    const LearningVK::ShaderLibrary* Shaders = nullptr;
+    VkRenderPass RenderPass = VK_NULL_HANDLE;
+    VkSampleCountFlagBits Samples = VK_SAMPLE_COUNT_1_BIT;
+    // Must support being sampled, the occlusion pre-pass reduces it into the depth pyramid
+    VkFormat DepthFormat = VK_FORMAT_UNDEFINED;
+    // Of view 0, the other views are created by their first Resize()
+    VkExtent2D Extent = { 0, 0 };
+    // Its light lists are bound to the fragment shader, so it must be initialized first and outlive the renderer
+    const ClusteredLighting* Lighting = nullptr;
+
+    uint32_t FramesInFlight = 2;
+    // Cameras the scene can be drawn from at once, each with its own culling results and depth pyramid
+    uint32_t ViewCount = 1;
+};
+
+// Objects and triangles handled by each culling phase of a frame, laid out like the stats buffer in cull.comp
+struct OcclusionCullingStats
+{
+    uint32_t FrustumCulledObjects = 0;
+    uint32_t FrustumCulledTriangles = 0;
+    uint32_t EarlyDrawnObjects = 0;
+    uint32_t EarlyDrawnTriangles = 0;
+    uint32_t EarlyOccludedObjects = 0;
+    uint32_t EarlyOccludedTriangles = 0;
+    uint32_t LateDrawnObjects = 0;
+    uint32_t LateDrawnTriangles = 0;
+    uint32_t LateOccludedObjects = 0;
+    uint32_t LateOccludedTriangles = 0;
+
+    uint32_t GetDrawnObjects() const { return EarlyDrawnObjects + LateDrawnObjects; }
+    uint32_t GetDrawnTriangles() const { return EarlyDrawnTriangles + LateDrawnTriangles; }
+};
+
+// Draws the rooms scene with GPU-driven two-phase occlusion culling. Every frame:
+//  1. The early cull draws what was visible in last frame's depth pyramid into a depth-only pre-pass
+//  2. The pyramid is built from that depth
+//  3. The late cull re-tests what the early cull rejected against the new pyramid, anything that became visible
+//     is drawn in the same frame so it never pops in late
+//  4. The late objects are added to the pre-pass and the pyramid is rebuilt for the next frame
+// The main pass then draws both lists with vkCmdDrawIndexedIndirectCount, shaded with the clustered lights.
+// The culling also picks the LOD of every object it draws from its screen space error.
+//
+// The scene's geometry and pipelines are shared by every view, only the pre-pass depth, the pyramid and the
+// per-frame buffers are the view's own. Frame slots are numbered view by view, see GetFrameSlot().
+class SceneRenderer
+{
+public:
+    void Init(const SceneRendererSpecification& specification);
+    void Shutdown();
+
+    // Creates the view's resources at the extent, or replaces them and retires the old ones through the deletion queue
+    void Resize(uint32_t view, VkExtent2D extent, LearningVK::DeletionQueue& deletionQueue, uint64_t frameNumber);
+    // Retires the view's resources through the deletion queue, a later Resize() creates them again
+    void RemoveView(uint32_t view, LearningVK::DeletionQueue& deletionQueue, uint64_t frameNumber);
+    bool HasView(uint32_t view) const { return views[view].DepthPyramid != nullptr; }
+    // Rebuilds the pipelines with the library's current shaders, the depth reduction shader is only loaded once
+    void RecreatePipelines(VkRenderPass renderPass, LearningVK::DeletionQueue& deletionQueue, uint64_t frameNumber);
+
+    // Disabling occlusion culling leaves only the frustum test and skips the pre-pass
+    void SetOcclusionCulling(bool enabled);
+    bool IsOcclusionCullingEnabled() const { return occlusionCulling; }
+
+    // Every object is drawn at the coarsest LOD whose error stays under thresholdPixels on screen,
+    // disabling it draws everything at full detail
+    void SetLodSelection(bool enabled, float thresholdPixels = 1.0f);
+    bool IsLodSelectionEnabled() const { return lodSelection; }
+
+    // Slot of a view's frame in flight, what every function taking a frame slot expects
+    uint32_t GetFrameSlot(uint32_t view, uint32_t frame) const { return view * specification.FramesInFlight + frame; }
+
+    // Writes the camera of the frame about to be recorded into the slot's uniform buffer. The viewport is what the
+    // projection maps onto, the LODs are picked for its pixels.
+    void Update(uint32_t frameSlot, const glm::vec3& cameraPosition, const glm::mat4& view, const glm::mat4& projection, VkExtent2D viewport);
+
+    // Prepares resources created since the last frame. RecordCulling does it as well, but commands recorded once and
+    // submitted every frame must not, so record this in front of them in a command buffer recorded every frame.
+    void RecordInitialization(VkCommandBuffer commandBuffer, uint32_t view);
+    // Records the culling and pre-pass, outside of any render pass
+    void RecordCulling(VkCommandBuffer commandBuffer, uint32_t frameSlot);
+    // Records the draws inside the main render pass
+    void RecordDraw(VkCommandBuffer commandBuffer, uint32_t frameSlot);
+
+    // Stats of the last frame recorded into the slot, only call this once its fence has signalled
+    OcclusionCullingStats CollectStats(uint32_t frameSlot) const;
+
+    uint32_t GetObjectCount() const { return uint32_t(scene.Objects.size()); }
+private:
+    enum CullPhase : uint32_t
+    {
+        CullPhase_Early = 0,
+        CullPhase_Late = 1,
+        CullPhase_Count
+    };
+
+    struct FrameResources
+    {
+        LearningVK::Buffer FrameData;
+        std::array<LearningVK::Buffer, CullPhase_Count> DrawCommands;
+        std::array<LearningVK::Buffer, CullPhase_Count> DrawCounts;
+        LearningVK::Buffer Stats;
+
+        VkDescriptorSet GraphicsSet = VK_NULL_HANDLE;
+        std::array<VkDescriptorSet, CullPhase_Count> CullSets{};
+    };
+
+    struct ViewResources
+    {
+        VkExtent2D Extent = { 0, 0 };
+        // Which objects the early cull drew this frame, so the late cull only re-tests the others
+        LearningVK::Buffer VisibilityBuffer;
+        LearningVK::Attachment PrepassDepth;
+        VkFramebuffer PrepassFramebuffer = VK_NULL_HANDLE;
+        std::unique_ptr<LearningVK::DepthPyramid> DepthPyramid;
+        // Holds the sets of the view's frame slots
+        VkDescriptorPool DescriptorPool = VK_NULL_HANDLE;
+
+        // Last frame built the pyramid at the current size, so the early cull can test against it
+        bool PyramidValid = false;
+        glm::mat4 PreviousViewProjection = glm::mat4(1.0f);
+    };
+
+    uint32_t GetView(uint32_t frameSlot) const { return frameSlot / specification.FramesInFlight; }
+
+    void CreateBuffers();
+    void CreatePrepassRenderPasses();
+    // The pre-pass depth and its framebuffer, sized to the view's extent
+    void CreatePrepassTarget(ViewResources& view);
+    void CreatePipelines();
+    void CreateDescriptorSets(uint32_t view);
+    void RetireDescriptorSets(uint32_t view, LearningVK::DeletionQueue& deletionQueue, uint64_t frameNumber);
+
+    void RecordCull(VkCommandBuffer commandBuffer, uint32_t frameSlot, CullPhase phase);
+    void RecordPrepass(VkCommandBuffer commandBuffer, uint32_t frameSlot, CullPhase phase);
+    void BindSceneGeometry(VkCommandBuffer commandBuffer, const LearningVK::GraphicsPipeline& pipeline, const FrameResources& frame);
+    void RecordIndirectDraws(VkCommandBuffer commandBuffer, const FrameResources& frame, CullPhase phase);
+private:
+    SceneRendererSpecification specification;
+    Scene scene;
+
+    LearningVK::Buffer vertexBuffer;
+    LearningVK::Buffer indexBuffer;
+    LearningVK::Buffer objectBuffer;
+    LearningVK::Buffer meshBuffer;
+    std::vector<FrameResources> frames;
+    std::vector<ViewResources> views;
+
+    LearningVK::GraphicsPipeline scenePipeline;
+    LearningVK::GraphicsPipeline prepassPipeline;
+    std::array<LearningVK::ComputePipeline, CullPhase_Count> cullPipelines;
+
+    // The early pre-pass clears the depth, the late one adds to it. Both are compatible with the same framebuffer.
+    std::array<VkRenderPass, CullPhase_Count> prepassRenderPasses{};
+    // Kept for the pyramids of views created later
+    std::vector<uint32_t> reduceShaderCode;
+
+    bool occlusionCulling = true;
+    bool lodSelection = true;
+    float lodThreshold = 1.0f;
+};
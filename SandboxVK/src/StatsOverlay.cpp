@@ -0,0 +1,293 @@
+#include "StatsOverlay.h"
+
+#include <iostream>
+
+// Padding around the text inside its background, in font pixels
+static const float BackgroundPadding = 3.0f;
+
+void StatsOverlay::Init(const StatsOverlaySpecification& specification)
+{
+    this->specification = specification;
+
+    LearningVK::SpriteBatchSpecification batchSpecification;
+    batchSpecification.Device = specification.Device;
+    batchSpecification.PhysicalDevice = specification.PhysicalDevice;
+    batchSpecification.UploadQueue = specification.UploadQueue;
+    batchSpecification.UploadCommandPool = specification.UploadCommandPool;
+    batchSpecification.MaxQuads = 4096;
+    batchSpecification.FrameCount = specification.FramesInFlight;
+    batch = std::make_unique<LearningVK::SpriteBatch>(batchSpecification);
+
+    CreateRenderPass();
+    CreatePipeline();
+    CreateFramebuffers();
+    CreateFontTexture();
+    CreateDescriptorSet();
+
+    material = batch->AddMaterial({ pipeline.Pipeline, pipeline.Layout, descriptorSet });
+}
+
+void StatsOverlay::Shutdown()
+{
+    VkDevice device = specification.Device;
+
+    batch.reset();
+    vkDestroyDescriptorPool(device, descriptorPool, nullptr);
+    vkDestroySampler(device, sampler, nullptr);
+    LearningVK::DestroyTexture(device, fontTexture);
+
+    for (VkFramebuffer framebuffer : framebuffers)
+        vkDestroyFramebuffer(device, framebuffer, nullptr);
+    LearningVK::DestroyGraphicsPipeline(device, pipeline);
+    vkDestroyRenderPass(device, renderPass, nullptr);
+}
+
+void StatsOverlay::Resize(VkFormat colorFormat, VkExtent2D extent, const std::vector<VkImageView>& imageViews,
+    LearningVK::DeletionQueue& deletionQueue, uint64_t frameNumber)
+{
+    VkDevice device = specification.Device;
+    std::vector<VkFramebuffer> oldFramebuffers = std::move(framebuffers);
+    deletionQueue.Push(frameNumber, [=]() {
+        for (VkFramebuffer framebuffer : oldFramebuffers)
+            vkDestroyFramebuffer(device, framebuffer, nullptr);
+    });
+
+    bool formatChanged = colorFormat != specification.ColorFormat;
+    specification.ColorFormat = colorFormat;
+    specification.Extent = extent;
+    specification.ImageViews = imageViews;
+
+    if (formatChanged)
+    {
+        VkRenderPass oldRenderPass = renderPass;
+        deletionQueue.Push(frameNumber, [=]() {
+            vkDestroyRenderPass(device, oldRenderPass, nullptr);
+        });
+
+        CreateRenderPass();
+        RecreatePipeline(deletionQueue, frameNumber);
+    }
+
+    CreateFramebuffers();
+}
+
+void StatsOverlay::RecreatePipeline(LearningVK::DeletionQueue& deletionQueue, uint64_t frameNumber)
+{
+    VkDevice device = specification.Device;
+    LearningVK::GraphicsPipeline oldPipeline = pipeline;
+    VkDescriptorPool oldDescriptorPool = descriptorPool;
+    deletionQueue.Push(frameNumber, [=]() mutable {
+        LearningVK::DestroyGraphicsPipeline(device, oldPipeline);
+        vkDestroyDescriptorPool(device, oldDescriptorPool, nullptr);
+    });
+
+    CreatePipeline();
+    // The set was allocated from the old set layout
+    CreateDescriptorSet();
+
+    batch->SetMaterial(material, { pipeline.Pipeline, pipeline.Layout, descriptorSet });
+}
+
+void StatsOverlay::Update(uint32_t frameSlot, const std::vector<std::string>& lines)
+{
+    const float scale = specification.TextScale;
+    glm::vec2 origin(8.0f, 8.0f);
+
+    std::string text;
+    for (const std::string& line : lines)
+        text += line + "\n";
+    if (!text.empty())
+        text.pop_back();
+
+    batch->Begin(frameSlot, specification.Extent);
+
+    if (!text.empty())
+    {
+        // The background is on the layer below the text, both share the material so they still end up in one draw
+        glm::vec2 padding(BackgroundPadding * scale);
+        glm::vec2 size = font.MeasureText(text, scale);
+        font.DrawRectangle(*batch, material, origin - padding, origin + size + padding, LearningVK::PackSpriteColor(0.0f, 0.0f, 0.0f, 0.6f), 0);
+        font.DrawString(*batch, material, text, origin, scale, LearningVK::PackSpriteColor(1.0f, 1.0f, 1.0f), 1);
+    }
+
+    batch->End();
+}
+
+void StatsOverlay::RecordDraw(VkCommandBuffer commandBuffer, uint32_t imageIndex)
+{
+    const LearningVK::DeviceDispatch& dispatch = LearningVK::GetDeviceDispatch();
+
+    VkRenderPassBeginInfo renderPassBeginInfo{};
+    renderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+    renderPassBeginInfo.renderPass = renderPass;
+    renderPassBeginInfo.framebuffer = framebuffers[imageIndex];
+    renderPassBeginInfo.renderArea.offset = { 0, 0 };
+    renderPassBeginInfo.renderArea.extent = specification.Extent;
+
+    dispatch.CmdBeginRenderPass(commandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+    batch->Record(commandBuffer);
+    dispatch.CmdEndRenderPass(commandBuffer);
+}
+
+void StatsOverlay::CreateRenderPass()
+{
+    // Draws over the finished frame, which is already in the presentation layout and stays in it
+    VkAttachmentDescription colorAttachment{};
+    colorAttachment.format = specification.ColorFormat;
+    colorAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+    colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+    colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    colorAttachment.initialLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+
+    VkAttachmentReference colorAttachmentRef{};
+    colorAttachmentRef.attachment = 0;
+    colorAttachmentRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+    VkSubpassDescription subpassDescription{};
+    subpassDescription.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    subpassDescription.colorAttachmentCount = 1;
+    subpassDescription.pColorAttachments = &colorAttachmentRef;
+
+    // The frame's render pass wrote the image, the text is blended over it
+    VkSubpassDependency dependency{};
+    dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
+    dependency.dstSubpass = 0;
+    dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    dependency.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+
+    VkRenderPassCreateInfo renderPassInfo{};
+    renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+    renderPassInfo.attachmentCount = 1;
+    renderPassInfo.pAttachments = &colorAttachment;
+    renderPassInfo.subpassCount = 1;
+    renderPassInfo.pSubpasses = &subpassDescription;
+    renderPassInfo.dependencyCount = 1;
+    renderPassInfo.pDependencies = &dependency;
+
+    if (vkCreateRenderPass(specification.Device, &renderPassInfo, nullptr, &renderPass) != VK_SUCCESS)
+    {
+        std::cout << "Error: Couldn't create the overlay render pass!" << std::endl;
+        __debugbreak();
+    }
+}
+
+void StatsOverlay::CreatePipeline()
+{
+    const LearningVK::ShaderVariant* vertexShader = specification.Shaders->SelectVariant("sprite.vert", 0);
+    const LearningVK::ShaderVariant* fragmentShader = specification.Shaders->SelectVariant("sprite.frag", 0);
+    if (!vertexShader || !fragmentShader)
+    {
+        std::cout << "Error: Couldn't find the sprite shaders!" << std::endl;
+        __debugbreak();
+    }
+
+    LearningVK::GraphicsPipelineSpecification pipelineSpecification;
+    pipelineSpecification.VertexCode = &vertexShader->Code;
+    pipelineSpecification.FragmentCode = &fragmentShader->Code;
+    pipelineSpecification.VertexBindings = LearningVK::SpriteBatch::GetVertexBindings();
+    pipelineSpecification.VertexAttributes = LearningVK::SpriteBatch::GetVertexAttributes();
+    pipelineSpecification.DepthTest = false;
+    pipelineSpecification.DepthWrite = false;
+    pipelineSpecification.AlphaBlending = true;
+    pipelineSpecification.Bindings = { LearningVK::CombinedImageSamplerBinding(0, VK_SHADER_STAGE_FRAGMENT_BIT) };
+    pipelineSpecification.RenderPass = renderPass;
+
+    if (!LearningVK::CreateGraphicsPipeline(specification.Device, pipelineSpecification, pipeline))
+        __debugbreak();
+}
+
+void StatsOverlay::CreateFramebuffers()
+{
+    framebuffers.resize(specification.ImageViews.size());
+
+    for (size_t i = 0; i < specification.ImageViews.size(); i++)
+    {
+        VkFramebufferCreateInfo framebufferInfo{};
+        framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+        framebufferInfo.renderPass = renderPass;
+        framebufferInfo.attachmentCount = 1;
+        framebufferInfo.pAttachments = &specification.ImageViews[i];
+        framebufferInfo.width = specification.Extent.width;
+        framebufferInfo.height = specification.Extent.height;
+        framebufferInfo.layers = 1;
+
+        if (vkCreateFramebuffer(specification.Device, &framebufferInfo, nullptr, &framebuffers[i]) != VK_SUCCESS)
+        {
+            std::cout << "Error: Couldn't create an overlay framebuffer!" << std::endl;
+            __debugbreak();
+        }
+    }
+}
+
+void StatsOverlay::CreateFontTexture()
+{
+    const std::vector<uint8_t>& pixels = font.GetAtlasPixels();
+
+    LearningVK::TextureSpecification textureSpecification;
+    textureSpecification.Extent = font.GetAtlasExtent();
+    textureSpecification.Format = VK_FORMAT_R8_UNORM;
+
+    if (!LearningVK::CreateTexture(specification.Device, specification.PhysicalDevice, textureSpecification, fontTexture)
+        || !LearningVK::UploadTexture(specification.Device, specification.PhysicalDevice, specification.UploadQueue, specification.UploadCommandPool,
+            fontTexture, 0, pixels.data(), pixels.size()))
+    {
+        std::cout << "Error: Couldn't create the overlay font texture!" << std::endl;
+        __debugbreak();
+    }
+
+    // The glyphs are drawn at whole multiples of their size, so every pixel maps onto exactly one texel
+    VkSamplerCreateInfo samplerInfo{};
+    samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    samplerInfo.magFilter = VK_FILTER_NEAREST;
+    samplerInfo.minFilter = VK_FILTER_NEAREST;
+    samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+    samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.minLod = 0.0f;
+    samplerInfo.maxLod = 0.0f;
+
+    if (vkCreateSampler(specification.Device, &samplerInfo, nullptr, &sampler) != VK_SUCCESS)
+    {
+        std::cout << "Error: Couldn't create the overlay sampler!" << std::endl;
+        __debugbreak();
+    }
+}
+
+void StatsOverlay::CreateDescriptorSet()
+{
+    VkDescriptorPoolSize poolSize = { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1 };
+
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.maxSets = 1;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+
+    if (vkCreateDescriptorPool(specification.Device, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS)
+    {
+        std::cout << "Error: Couldn't create the overlay descriptor pool!" << std::endl;
+        __debugbreak();
+    }
+
+    VkDescriptorSetAllocateInfo allocateInfo{};
+    allocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocateInfo.descriptorPool = descriptorPool;
+    allocateInfo.descriptorSetCount = 1;
+    allocateInfo.pSetLayouts = &pipeline.SetLayout;
+
+    if (vkAllocateDescriptorSets(specification.Device, &allocateInfo, &descriptorSet) != VK_SUCCESS)
+    {
+        std::cout << "Error: Couldn't allocate the overlay descriptor set!" << std::endl;
+        __debugbreak();
+    }
+
+    LearningVK::DescriptorWriter(descriptorSet)
+        .WriteImage(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, fontTexture.View, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, sampler)
+        .Update(specification.Device);
+}
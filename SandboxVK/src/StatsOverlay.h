@@ -0,0 +1,72 @@
+#pragma once
+
+#include "EngineVK.h"
+
+#include <vulkan/vulkan.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+struct StatsOverlaySpecification
+{
+    VkDevice Device = VK_NULL_HANDLE;
+    VkPhysicalDevice PhysicalDevice = VK_NULL_HANDLE;
+    VkQueue UploadQueue = VK_NULL_HANDLE;
+    VkCommandPool UploadCommandPool = VK_NULL_HANDLE;
+
+    const LearningVK::ShaderLibrary* Shaders = nullptr;
+    VkFormat ColorFormat = VK_FORMAT_UNDEFINED;
+    VkExtent2D Extent = { 0, 0 };
+    // One framebuffer is created for every swapchain image
+    std::vector<VkImageView> ImageViews;
+
+    uint32_t FramesInFlight = 2;
+    // Multiple of the font's pixels
+    float TextScale = 2.0f;
+};
+
+// Lines of text in the top left corner of the swapchain image, drawn by a render pass of its own after the frame
+// so the frame's commands don't depend on it. The text and its background come from one atlas and one pipeline,
+// so the whole overlay is a single draw.
+class StatsOverlay
+{
+public:
+    void Init(const StatsOverlaySpecification& specification);
+    void Shutdown();
+
+    // For a recreated swapchain, the old framebuffers are retired through the deletion queue, and the render pass and
+    // pipeline as well when the format changed
+    void Resize(VkFormat colorFormat, VkExtent2D extent, const std::vector<VkImageView>& imageViews,
+        LearningVK::DeletionQueue& deletionQueue, uint64_t frameNumber);
+    // Rebuilds the pipeline with the library's current shaders
+    void RecreatePipeline(LearningVK::DeletionQueue& deletionQueue, uint64_t frameNumber);
+
+    // Lays out the frame slot's text, the slot's previous frame must have finished
+    void Update(uint32_t frameSlot, const std::vector<std::string>& lines);
+    // Draws the text of the last Update() over a swapchain image in VK_IMAGE_LAYOUT_PRESENT_SRC_KHR
+    void RecordDraw(VkCommandBuffer commandBuffer, uint32_t imageIndex);
+
+    const LearningVK::SpriteBatchStats& GetBatchStats() const { return batch->GetStats(); }
+private:
+    void CreateRenderPass();
+    void CreatePipeline();
+    void CreateFramebuffers();
+    void CreateFontTexture();
+    void CreateDescriptorSet();
+private:
+    StatsOverlaySpecification specification;
+
+    VkRenderPass renderPass = VK_NULL_HANDLE;
+    std::vector<VkFramebuffer> framebuffers;
+    LearningVK::GraphicsPipeline pipeline;
+
+    LearningVK::BitmapFont font;
+    LearningVK::Texture fontTexture;
+    VkSampler sampler = VK_NULL_HANDLE;
+    VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+    VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+
+    std::unique_ptr<LearningVK::SpriteBatch> batch;
+    LearningVK::SpriteBatch::MaterialId material = 0;
+};
@@ -0,0 +1,87 @@
+-- Shader variants are built with "premake5 shaders" (see SandboxVK/compileShaders.bat).
+-- Every combination of a shader's features is compiled with the matching FEATURE_* defines
+-- and packed into a single archive. Bit i of a variant's key is features[i], so keep the
+-- order in sync with the feature enums used at runtime.
+ShaderVariants =
+{
+	{ source = "SandboxVK/res/shader.vert", features = {} },
+	{ source = "SandboxVK/res/shader.frag", features = { "VERTEX_COLOR" } },
+	{ source = "SandboxVK/res/particles.comp", features = {} },
+	{ source = "SandboxVK/res/particle.vert", features = {} },
+	{ source = "SandboxVK/res/particle.frag", features = {} },
+	{ source = "SandboxVK/res/scene.vert", features = {} },
+	{ source = "SandboxVK/res/scene.frag", features = {} },
+	{ source = "SandboxVK/res/cull.comp", features = {} },
+	{ source = "SandboxVK/res/depth_reduce.comp", features = {} },
+	{ source = "SandboxVK/res/light_assign.comp", features = {} },
+	{ source = "SandboxVK/res/sprite.vert", features = {} },
+	{ source = "SandboxVK/res/sprite.frag", features = {} },
+}
+
+ShaderArchive = "SandboxVK/res/shaders.pack"
+
+local function WriteU32(file, value)
+	file:write(string.pack("<I4", value))
+end
+
+local function CompileVariant(glslc, source, features, mask, output)
+	local defines = ""
+	for bit, feature in ipairs(features) do
+		if (mask & (1 << (bit - 1))) ~= 0 then
+			defines = defines .. " -DFEATURE_" .. feature
+		end
+	end
+
+	local command = string.format('"%s" -O%s "%s" -o "%s"', glslc, defines, source, output)
+	if not os.execute(command) then
+		error("Failed to compile " .. source .. " with mask " .. mask)
+	end
+
+	local file = io.open(output, "rb")
+	local code = file:read("a")
+	file:close()
+	return code
+end
+
+newaction
+{
+	trigger = "shaders",
+	description = "Compile every shader variant into " .. ShaderArchive,
+
+	execute = function()
+		local glslc = path.join(os.getenv("VULKAN_SDK"), "Bin", "glslc")
+		local intermediateDir = path.join(_MAIN_SCRIPT_DIR, "bin-int", "Shaders")
+		os.mkdir(intermediateDir)
+
+		local variants = {}
+		for _, shader in ipairs(ShaderVariants) do
+			local source = path.join(_MAIN_SCRIPT_DIR, shader.source)
+			local name = path.getname(shader.source)
+
+			for mask = 0, (1 << #shader.features) - 1 do
+				local output = path.join(intermediateDir, name .. "." .. mask .. ".spv")
+				local code = CompileVariant(glslc, source, shader.features, mask, output)
+				table.insert(variants, { name = name, mask = mask, code = code })
+			end
+		end
+
+		-- Layout: "LVKS", version, variant count, then for every variant:
+		-- name length, name (padded to 4 bytes), feature mask, code size, SPIR-V code
+		local archive = io.open(path.join(_MAIN_SCRIPT_DIR, ShaderArchive), "wb")
+		archive:write("LVKS")
+		WriteU32(archive, 1)
+		WriteU32(archive, #variants)
+
+		for _, variant in ipairs(variants) do
+			WriteU32(archive, #variant.name)
+			archive:write(variant.name)
+			archive:write(string.rep("\0", (4 - #variant.name % 4) % 4))
+			WriteU32(archive, variant.mask)
+			WriteU32(archive, #variant.code)
+			archive:write(variant.code)
+		end
+
+		archive:close()
+		print("Packed " .. #variants .. " shader variants into " .. ShaderArchive)
+	end
+}
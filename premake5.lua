@@ -11,6 +11,7 @@ workspace "LearningVK"
 
 	outputdir = "%{cfg.buildcfg}-%{cfg.system}-%{cfg.architecture}"
 	include "ExternalVK.lua"
+	include "ShadersVK.lua"
 --------------------------------------- WorkSpace ---------------------------------------
 
 --------------------------------------- EngineVK ---------------------------------------
@@ -81,6 +82,12 @@ project "SandboxVK"
 	targetdir ("bin/" .. outputdir .. "/%{prj.name}")
 	objdir ("bin-int/" .. outputdir .. "/%{prj.name}")
 
+	-- Vulkan's depth range, the culling shaders rely on it when they project bounds
+	defines
+	{
+		"GLM_FORCE_DEPTH_ZERO_TO_ONE"
+	}
+
 	files
 	{
 		"%{prj.name}/src/**.h",
@@ -100,6 +107,12 @@ project "SandboxVK"
         "EngineVK"
     }
 
+	-- The shader pack isn't committed, so every build packs the shaders first
+	prebuildcommands
+	{
+		"call ..\\vendor\\premake\\premake5.exe --file=../premake5.lua shaders"
+	}
+
 	filter "system:windows"
 		cppdialect "C++17"
 		systemversion "latest"